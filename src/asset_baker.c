@@ -0,0 +1,171 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Asset baker
+*
+*   Bakes the assets loaded at startup into a C header embedded in the executables, so they
+*   start without decoding or rasterizing anything and without reading asset files:
+*     - Spritesheet, decoded as RGBA8 pixels
+*     - Font atlases, one per size drawn (FONT_SIZES), rasterized as raylib LoadFontEx() does:
+*       GRAY_ALPHA pixels, glyph rectangles and glyph metrics
+*
+*   Pixel blobs are stored in the format uploaded to the GPU, they are used in place.
+*   Frontends use the baked assets when built with SUPPORT_BAKED_ASSETS (make BAKED_ASSETS=TRUE).
+*
+*   Build and run (raylib library is used to decode and rasterize, no window is created):
+*       make baked_assets.h
+*       ./asset_baker baked_assets.h
+*
+*   NOTE: Generated header does not depend on the platform, it can be baked on desktop and
+*   used by any other platform build (i.e. PLATFORM_WEB)
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "raylib.h"
+
+#include "render.h"                         // Required for: FONT_SIZES, FONT_GLYPH_COUNT, asset file names
+
+#include <stdio.h>                          // Required for: printf(), FILE, fopen(), fprintf(), fclose(), remove()
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void WriteBytes(FILE *file, const char *name, const unsigned char *data, int size);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <baked_assets.h>\n", argv[0]);
+        return 1;
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    Image spritesheet = LoadImage(SPRITESHEET_FILE_NAME);
+    if (spritesheet.data == NULL)
+    {
+        printf("Failed to load %s\n", SPRITESHEET_FILE_NAME);
+        return 1;
+    }
+    ImageFormat(&spritesheet, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    int fileSize = 0;
+    unsigned char *fileData = LoadFileData(FONT_FILE_NAME, &fileSize);
+    if (fileData == NULL)
+    {
+        printf("Failed to load %s\n", FONT_FILE_NAME);
+        UnloadImage(spritesheet);
+        return 1;
+    }
+
+    FILE *file = fopen(argv[1], "w");
+    if (file == NULL)
+    {
+        printf("Failed to write %s\n", argv[1]);
+        UnloadFileData(fileData);
+        UnloadImage(spritesheet);
+        return 1;
+    }
+
+    fprintf(file, "// Generated by asset_baker from %s and %s, do not edit\n", SPRITESHEET_FILE_NAME, FONT_FILE_NAME);
+    fprintf(file, "// NOTE: Include after raylib.h and render.h\n\n");
+    fprintf(file, "#ifndef BAKED_ASSETS_H\n#define BAKED_ASSETS_H\n\n");
+    fprintf(file, "struct BakedFont {\n");
+    fprintf(file, "    int size;\n    int atlasWidth;\n    int atlasHeight;\n    int atlasFormat;\n");
+    fprintf(file, "    const unsigned char *atlasData;\n    Rectangle *recs;\n    GlyphInfo *glyphs;\n};\n\n");
+
+    fprintf(file, "#define BAKED_SPRITESHEET_WIDTH %i\n", spritesheet.width);
+    fprintf(file, "#define BAKED_SPRITESHEET_HEIGHT %i\n", spritesheet.height);
+    fprintf(file, "#define BAKED_SPRITESHEET_FORMAT %i\n\n", PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    WriteBytes(file, "bakedSpritesheetData", (const unsigned char *)spritesheet.data, spritesheet.width*spritesheet.height*4);
+
+    const int sizes[FONT_SIZES_COUNT] = FONT_SIZES;
+    int atlasWidths[FONT_SIZES_COUNT] = { 0 };
+    int atlasHeights[FONT_SIZES_COUNT] = { 0 };
+    int atlasesSize = 0;
+    bool success = true;
+    for (int i = 0; (i < FONT_SIZES_COUNT) && success; i += 1)
+    {
+        // NOTE: Same steps as raylib LoadFontEx(), so baked and loaded fonts are the same
+        GlyphInfo *glyphs = LoadFontData(fileData, fileSize, sizes[i], NULL, FONT_GLYPH_COUNT, FONT_DEFAULT);
+        Rectangle *recs = NULL;
+        Image atlas = { 0 };
+        if (glyphs != NULL) atlas = GenImageFontAtlas(glyphs, &recs, FONT_GLYPH_COUNT, sizes[i], FONT_GLYPH_PADDING, 0);
+        success = (atlas.data != NULL) && (atlas.format == PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA);
+
+        if (success)
+        {
+            WriteBytes(file, TextFormat("bakedFontAtlasData%i", sizes[i]), (const unsigned char *)atlas.data, atlas.width*atlas.height*2);
+            atlasesSize += atlas.width*atlas.height*2;
+
+            fprintf(file, "static Rectangle bakedFontRecs%i[%i] = {\n", sizes[i], FONT_GLYPH_COUNT);
+            for (int g = 0; g < FONT_GLYPH_COUNT; g += 1)
+            {
+                fprintf(file, "    { %.0f, %.0f, %.0f, %.0f },\n", recs[g].x, recs[g].y, recs[g].width, recs[g].height);
+            }
+            fprintf(file, "};\n\n");
+
+            fprintf(file, "static GlyphInfo bakedFontGlyphs%i[%i] = {\n", sizes[i], FONT_GLYPH_COUNT);
+            for (int g = 0; g < FONT_GLYPH_COUNT; g += 1)
+            {
+                fprintf(file, "    { %i, %i, %i, %i, { 0 } },\n", glyphs[g].value, glyphs[g].offsetX, glyphs[g].offsetY, glyphs[g].advanceX);
+            }
+            fprintf(file, "};\n\n");
+
+            atlasWidths[i] = atlas.width;
+            atlasHeights[i] = atlas.height;
+        }
+
+        UnloadImage(atlas);
+        MemFree(recs);
+        UnloadFontData(glyphs, FONT_GLYPH_COUNT);
+    }
+
+    if (success)
+    {
+        // Fonts in FONT_SIZES order
+        fprintf(file, "static const struct BakedFont bakedFonts[%i] = {\n", FONT_SIZES_COUNT);
+        for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
+        {
+            fprintf(file, "    { %i, %i, %i, %i, bakedFontAtlasData%i, bakedFontRecs%i, bakedFontGlyphs%i },\n", sizes[i],
+                    atlasWidths[i], atlasHeights[i], PIXELFORMAT_UNCOMPRESSED_GRAY_ALPHA, sizes[i], sizes[i], sizes[i]);
+        }
+        fprintf(file, "};\n\n#endif // BAKED_ASSETS_H\n");
+    }
+
+    success = (fclose(file) == 0) && success;
+    if (success)
+    {
+        printf("%s: spritesheet %ix%i (%i bytes), %i font atlases (%i bytes)\n", argv[1],
+               spritesheet.width, spritesheet.height, spritesheet.width*spritesheet.height*4, FONT_SIZES_COUNT, atlasesSize);
+    } else
+    {
+        printf("Failed to bake %s\n", argv[1]);
+        remove(argv[1]);
+    }
+
+    UnloadFileData(fileData);
+    UnloadImage(spritesheet);
+
+    return success? 0 : 1;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Write a bytes array definition, 16 bytes per line
+void WriteBytes(FILE *file, const char *name, const unsigned char *data, int size)
+{
+    fprintf(file, "static const unsigned char %s[%i] = {", name, size);
+    for (int i = 0; i < size; i += 1)
+    {
+        if (i%16 == 0) fprintf(file, "\n    ");
+        fprintf(file, "0x%02x,", data[i]);
+    }
+    fprintf(file, "\n};\n\n");
+}
@@ -0,0 +1,348 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Bridge index microbenchmark
+*
+*   Compares the bridge lookup index against the linear scan of the bridges it replaced,
+*   for constellations of 20, 200 and 2000 random bridges. Every index answer is checked
+*   against the linear scan before timing.
+*
+*   Then compares the bridge grid spatial queries (bridges crossing a view sized rectangle,
+*   bridges near a point) against linear scans, for 200 to 20000 bridges spread over a large
+*   star field, short ones and some long diagonals. Answers are checked the same way.
+*
+*   Build and run (headless, raylib library not required):
+*       make bridge_index_bench && ./bridge_index_bench
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "constellation.h"
+
+#include <stdio.h>                          // Required for: printf()
+#include <stdlib.h>                         // Required for: malloc(), free(), qsort()
+#include <time.h>                           // Required for: clock()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define BENCH_GRID_SIZE 64                  // Stars per side of the grid bridges are generated on
+#define BENCH_QUERIES_COUNT 200000
+
+#define BENCH_FIELD_SIZE 1024               // Stars per side of the field grid bridges are spread on
+#define BENCH_VIEW_STARS 5.0f               // Rectangle queries side, the camera view in stars
+#define BENCH_NEAR_DISTANCE 0.5f            // Point queries distance, in stars
+#define BENCH_GRID_QUERIES_COUNT 20000
+#define BENCH_MAX_RESULTS 20000
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int NextRandom(unsigned int *state);
+static int FindBridgeLinear(const struct ConstellationBridge *bridges, int count, int x1, int y1, int x2, int y2);
+static int GetBridgesInRecLinear(const struct ConstellationBridge *bridges, int count, float x, float y, float width, float height, int *bridgeIds);
+static int GetBridgesNearPointLinear(const struct ConstellationBridge *bridges, int count, float x, float y, float distance, int *bridgeIds);
+static bool CheckSameBridges(int *bridgeIds1, int count1, int *bridgeIds2, int count2);
+static int CompareInts(const void *a, const void *b);
+static int BenchBridgeGrid(void);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(void)
+{
+    const int bridgesCounts[] = { 20, 200, 2000 };
+    unsigned int randomState = 0x2545f491;
+
+    printf("%8s %14s %14s %10s\n", "bridges", "linear ns/q", "index ns/q", "speedup");
+
+    for (int c = 0; c < (int)(sizeof(bridgesCounts)/sizeof(int)); c += 1)
+    {
+        const int count = bridgesCounts[c];
+
+        struct ConstellationBridge *bridges = (struct ConstellationBridge *)malloc(count*sizeof(struct ConstellationBridge));
+        for (int i = 0; i < count; i += 1)
+        {
+            bridges[i].x1 = NextRandom(&randomState)%BENCH_GRID_SIZE;
+            bridges[i].y1 = NextRandom(&randomState)%BENCH_GRID_SIZE;
+            bridges[i].x2 = NextRandom(&randomState)%BENCH_GRID_SIZE;
+            bridges[i].y2 = NextRandom(&randomState)%BENCH_GRID_SIZE;
+            bridges[i].state = (i%4 == 0)? BRIDGE_ON_DEFAULT : BRIDGE_OFF_DEFAULT;
+        }
+
+        // Queries like player drops: half are bridges (either star order), half random star pairs
+        int *queries = (int *)malloc(4*BENCH_QUERIES_COUNT*sizeof(int));
+        for (int q = 0; q < BENCH_QUERIES_COUNT; q += 1)
+        {
+            int *query = &queries[4*q];
+            if (q%2 == 0)
+            {
+                const struct ConstellationBridge *bridge = &bridges[NextRandom(&randomState)%count];
+                const bool swap = (NextRandom(&randomState)%2 == 0);
+                query[0] = swap? bridge->x2 : bridge->x1;
+                query[1] = swap? bridge->y2 : bridge->y1;
+                query[2] = swap? bridge->x1 : bridge->x2;
+                query[3] = swap? bridge->y1 : bridge->y2;
+            } else
+            {
+                for (int k = 0; k < 4; k += 1) query[k] = NextRandom(&randomState)%BENCH_GRID_SIZE;
+            }
+        }
+
+        struct BridgeIndex index = { 0 };
+        if (!LoadBridgeIndex(&index, bridges, count, BENCH_GRID_SIZE, BENCH_GRID_SIZE))
+        {
+            printf("Failed to build bridge index\n");
+            return 1;
+        }
+
+        // Validate index answers and incidence lists
+        for (int q = 0; q < BENCH_QUERIES_COUNT; q += 1)
+        {
+            const int *query = &queries[4*q];
+            if (FindBridge(&index, query[0], query[1], query[2], query[3]) != FindBridgeLinear(bridges, count, query[0], query[1], query[2], query[3]))
+            {
+                printf("Bridge index mismatch on query %i\n", q);
+                return 1;
+            }
+        }
+        for (int i = 0; i < count; i += 1)
+        {
+            const int *bridgeIds = NULL;
+            const int starBridgesCount = GetStarBridges(&index, bridges[i].x1, bridges[i].y1, &bridgeIds);
+            bool found = (FindBridgeLinear(bridges, count, bridges[i].x1, bridges[i].y1, bridges[i].x2, bridges[i].y2) != i);
+            for (int k = 0; k < starBridgesCount; k += 1) found = found || (bridgeIds[k] == i);
+            if (!found)
+            {
+                printf("Bridge %i missing from its star incidence list\n", i);
+                return 1;
+            }
+        }
+
+        volatile int sink = 0;
+
+        clock_t start = clock();
+        for (int q = 0; q < BENCH_QUERIES_COUNT; q += 1)
+        {
+            const int *query = &queries[4*q];
+            sink += FindBridgeLinear(bridges, count, query[0], query[1], query[2], query[3]);
+        }
+        const double linearSeconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+        start = clock();
+        for (int q = 0; q < BENCH_QUERIES_COUNT; q += 1)
+        {
+            const int *query = &queries[4*q];
+            sink += FindBridge(&index, query[0], query[1], query[2], query[3]);
+        }
+        const double indexSeconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+        printf("%8i %14.2f %14.2f %9.1fx\n", count,
+               1e9*linearSeconds/BENCH_QUERIES_COUNT,
+               1e9*indexSeconds/BENCH_QUERIES_COUNT,
+               (indexSeconds > 0.0)? linearSeconds/indexSeconds : 0.0);
+
+        UnloadBridgeIndex(&index);
+        free(queries);
+        free(bridges);
+    }
+
+    return BenchBridgeGrid();
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Compare bridge grid rectangle and point queries against linear scans
+int BenchBridgeGrid(void)
+{
+    const int bridgesCounts[] = { 200, 2000, 20000 };
+    unsigned int randomState = 0x9e3779b9;
+
+    int *gridIds = (int *)malloc(BENCH_MAX_RESULTS*sizeof(int));
+    int *linearIds = (int *)malloc(BENCH_MAX_RESULTS*sizeof(int));
+    float *queries = (float *)malloc(2*BENCH_GRID_QUERIES_COUNT*sizeof(float));
+
+    printf("\n%8s %8s %8s %14s %14s %14s %14s\n", "bridges", "cells", "entries", "rec linear", "rec grid", "near linear", "near grid");
+
+    for (int c = 0; c < (int)(sizeof(bridgesCounts)/sizeof(int)); c += 1)
+    {
+        const int count = bridgesCounts[c];
+
+        // Short bridges of up to 6 stars, every 16th one a long diagonal of up to 64 stars
+        struct ConstellationBridge *bridges = (struct ConstellationBridge *)malloc(count*sizeof(struct ConstellationBridge));
+        for (int i = 0; i < count; i += 1)
+        {
+            const int length = (i%16 == 0)? 64 : 6;
+            bridges[i].x1 = NextRandom(&randomState)%BENCH_FIELD_SIZE;
+            bridges[i].y1 = NextRandom(&randomState)%BENCH_FIELD_SIZE;
+            bridges[i].x2 = bridges[i].x1 + (int)(NextRandom(&randomState)%(2*length + 1)) - length;
+            bridges[i].y2 = bridges[i].y1 + (int)(NextRandom(&randomState)%(2*length + 1)) - length;
+            bridges[i].x2 = (bridges[i].x2 < 0)? 0 : ((bridges[i].x2 >= BENCH_FIELD_SIZE)? BENCH_FIELD_SIZE - 1 : bridges[i].x2);
+            bridges[i].y2 = (bridges[i].y2 < 0)? 0 : ((bridges[i].y2 >= BENCH_FIELD_SIZE)? BENCH_FIELD_SIZE - 1 : bridges[i].y2);
+            bridges[i].state = (i%4 == 0)? BRIDGE_ON_DEFAULT : BRIDGE_OFF_DEFAULT;
+        }
+
+        // Queries around stars of random bridges, like the camera and the frog over the constellation
+        for (int q = 0; q < BENCH_GRID_QUERIES_COUNT; q += 1)
+        {
+            const struct ConstellationBridge *bridge = &bridges[NextRandom(&randomState)%count];
+            queries[2*q] = bridge->x1 + (float)(NextRandom(&randomState)%1000)/250.0f - 2.0f;
+            queries[2*q + 1] = bridge->y1 + (float)(NextRandom(&randomState)%1000)/250.0f - 2.0f;
+        }
+
+        struct BridgeGrid grid = { 0 };
+        if (!LoadBridgeGrid(&grid, bridges, count))
+        {
+            printf("Failed to build bridge grid\n");
+            return 1;
+        }
+
+        // Validate grid answers
+        for (int q = 0; q < BENCH_GRID_QUERIES_COUNT; q += 1)
+        {
+            const float x = queries[2*q];
+            const float y = queries[2*q + 1];
+            const int gridRecCount = GetBridgesInRec(&grid, x, y, BENCH_VIEW_STARS, BENCH_VIEW_STARS, gridIds, BENCH_MAX_RESULTS);
+            const int linearRecCount = GetBridgesInRecLinear(bridges, count, x, y, BENCH_VIEW_STARS, BENCH_VIEW_STARS, linearIds);
+            const bool isRecSame = CheckSameBridges(gridIds, gridRecCount, linearIds, linearRecCount);
+
+            const int gridNearCount = GetBridgesNearPoint(&grid, x, y, BENCH_NEAR_DISTANCE, gridIds, BENCH_MAX_RESULTS);
+            const int linearNearCount = GetBridgesNearPointLinear(bridges, count, x, y, BENCH_NEAR_DISTANCE, linearIds);
+            if (!isRecSame || !CheckSameBridges(gridIds, gridNearCount, linearIds, linearNearCount))
+            {
+                printf("Bridge grid mismatch on query %i\n", q);
+                return 1;
+            }
+        }
+
+        volatile int sink = 0;
+        double seconds[4] = { 0 };
+        for (int k = 0; k < 4; k += 1)
+        {
+            clock_t start = clock();
+            for (int q = 0; q < BENCH_GRID_QUERIES_COUNT; q += 1)
+            {
+                const float x = queries[2*q];
+                const float y = queries[2*q + 1];
+                switch (k)
+                {
+                    case 0: sink += GetBridgesInRecLinear(bridges, count, x, y, BENCH_VIEW_STARS, BENCH_VIEW_STARS, linearIds); break;
+                    case 1: sink += GetBridgesInRec(&grid, x, y, BENCH_VIEW_STARS, BENCH_VIEW_STARS, gridIds, BENCH_MAX_RESULTS); break;
+                    case 2: sink += GetBridgesNearPointLinear(bridges, count, x, y, BENCH_NEAR_DISTANCE, linearIds); break;
+                    case 3: sink += GetBridgesNearPoint(&grid, x, y, BENCH_NEAR_DISTANCE, gridIds, BENCH_MAX_RESULTS); break;
+                    default: break;
+                }
+            }
+            seconds[k] = (double)(clock() - start)/CLOCKS_PER_SEC;
+        }
+
+        printf("%8i %8i %8i %11.2f us %11.2f us %11.2f us %11.2f us\n", count,
+               grid.cellCountX*grid.cellCountY, grid.cellFirst[grid.cellCountX*grid.cellCountY],
+               1e6*seconds[0]/BENCH_GRID_QUERIES_COUNT, 1e6*seconds[1]/BENCH_GRID_QUERIES_COUNT,
+               1e6*seconds[2]/BENCH_GRID_QUERIES_COUNT, 1e6*seconds[3]/BENCH_GRID_QUERIES_COUNT);
+
+        UnloadBridgeGrid(&grid);
+        free(bridges);
+    }
+
+    free(queries);
+    free(linearIds);
+    free(gridIds);
+
+    return 0;
+}
+
+unsigned int NextRandom(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+// Reference linear scan, as done before the bridge index
+int FindBridgeLinear(const struct ConstellationBridge *bridges, int count, int x1, int y1, int x2, int y2)
+{
+    for (int i = 0; i < count; i += 1)
+    {
+        const struct ConstellationBridge bridge = bridges[i];
+        if (
+            ((x1 == bridge.x1) && (y1 == bridge.y1) && (x2 == bridge.x2) && (y2 == bridge.y2))
+            ||
+            ((x2 == bridge.x1) && (y2 == bridge.y1) && (x1 == bridge.x2) && (y1 == bridge.y2))
+        )
+        {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Reference linear scan of the bridges crossing a rectangle (Liang-Barsky clipping, as the bridge grid)
+int GetBridgesInRecLinear(const struct ConstellationBridge *bridges, int count, float x, float y, float width, float height, int *bridgeIds)
+{
+    int found = 0;
+    for (int i = 0; i < count; i += 1)
+    {
+        const float deltaX = (float)(bridges[i].x2 - bridges[i].x1);
+        const float deltaY = (float)(bridges[i].y2 - bridges[i].y1);
+        const float p[4] = { -deltaX, deltaX, -deltaY, deltaY };
+        const float q[4] = { bridges[i].x1 - x, (x + width) - bridges[i].x1, bridges[i].y1 - y, (y + height) - bridges[i].y1 };
+
+        bool isCrossing = true;
+        float t0 = 0.0f;
+        float t1 = 1.0f;
+        for (int k = 0; (k < 4) && isCrossing; k += 1)
+        {
+            if (p[k] == 0.0f) isCrossing = (q[k] >= 0.0f);
+            else if (p[k] < 0.0f) t0 = (q[k]/p[k] > t0)? q[k]/p[k] : t0;
+            else t1 = (q[k]/p[k] < t1)? q[k]/p[k] : t1;
+            isCrossing = isCrossing && (t0 <= t1);
+        }
+
+        if (isCrossing) bridgeIds[found++] = i;
+    }
+    return found;
+}
+
+// Reference linear scan of the bridges closer than distance to a point
+int GetBridgesNearPointLinear(const struct ConstellationBridge *bridges, int count, float x, float y, float distance, int *bridgeIds)
+{
+    int found = 0;
+    for (int i = 0; i < count; i += 1)
+    {
+        const float deltaX = (float)(bridges[i].x2 - bridges[i].x1);
+        const float deltaY = (float)(bridges[i].y2 - bridges[i].y1);
+        const float lengthSqr = deltaX*deltaX + deltaY*deltaY;
+
+        float t = (lengthSqr > 0.0f)? ((x - bridges[i].x1)*deltaX + (y - bridges[i].y1)*deltaY)/lengthSqr : 0.0f;
+        t = (t < 0.0f)? 0.0f : ((t > 1.0f)? 1.0f : t);
+
+        const float distanceX = bridges[i].x1 + t*deltaX - x;
+        const float distanceY = bridges[i].y1 + t*deltaY - y;
+        if (distanceX*distanceX + distanceY*distanceY <= distance*distance) bridgeIds[found++] = i;
+    }
+    return found;
+}
+
+// Check if two lists hold the same bridges, in any order (lists are sorted)
+bool CheckSameBridges(int *bridgeIds1, int count1, int *bridgeIds2, int count2)
+{
+    if (count1 != count2) return false;
+
+    qsort(bridgeIds1, count1, sizeof(int), CompareInts);
+    qsort(bridgeIds2, count2, sizeof(int), CompareInts);
+    for (int i = 0; i < count1; i += 1)
+    {
+        if (bridgeIds1[i] != bridgeIds2[i]) return false;
+    }
+    return true;
+}
+
+int CompareInts(const void *a, const void *b)
+{
+    return *(const int *)a - *(const int *)b;
+}
@@ -0,0 +1,860 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellations
+*
+*   Constellation pack layout (version 3), little-endian, every section aligned to 8 bytes
+*   and every constellation record aligned to a 64 bytes cache line:
+*
+*       Header (32 bytes)
+*           char[4]     magic "SFCP"
+*           u32         version
+*           u32         constellations count
+*           u32         star count x
+*           u32         star count y
+*           u32         coordinate bits: 4 (compact, grid sides up to 16 stars) or 16 (wide)
+*           u32[2]      reserved
+*       Offset table
+*           u64[count]  byte offset of every constellation record from the start of the pack
+*       Constellation record
+*           u32         bridges count
+*           u32         starting score
+*           u32         bridge index pairs capacity
+*           u32         bridge index stars capacity
+*           u16[bridges count]      packed bridges: x1 | y1 << 4 | x2 << 8 | y2 << 12
+*                                   (wide: u16[4*bridges count], x1, y1, x2, y2 of every bridge)
+*           u8[(bridges count + 3)/4]   packed default states: 2 bits per bridge, from the lowest bits
+*           bridge index memory block (see GetBridgeIndexMemorySize())
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "constellation.h"
+
+#include <math.h>                           // Required for: floorf()
+#include <stdio.h>                          // Required for: FILE, fopen(), fwrite(), fclose()
+#include <stdlib.h>                         // Required for: calloc(), free(), abs()
+#include <string.h>                         // Required for: memcpy(), memcmp(), memset()
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>                    // Required for: CreateFileMappingA(), MapViewOfFile()
+#else
+    #include <fcntl.h>                      // Required for: open()
+    #include <sys/mman.h>                   // Required for: mmap(), munmap()
+    #include <sys/stat.h>                   // Required for: fstat()
+    #include <unistd.h>                     // Required for: close()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define BRIDGE_INDEX_EMPTY_PAIR 0xffffffffffffffffULL
+#define BRIDGE_INDEX_EMPTY_STAR 0xffffffffU
+
+#define CONSTELLATION_PACK_HEADER_SIZE 32
+#define CONSTELLATION_PACK_RECORD_HEADER_SIZE 16
+#define CONSTELLATION_PACK_ALIGNMENT 8
+#define CONSTELLATION_PACK_RECORD_ALIGNMENT 64
+
+#define CONSTELLATION_COORDINATE_MASK (CONSTELLATION_MAX_STAR_COUNT - 1)
+#define CONSTELLATION_WIDE_COORDINATE_MASK 0xffff
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned long long GetBridgeIndexMemorySize(int pairCapacity, int starCapacity, int bridgesCount);
+static void SetBridgeIndexMemory(struct BridgeIndex *index, const unsigned char *memory, int bridgesCount);
+static unsigned long long GetStarPairKey(int starCountX, int x1, int y1, int x2, int y2);
+static unsigned int GetHashSlot(unsigned long long key, int capacity);
+static void AddBridgeGridCells(struct BridgeGrid *grid, int bridgeId, bool isPlacing);
+static int QueryBridgeGrid(struct BridgeGrid *grid, float left, float top, float right, float bottom, bool isNearQuery, float distance, int *bridgeIds, int capacity);
+static bool CheckSegmentRec(const int *segment, float left, float top, float right, float bottom);
+static float GetSegmentPointDistanceSqr(const int *segment, float x, float y);
+static unsigned long long GetPackedBridgesSize(int bridgesCount, int coordinateBits);
+static unsigned long long GetRecordAlignedOffset(unsigned long long offset);
+static unsigned long long GetAlignedSize(unsigned long long size);
+static unsigned int ReadU32(const unsigned char *data);
+static unsigned long long ReadU64(const unsigned char *data);
+static void WriteU32(unsigned char *data, unsigned int value);
+static void WriteU64(unsigned char *data, unsigned long long value);
+static bool IsHostLittleEndian(void);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Bridge index
+//----------------------------------------------------------------------------------
+bool LoadBridgeIndex(struct BridgeIndex *index, const struct ConstellationBridge *bridges, int count, int starCountX, int starCountY)
+{
+    *index = (struct BridgeIndex){ 0 };
+    index->starCountX = starCountX;
+
+    // Every bridge adds at most two stars, tables are kept at most half full
+    index->pairCapacity = 8;
+    while (index->pairCapacity < 2*count) index->pairCapacity *= 2;
+    index->starCapacity = 8;
+    while (index->starCapacity < 4*count) index->starCapacity *= 2;
+
+    unsigned char *memory = (unsigned char *)calloc(1, (size_t)GetBridgeIndexMemorySize(index->pairCapacity, index->starCapacity, count));
+    if (memory == NULL) return false;
+
+    SetBridgeIndexMemory(index, memory, count);
+    index->memory = memory;
+
+    unsigned long long *pairKeys = (unsigned long long *)index->pairKeys;
+    int *pairBridgeIds = (int *)index->pairBridgeIds;
+    unsigned int *starKeys = (unsigned int *)index->starKeys;
+    int *starFirst = (int *)index->starFirst;
+    int *starCounts = (int *)index->starCounts;
+    int *starBridgeIds = (int *)index->starBridgeIds;
+
+    for (int i = 0; i < index->pairCapacity; i += 1) pairKeys[i] = BRIDGE_INDEX_EMPTY_PAIR;
+    for (int i = 0; i < index->starCapacity; i += 1) starKeys[i] = BRIDGE_INDEX_EMPTY_STAR;
+
+    // Bridges hash table, linear probing
+    for (int i = 0; i < count; i += 1)
+    {
+        const struct ConstellationBridge *bridge = &bridges[i];
+        if ((bridge->state == BRIDGE_DISABLED) ||
+            (bridge->x1 < 0) || (bridge->x1 >= starCountX) || (bridge->y1 < 0) || (bridge->y1 >= starCountY) ||
+            (bridge->x2 < 0) || (bridge->x2 >= starCountX) || (bridge->y2 < 0) || (bridge->y2 >= starCountY)) continue;
+
+        const unsigned long long key = GetStarPairKey(starCountX, bridge->x1, bridge->y1, bridge->x2, bridge->y2);
+        unsigned int slot = GetHashSlot(key, index->pairCapacity);
+        while ((pairKeys[slot] != BRIDGE_INDEX_EMPTY_PAIR) && (pairKeys[slot] != key))
+        {
+            slot = (slot + 1) & (index->pairCapacity - 1);
+        }
+
+        // NOTE: On duplicated bridges the first one wins, same as a linear scan
+        if (pairKeys[slot] == key) continue;
+
+        pairKeys[slot] = key;
+        pairBridgeIds[slot] = i;
+
+        // Count the bridge on both stars
+        const unsigned int stars[2] = {
+            (unsigned int)(bridge->y1*starCountX + bridge->x1),
+            (unsigned int)(bridge->y2*starCountX + bridge->x2)
+        };
+        for (int k = 0; k < 2; k += 1)
+        {
+            unsigned int starSlot = GetHashSlot(stars[k], index->starCapacity);
+            while ((starKeys[starSlot] != BRIDGE_INDEX_EMPTY_STAR) && (starKeys[starSlot] != stars[k]))
+            {
+                starSlot = (starSlot + 1) & (index->starCapacity - 1);
+            }
+            starKeys[starSlot] = stars[k];
+            starCounts[starSlot] += 1;
+        }
+    }
+
+    // Star incidence lists, counts turned into offsets (compressed rows)
+    int first = 0;
+    for (int i = 0; i < index->starCapacity; i += 1)
+    {
+        starFirst[i] = first;
+        first += starCounts[i];
+        starCounts[i] = 0;
+    }
+
+    // Refill counts while placing every bridge in its stars lists
+    for (int slot = 0; slot < index->pairCapacity; slot += 1)
+    {
+        if (pairKeys[slot] == BRIDGE_INDEX_EMPTY_PAIR) continue;
+
+        const int bridgeId = pairBridgeIds[slot];
+        const int starIds[2] = { bridges[bridgeId].y1*starCountX + bridges[bridgeId].x1, bridges[bridgeId].y2*starCountX + bridges[bridgeId].x2 };
+        for (int k = 0; k < 2; k += 1)
+        {
+            unsigned int starSlot = GetHashSlot((unsigned int)starIds[k], index->starCapacity);
+            while (starKeys[starSlot] != (unsigned int)starIds[k]) starSlot = (starSlot + 1) & (index->starCapacity - 1);
+
+            starBridgeIds[starFirst[starSlot] + starCounts[starSlot]] = bridgeId;
+            starCounts[starSlot] += 1;
+        }
+    }
+
+    return true;
+}
+
+void UnloadBridgeIndex(struct BridgeIndex *index)
+{
+    free(index->memory);
+    *index = (struct BridgeIndex){ 0 };
+}
+
+int FindBridge(const struct BridgeIndex *index, int x1, int y1, int x2, int y2)
+{
+    if ((index->pairCapacity == 0) || (x1 < 0) || (x1 >= index->starCountX) || (x2 < 0) || (x2 >= index->starCountX) || (y1 < 0) || (y2 < 0)) return -1;
+
+    // NOTE: Probes are bounded by the capacity, a pack table without empty slots can not loop forever
+    const unsigned long long key = GetStarPairKey(index->starCountX, x1, y1, x2, y2);
+    unsigned int slot = GetHashSlot(key, index->pairCapacity);
+    for (int probe = 0; (probe < index->pairCapacity) && (index->pairKeys[slot] != BRIDGE_INDEX_EMPTY_PAIR); probe += 1)
+    {
+        if (index->pairKeys[slot] == key)
+        {
+            const int bridgeId = index->pairBridgeIds[slot];
+            return ((bridgeId >= 0) && (bridgeId < index->bridgesCount))? bridgeId : -1;
+        }
+        slot = (slot + 1) & (index->pairCapacity - 1);
+    }
+    return -1;
+}
+
+int GetStarBridges(const struct BridgeIndex *index, int x, int y, const int **bridgeIds)
+{
+    *bridgeIds = NULL;
+    if ((index->starCapacity == 0) || (x < 0) || (x >= index->starCountX) || (y < 0)) return 0;
+
+    const unsigned int star = (unsigned int)(y*index->starCountX + x);
+    unsigned int slot = GetHashSlot(star, index->starCapacity);
+    for (int probe = 0; (probe < index->starCapacity) && (index->starKeys[slot] != BRIDGE_INDEX_EMPTY_STAR); probe += 1)
+    {
+        if (index->starKeys[slot] == star)
+        {
+            // List must be inside the starBridgeIds block and hold valid bridges, a star touches a few of them
+            const int first = index->starFirst[slot];
+            const int count = index->starCounts[slot];
+            if ((first < 0) || (count < 0) || (count > 2*index->bridgesCount - first)) return 0;
+            for (int i = first; i < first + count; i += 1)
+            {
+                if ((index->starBridgeIds[i] < 0) || (index->starBridgeIds[i] >= index->bridgesCount)) return 0;
+            }
+
+            *bridgeIds = &index->starBridgeIds[first];
+            return count;
+        }
+        slot = (slot + 1) & (index->starCapacity - 1);
+    }
+    return 0;
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Bridge grid
+//----------------------------------------------------------------------------------
+bool LoadBridgeGrid(struct BridgeGrid *grid, const struct ConstellationBridge *bridges, int count)
+{
+    *grid = (struct BridgeGrid){ 0 };
+    grid->bridgesCount = count;
+
+    // NOTE: One more entry so nothing is allocated with zero size
+    grid->segments = (int *)calloc(4*count + 4, sizeof(int));
+    grid->queryMarks = (unsigned int *)calloc(count + 1, sizeof(unsigned int));
+    if ((grid->segments == NULL) || (grid->queryMarks == NULL))
+    {
+        UnloadBridgeGrid(grid);
+        return false;
+    }
+
+    // Bounding box of the bridges
+    int minX = 0;
+    int minY = 0;
+    int maxX = 0;
+    int maxY = 0;
+    bool isEmpty = true;
+    for (int i = 0; i < count; i += 1)
+    {
+        const struct ConstellationBridge *bridge = &bridges[i];
+        grid->segments[4*i] = bridge->x1;
+        grid->segments[4*i + 1] = bridge->y1;
+        grid->segments[4*i + 2] = bridge->x2;
+        grid->segments[4*i + 3] = bridge->y2;
+        if (bridge->state == BRIDGE_DISABLED) continue;
+
+        const int left = (bridge->x1 < bridge->x2)? bridge->x1 : bridge->x2;
+        const int right = (bridge->x1 < bridge->x2)? bridge->x2 : bridge->x1;
+        const int top = (bridge->y1 < bridge->y2)? bridge->y1 : bridge->y2;
+        const int bottom = (bridge->y1 < bridge->y2)? bridge->y2 : bridge->y1;
+        minX = (isEmpty || (left < minX))? left : minX;
+        minY = (isEmpty || (top < minY))? top : minY;
+        maxX = (isEmpty || (right > maxX))? right : maxX;
+        maxY = (isEmpty || (bottom > maxY))? bottom : maxY;
+        isEmpty = false;
+    }
+
+    // Cells of one star at least, grown until they are not many more than the bridges
+    grid->originX = minX;
+    grid->originY = minY;
+    grid->cellStars = 1;
+    while ((long long)((maxX - minX)/grid->cellStars + 1)*((maxY - minY)/grid->cellStars + 1) > 2*(long long)count + 16) grid->cellStars *= 2;
+    grid->cellCountX = (maxX - minX)/grid->cellStars + 1;
+    grid->cellCountY = (maxY - minY)/grid->cellStars + 1;
+
+    const int cellsCount = grid->cellCountX*grid->cellCountY;
+    grid->cellFirst = (int *)calloc(cellsCount + 1, sizeof(int));
+    if (grid->cellFirst == NULL)
+    {
+        UnloadBridgeGrid(grid);
+        return false;
+    }
+
+    // Count the bridges of every cell, counts turned into offsets (compressed rows)
+    for (int i = 0; i < count; i += 1)
+    {
+        if (bridges[i].state != BRIDGE_DISABLED) AddBridgeGridCells(grid, i, false);
+    }
+
+    int first = 0;
+    for (int i = 0; i < cellsCount; i += 1)
+    {
+        const int cellCount = grid->cellFirst[i];
+        grid->cellFirst[i] = first;
+        first += cellCount;
+    }
+    grid->cellFirst[cellsCount] = first;
+
+    grid->cellBridgeIds = (int *)malloc((first + 1)*sizeof(int));
+    if (grid->cellBridgeIds == NULL)
+    {
+        UnloadBridgeGrid(grid);
+        return false;
+    }
+
+    // Placing bridges moves every cell offset to the next cell one, they are shifted back after
+    for (int i = 0; i < count; i += 1)
+    {
+        if (bridges[i].state != BRIDGE_DISABLED) AddBridgeGridCells(grid, i, true);
+    }
+    for (int i = cellsCount - 1; i > 0; i -= 1) grid->cellFirst[i] = grid->cellFirst[i - 1];
+    grid->cellFirst[0] = 0;
+
+    return true;
+}
+
+void UnloadBridgeGrid(struct BridgeGrid *grid)
+{
+    free(grid->cellFirst);
+    free(grid->cellBridgeIds);
+    free(grid->segments);
+    free(grid->queryMarks);
+    *grid = (struct BridgeGrid){ 0 };
+}
+
+int GetBridgesInRec(struct BridgeGrid *grid, float x, float y, float width, float height, int *bridgeIds, int capacity)
+{
+    return QueryBridgeGrid(grid, x, y, x + width, y + height, false, 0.0f, bridgeIds, capacity);
+}
+
+int GetBridgesNearPoint(struct BridgeGrid *grid, float x, float y, float distance, int *bridgeIds, int capacity)
+{
+    return QueryBridgeGrid(grid, x - distance, y - distance, x + distance, y + distance, true, distance, bridgeIds, capacity);
+}
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition: Constellation pack
+//----------------------------------------------------------------------------------
+bool LoadConstellationPack(struct ConstellationPack *pack, const char *fileName)
+{
+    *pack = (struct ConstellationPack){ 0 };
+
+    const unsigned char *data = NULL;
+    unsigned long long size = 0;
+    void *mapping = NULL;
+
+#if defined(_WIN32)
+    HANDLE file = CreateFileA(fileName, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER fileSize = { 0 };
+    if (GetFileSizeEx(file, &fileSize) && (fileSize.QuadPart > 0))
+    {
+        mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (mapping != NULL)
+        {
+            data = (const unsigned char *)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+            if (data == NULL)
+            {
+                CloseHandle(mapping);
+                mapping = NULL;
+            }
+        }
+        size = (unsigned long long)fileSize.QuadPart;
+    }
+    CloseHandle(file);
+#else
+    int file = open(fileName, O_RDONLY);
+    if (file < 0) return false;
+
+    struct stat fileStat = { 0 };
+    if ((fstat(file, &fileStat) == 0) && (fileStat.st_size > 0))
+    {
+        void *address = mmap(NULL, (size_t)fileStat.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        if (address != MAP_FAILED)
+        {
+            data = (const unsigned char *)address;
+            size = (unsigned long long)fileStat.st_size;
+        }
+    }
+    close(file);
+#endif
+
+    if (data == NULL) return false;
+
+    if (!LoadConstellationPackFromMemory(pack, data, size))
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(data);
+        CloseHandle(mapping);
+#else
+        munmap((void *)data, (size_t)size);
+#endif
+        return false;
+    }
+
+    pack->isMapped = true;
+    pack->mapping = mapping;
+
+    return true;
+}
+
+bool LoadConstellationPackFromMemory(struct ConstellationPack *pack, const unsigned char *data, unsigned long long size)
+{
+    *pack = (struct ConstellationPack){ 0 };
+
+    // NOTE: Records are used in place, pack byte order must match the host
+    if (!IsHostLittleEndian()) return false;
+    if ((data == NULL) || (size < CONSTELLATION_PACK_HEADER_SIZE) || (((size_t)data)%CONSTELLATION_PACK_ALIGNMENT != 0)) return false;
+    if ((memcmp(data, "SFCP", 4) != 0) || (ReadU32(data + 4) != CONSTELLATION_PACK_VERSION)) return false;
+
+    const unsigned long long count = ReadU32(data + 8);
+    if (CONSTELLATION_PACK_HEADER_SIZE + 8*count > size) return false;
+
+    pack->data = data;
+    pack->size = size;
+    pack->constellationsCount = (int)count;
+    pack->starCountX = (int)ReadU32(data + 12);
+    pack->starCountY = (int)ReadU32(data + 16);
+    pack->coordinateBits = (int)ReadU32(data + 20);
+
+    const int maxStarCount = (pack->coordinateBits == CONSTELLATION_COORDINATE_BITS)? CONSTELLATION_MAX_STAR_COUNT : CONSTELLATION_MAX_WIDE_STAR_COUNT;
+    if (((pack->coordinateBits != CONSTELLATION_COORDINATE_BITS) && (pack->coordinateBits != CONSTELLATION_WIDE_COORDINATE_BITS)) ||
+        (pack->starCountX < 1) || (pack->starCountX > maxStarCount) || (pack->starCountY < 1) || (pack->starCountY > maxStarCount))
+    {
+        *pack = (struct ConstellationPack){ 0 };
+        return false;
+    }
+
+    return true;
+}
+
+void UnloadConstellationPack(struct ConstellationPack *pack)
+{
+    if (pack->isMapped)
+    {
+#if defined(_WIN32)
+        UnmapViewOfFile(pack->data);
+        CloseHandle(pack->mapping);
+#else
+        munmap((void *)pack->data, (size_t)pack->size);
+#endif
+    }
+    *pack = (struct ConstellationPack){ 0 };
+}
+
+bool GetPackConstellation(const struct ConstellationPack *pack, int id, struct ConstellationView *view)
+{
+    *view = (struct ConstellationView){ 0 };
+    if ((id < 0) || (id >= pack->constellationsCount)) return false;
+
+    // Validate record bounds, only the record pages are touched
+    const unsigned long long offset = ReadU64(pack->data + CONSTELLATION_PACK_HEADER_SIZE + 8*(unsigned long long)id);
+    if ((offset%CONSTELLATION_PACK_ALIGNMENT != 0) || (offset + CONSTELLATION_PACK_RECORD_HEADER_SIZE > pack->size)) return false;
+
+    const unsigned char *record = pack->data + offset;
+    const int bridgesCount = (int)ReadU32(record);
+    const int pairCapacity = (int)ReadU32(record + 8);
+    const int starCapacity = (int)ReadU32(record + 12);
+    if ((bridgesCount < 0) || (pairCapacity <= 0) || (starCapacity <= 0) ||
+        ((pairCapacity & (pairCapacity - 1)) != 0) || ((starCapacity & (starCapacity - 1)) != 0)) return false;
+
+    const unsigned long long bridgesSize = GetPackedBridgesSize(bridgesCount, pack->coordinateBits);
+    const unsigned long long indexSize = GetBridgeIndexMemorySize(pairCapacity, starCapacity, bridgesCount);
+    if (offset + CONSTELLATION_PACK_RECORD_HEADER_SIZE + bridgesSize + indexSize > pack->size) return false;
+
+    const int bridgeWords = (pack->coordinateBits == CONSTELLATION_COORDINATE_BITS)? 1 : 4;
+    view->bridgesCount = bridgesCount;
+    view->startingScore = (int)ReadU32(record + 4);
+    view->coordinateBits = pack->coordinateBits;
+    view->bridges = (const unsigned short *)(record + CONSTELLATION_PACK_RECORD_HEADER_SIZE);
+    view->bridgeStates = (const unsigned char *)(view->bridges + bridgeWords*bridgesCount);
+
+    view->index.starCountX = pack->starCountX;
+    view->index.pairCapacity = pairCapacity;
+    view->index.starCapacity = starCapacity;
+    SetBridgeIndexMemory(&view->index, record + CONSTELLATION_PACK_RECORD_HEADER_SIZE + bridgesSize, bridgesCount);
+
+    return true;
+}
+
+struct ConstellationBridge GetConstellationViewBridge(const struct ConstellationView *view, int bridgeId)
+{
+    struct ConstellationBridge bridge = { 0 };
+    if (view->coordinateBits == CONSTELLATION_WIDE_COORDINATE_BITS)
+    {
+        const unsigned short *packedBridge = &view->bridges[4*bridgeId];
+        bridge.x1 = (int)packedBridge[0];
+        bridge.y1 = (int)packedBridge[1];
+        bridge.x2 = (int)packedBridge[2];
+        bridge.y2 = (int)packedBridge[3];
+    } else
+    {
+        const unsigned int packedBridge = view->bridges[bridgeId];
+        bridge.x1 = (int)(packedBridge & CONSTELLATION_COORDINATE_MASK);
+        bridge.y1 = (int)((packedBridge >> CONSTELLATION_COORDINATE_BITS) & CONSTELLATION_COORDINATE_MASK);
+        bridge.x2 = (int)((packedBridge >> 2*CONSTELLATION_COORDINATE_BITS) & CONSTELLATION_COORDINATE_MASK);
+        bridge.y2 = (int)((packedBridge >> 3*CONSTELLATION_COORDINATE_BITS) & CONSTELLATION_COORDINATE_MASK);
+    }
+    bridge.state = GetConstellationViewBridgeState(view, bridgeId);
+    return bridge;
+}
+
+enum BridgeState GetConstellationViewBridgeState(const struct ConstellationView *view, int bridgeId)
+{
+    return (enum BridgeState)((view->bridgeStates[bridgeId/4] >> (2*(bridgeId%4))) & 0x3);
+}
+
+unsigned char *ExportConstellationPack(const struct Constellation *constellations, int count, int starCountX, int starCountY, unsigned long long *size)
+{
+    *size = 0;
+    if ((starCountX < 1) || (starCountX > CONSTELLATION_MAX_WIDE_STAR_COUNT) || (starCountY < 1) || (starCountY > CONSTELLATION_MAX_WIDE_STAR_COUNT)) return NULL;
+
+    // NOTE: Compact bridges are kept whenever the grid allows it, wide bridges take 4 times the space
+    const bool isWide = (starCountX > CONSTELLATION_MAX_STAR_COUNT) || (starCountY > CONSTELLATION_MAX_STAR_COUNT);
+    const int coordinateBits = isWide? CONSTELLATION_WIDE_COORDINATE_BITS : CONSTELLATION_COORDINATE_BITS;
+
+    // Bridge index of every constellation is built here, so loading a pack requires no work
+    struct BridgeIndex *indices = (struct BridgeIndex *)calloc(count + 1, sizeof(struct BridgeIndex));
+    if (indices == NULL) return NULL;
+
+    unsigned long long packSize = CONSTELLATION_PACK_HEADER_SIZE + 8*(unsigned long long)count;
+    bool success = true;
+    for (int i = 0; i < count; i += 1)
+    {
+        const struct Constellation *constellation = &constellations[i];
+        if (!LoadBridgeIndex(&indices[i], constellation->bridges, constellation->bridgesCount, starCountX, starCountY))
+        {
+            success = false;
+            break;
+        }
+
+        packSize = GetRecordAlignedOffset(packSize);
+        packSize += CONSTELLATION_PACK_RECORD_HEADER_SIZE;
+        packSize += GetPackedBridgesSize(constellation->bridgesCount, coordinateBits);
+        packSize += GetBridgeIndexMemorySize(indices[i].pairCapacity, indices[i].starCapacity, constellation->bridgesCount);
+    }
+
+    unsigned char *data = success? (unsigned char *)calloc(1, (size_t)packSize) : NULL;
+    if (data != NULL)
+    {
+        memcpy(data, "SFCP", 4);
+        WriteU32(data + 4, CONSTELLATION_PACK_VERSION);
+        WriteU32(data + 8, (unsigned int)count);
+        WriteU32(data + 12, (unsigned int)starCountX);
+        WriteU32(data + 16, (unsigned int)starCountY);
+        WriteU32(data + 20, (unsigned int)coordinateBits);
+
+        unsigned long long offset = CONSTELLATION_PACK_HEADER_SIZE + 8*(unsigned long long)count;
+        for (int i = 0; i < count; i += 1)
+        {
+            const struct Constellation *constellation = &constellations[i];
+
+            offset = GetRecordAlignedOffset(offset);
+            unsigned char *record = data + offset;
+
+            WriteU64(data + CONSTELLATION_PACK_HEADER_SIZE + 8*(unsigned long long)i, offset);
+            WriteU32(record, (unsigned int)constellation->bridgesCount);
+            WriteU32(record + 4, (unsigned int)constellation->startingScore);
+            WriteU32(record + 8, (unsigned int)indices[i].pairCapacity);
+            WriteU32(record + 12, (unsigned int)indices[i].starCapacity);
+
+            // NOTE: Pack data is little-endian, same as the host (checked on load)
+            unsigned short *bridges = (unsigned short *)(record + CONSTELLATION_PACK_RECORD_HEADER_SIZE);
+            unsigned char *bridgeStates = (unsigned char *)(bridges + (isWide? 4 : 1)*constellation->bridgesCount);
+            for (int j = 0; j < constellation->bridgesCount; j += 1)
+            {
+                const struct ConstellationBridge *bridge = &constellation->bridges[j];
+                if (isWide)
+                {
+                    bridges[4*j] = (unsigned short)(bridge->x1 & CONSTELLATION_WIDE_COORDINATE_MASK);
+                    bridges[4*j + 1] = (unsigned short)(bridge->y1 & CONSTELLATION_WIDE_COORDINATE_MASK);
+                    bridges[4*j + 2] = (unsigned short)(bridge->x2 & CONSTELLATION_WIDE_COORDINATE_MASK);
+                    bridges[4*j + 3] = (unsigned short)(bridge->y2 & CONSTELLATION_WIDE_COORDINATE_MASK);
+                } else
+                {
+                    bridges[j] = (unsigned short)((bridge->x1 & CONSTELLATION_COORDINATE_MASK) |
+                                                  ((bridge->y1 & CONSTELLATION_COORDINATE_MASK) << CONSTELLATION_COORDINATE_BITS) |
+                                                  ((bridge->x2 & CONSTELLATION_COORDINATE_MASK) << 2*CONSTELLATION_COORDINATE_BITS) |
+                                                  ((bridge->y2 & CONSTELLATION_COORDINATE_MASK) << 3*CONSTELLATION_COORDINATE_BITS));
+                }
+
+                // Bridges outside the grid or duplicated are not in the index, they can never be lit
+                const bool isIndexed = (FindBridge(&indices[i], bridge->x1, bridge->y1, bridge->x2, bridge->y2) == j);
+                const unsigned int state = isIndexed? ((unsigned int)bridge->state & 0x3) : BRIDGE_DISABLED;
+                bridgeStates[j/4] |= (unsigned char)(state << (2*(j%4)));
+            }
+
+            const unsigned long long bridgesSize = GetPackedBridgesSize(constellation->bridgesCount, coordinateBits);
+            const unsigned long long indexSize = GetBridgeIndexMemorySize(indices[i].pairCapacity, indices[i].starCapacity, constellation->bridgesCount);
+            memcpy(record + CONSTELLATION_PACK_RECORD_HEADER_SIZE + bridgesSize, indices[i].memory, (size_t)indexSize);
+
+            offset += CONSTELLATION_PACK_RECORD_HEADER_SIZE + bridgesSize + indexSize;
+        }
+
+        *size = packSize;
+    }
+
+    for (int i = 0; i < count; i += 1) UnloadBridgeIndex(&indices[i]);
+    free(indices);
+
+    return data;
+}
+
+bool SaveConstellationPack(const char *fileName, const struct Constellation *constellations, int count, int starCountX, int starCountY)
+{
+    unsigned long long size = 0;
+    unsigned char *data = ExportConstellationPack(constellations, count, starCountX, starCountY, &size);
+    if (data == NULL) return false;
+
+    bool success = false;
+    FILE *file = fopen(fileName, "wb");
+    if (file != NULL)
+    {
+        success = (fwrite(data, 1, (size_t)size, file) == (size_t)size);
+        success = (fclose(file) == 0) && success;
+    }
+
+    free(data);
+
+    return success;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Get size of a bridge index memory block:
+// u64 pairKeys[pairCapacity], i32 pairBridgeIds[pairCapacity],
+// u32 starKeys[starCapacity], i32 starFirst[starCapacity], i32 starCounts[starCapacity],
+// i32 starBridgeIds[2*bridgesCount]
+unsigned long long GetBridgeIndexMemorySize(int pairCapacity, int starCapacity, int bridgesCount)
+{
+    const unsigned long long size = 12*(unsigned long long)pairCapacity + 12*(unsigned long long)starCapacity + 8*(unsigned long long)bridgesCount;
+    return GetAlignedSize(size);
+}
+
+// Point the index arrays into a memory block, capacities must be already set
+void SetBridgeIndexMemory(struct BridgeIndex *index, const unsigned char *memory, int bridgesCount)
+{
+    index->bridgesCount = bridgesCount;
+    index->pairKeys = (const unsigned long long *)memory;
+    index->pairBridgeIds = (const int *)(index->pairKeys + index->pairCapacity);
+    index->starKeys = (const unsigned int *)(index->pairBridgeIds + index->pairCapacity);
+    index->starFirst = (const int *)(index->starKeys + index->starCapacity);
+    index->starCounts = index->starFirst + index->starCapacity;
+    index->starBridgeIds = index->starCounts + index->starCapacity;
+}
+
+// Pack a star pair into a key, independent of the order of the stars
+unsigned long long GetStarPairKey(int starCountX, int x1, int y1, int x2, int y2)
+{
+    unsigned long long star1 = (unsigned long long)(y1*starCountX + x1);
+    unsigned long long star2 = (unsigned long long)(y2*starCountX + x2);
+    if (star1 > star2)
+    {
+        const unsigned long long star = star1;
+        star1 = star2;
+        star2 = star;
+    }
+    return (star1 << 32) | star2;
+}
+
+// Count a bridge in every cell its segment crosses, or place it in their lists
+// NOTE: Stars are integer points, crossings are compared exactly. Cells only touched at a corner or
+// at a segment end are listed too, queries test the segment itself
+void AddBridgeGridCells(struct BridgeGrid *grid, int bridgeId, bool isPlacing)
+{
+    const int *segment = &grid->segments[4*bridgeId];
+    const int startX = segment[0] - grid->originX;
+    const int startY = segment[1] - grid->originY;
+    const int endX = segment[2] - grid->originX;
+    const int endY = segment[3] - grid->originY;
+    const long long deltaX = llabs((long long)(endX - startX));
+    const long long deltaY = llabs((long long)(endY - startY));
+    const int stepX = (endX > startX)? 1 : -1;
+    const int stepY = (endY > startY)? 1 : -1;
+
+    int cellX = startX/grid->cellStars;
+    int cellY = startY/grid->cellStars;
+    const int endCellX = endX/grid->cellStars;
+    const int endCellY = endY/grid->cellStars;
+    const int stepsCount = abs(endCellX - cellX) + abs(endCellY - cellY);
+
+    for (int k = 0; k <= stepsCount; k += 1)
+    {
+        const int cellId = cellY*grid->cellCountX + cellX;
+        if (isPlacing) grid->cellBridgeIds[grid->cellFirst[cellId]++] = bridgeId;
+        else grid->cellFirst[cellId] += 1;
+
+        if (k == stepsCount) break;
+
+        // Next cell is across the cell side the segment reaches first: |boundaryX - startX|/deltaX against |boundaryY - startY|/deltaY
+        const long long boundaryX = (long long)((stepX > 0)? cellX + 1 : cellX)*grid->cellStars;
+        const long long boundaryY = (long long)((stepY > 0)? cellY + 1 : cellY)*grid->cellStars;
+        if ((cellX != endCellX) && ((cellY == endCellY) || (llabs(boundaryX - startX)*deltaY <= llabs(boundaryY - startY)*deltaX))) cellX += stepX;
+        else cellY += stepY;
+    }
+}
+
+// Get bridges listed in the cells overlapping a rectangle, tested against the rectangle or the distance to its center
+int QueryBridgeGrid(struct BridgeGrid *grid, float left, float top, float right, float bottom, bool isNearQuery, float distance, int *bridgeIds, int capacity)
+{
+    if (grid->cellFirst == NULL) return 0;
+
+    const float cellStars = (float)grid->cellStars;
+    int firstX = (int)floorf((left - grid->originX)/cellStars);
+    int firstY = (int)floorf((top - grid->originY)/cellStars);
+    int lastX = (int)floorf((right - grid->originX)/cellStars);
+    int lastY = (int)floorf((bottom - grid->originY)/cellStars);
+    if ((lastX < 0) || (lastY < 0) || (firstX >= grid->cellCountX) || (firstY >= grid->cellCountY)) return 0;
+
+    if (firstX < 0) firstX = 0;
+    if (firstY < 0) firstY = 0;
+    if (lastX >= grid->cellCountX) lastX = grid->cellCountX - 1;
+    if (lastY >= grid->cellCountY) lastY = grid->cellCountY - 1;
+
+    // Bridges are marked with the query id the first time they are found
+    grid->queryId += 1;
+    if (grid->queryId == 0)
+    {
+        memset(grid->queryMarks, 0, grid->bridgesCount*sizeof(unsigned int));
+        grid->queryId = 1;
+    }
+
+    const float centerX = (left + right)/2.0f;
+    const float centerY = (top + bottom)/2.0f;
+
+    int count = 0;
+    for (int y = firstY; y <= lastY; y += 1)
+    {
+        for (int x = firstX; x <= lastX; x += 1)
+        {
+            const int cellId = y*grid->cellCountX + x;
+            for (int i = grid->cellFirst[cellId]; i < grid->cellFirst[cellId + 1]; i += 1)
+            {
+                const int bridgeId = grid->cellBridgeIds[i];
+                if (grid->queryMarks[bridgeId] == grid->queryId) continue;
+                grid->queryMarks[bridgeId] = grid->queryId;
+
+                const int *segment = &grid->segments[4*bridgeId];
+                const bool isFound = isNearQuery? (GetSegmentPointDistanceSqr(segment, centerX, centerY) <= distance*distance) :
+                                                  CheckSegmentRec(segment, left, top, right, bottom);
+                if (isFound && (count < capacity)) bridgeIds[count++] = bridgeId;
+            }
+        }
+    }
+
+    return count;
+}
+
+// Check if a segment crosses a rectangle, clipping its parameter range against every side (Liang-Barsky)
+bool CheckSegmentRec(const int *segment, float left, float top, float right, float bottom)
+{
+    const float x1 = (float)segment[0];
+    const float y1 = (float)segment[1];
+    const float deltaX = (float)(segment[2] - segment[0]);
+    const float deltaY = (float)(segment[3] - segment[1]);
+
+    const float p[4] = { -deltaX, deltaX, -deltaY, deltaY };
+    const float q[4] = { x1 - left, right - x1, y1 - top, bottom - y1 };
+
+    float t0 = 0.0f;
+    float t1 = 1.0f;
+    for (int k = 0; k < 4; k += 1)
+    {
+        if (p[k] == 0.0f)
+        {
+            if (q[k] < 0.0f) return false;
+        } else
+        {
+            const float t = q[k]/p[k];
+            if (p[k] < 0.0f)
+            {
+                if (t > t0) t0 = t;
+            } else
+            {
+                if (t < t1) t1 = t;
+            }
+            if (t0 > t1) return false;
+        }
+    }
+
+    return true;
+}
+
+float GetSegmentPointDistanceSqr(const int *segment, float x, float y)
+{
+    const float deltaX = (float)(segment[2] - segment[0]);
+    const float deltaY = (float)(segment[3] - segment[1]);
+    const float lengthSqr = deltaX*deltaX + deltaY*deltaY;
+
+    float t = (lengthSqr > 0.0f)? ((x - segment[0])*deltaX + (y - segment[1])*deltaY)/lengthSqr : 0.0f;
+    t = (t < 0.0f)? 0.0f : ((t > 1.0f)? 1.0f : t);
+
+    const float distanceX = segment[0] + t*deltaX - x;
+    const float distanceY = segment[1] + t*deltaY - y;
+    return distanceX*distanceX + distanceY*distanceY;
+}
+
+// Fibonacci hashing of a key into a slot of a power of two table
+unsigned int GetHashSlot(unsigned long long key, int capacity)
+{
+    return (unsigned int)((key*0x9e3779b97f4a7c15ULL) >> 32) & (unsigned int)(capacity - 1);
+}
+
+// Get size of packed bridges and states, aligned
+unsigned long long GetPackedBridgesSize(int bridgesCount, int coordinateBits)
+{
+    const unsigned long long bridgeSize = (coordinateBits == CONSTELLATION_COORDINATE_BITS)? 2 : 8;
+    return GetAlignedSize(bridgeSize*(unsigned long long)bridgesCount + ((unsigned long long)bridgesCount + 3)/4);
+}
+
+// Get offset aligned to the start of a cache line, so a record header and its bridges share it
+unsigned long long GetRecordAlignedOffset(unsigned long long offset)
+{
+    return (offset + CONSTELLATION_PACK_RECORD_ALIGNMENT - 1)/CONSTELLATION_PACK_RECORD_ALIGNMENT*CONSTELLATION_PACK_RECORD_ALIGNMENT;
+}
+
+unsigned long long GetAlignedSize(unsigned long long size)
+{
+    return (size + CONSTELLATION_PACK_ALIGNMENT - 1)/CONSTELLATION_PACK_ALIGNMENT*CONSTELLATION_PACK_ALIGNMENT;
+}
+
+unsigned int ReadU32(const unsigned char *data)
+{
+    return (unsigned int)data[0] | ((unsigned int)data[1] << 8) | ((unsigned int)data[2] << 16) | ((unsigned int)data[3] << 24);
+}
+
+unsigned long long ReadU64(const unsigned char *data)
+{
+    return (unsigned long long)ReadU32(data) | ((unsigned long long)ReadU32(data + 4) << 32);
+}
+
+void WriteU32(unsigned char *data, unsigned int value)
+{
+    data[0] = (unsigned char)value;
+    data[1] = (unsigned char)(value >> 8);
+    data[2] = (unsigned char)(value >> 16);
+    data[3] = (unsigned char)(value >> 24);
+}
+
+void WriteU64(unsigned char *data, unsigned long long value)
+{
+    WriteU32(data, (unsigned int)value);
+    WriteU32(data + 4, (unsigned int)(value >> 32));
+}
+
+bool IsHostLittleEndian(void)
+{
+    const unsigned int value = 1;
+    return (*(const unsigned char *)&value == 1);
+}
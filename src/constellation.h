@@ -0,0 +1,157 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellations
+*
+*   Constellation data types, the bridge index (constant time "is this star pair a bridge"
+*   queries and per-star bridge incidence lists), the bridge grid (bridges crossing a rectangle
+*   or near a point) and constellation packs.
+*
+*   A constellation pack is a versioned little-endian binary file: a header, an offset table
+*   and one record per constellation holding its packed bridges and its prebuilt bridge index.
+*   Bridges are packed in 16 bits (4 bits per star coordinate) plus a 2-bit default state,
+*   so the bridges of a typical constellation fit in the first cache line of its record.
+*   Packs with larger star grids (wide packs) store 16 bits per star coordinate instead.
+*   Packs are memory mapped and their records used in place, there is no parse or copy step:
+*   loading is constant time and only the pages of the constellations accessed are touched.
+*   Record sizes are checked when a record is viewed, its prebuilt index is not trusted: lookups
+*   are bounded by the table capacities and bridge ids out of range are never returned.
+*
+*   NOTE: This module does not depend on raylib, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef CONSTELLATION_H
+#define CONSTELLATION_H
+
+#include <stdbool.h>                        // Required for: bool
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define CONSTELLATION_PACK_VERSION 3
+
+#define CONSTELLATION_COORDINATE_BITS 4
+#define CONSTELLATION_MAX_STAR_COUNT (1 << CONSTELLATION_COORDINATE_BITS)      // Max stars per side of a compact pack grid
+#define CONSTELLATION_WIDE_COORDINATE_BITS 16
+#define CONSTELLATION_MAX_WIDE_STAR_COUNT (1 << 15)     // Max stars per side of a wide pack grid, star ids fit in an int
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+enum BridgeState {
+    BRIDGE_OFF_DEFAULT,
+    BRIDGE_ON_DEFAULT,
+    BRIDGE_ON,
+    BRIDGE_DISABLED,
+};
+
+struct ConstellationBridge {
+    int x1;
+    int y1;
+    int x2;
+    int y2;
+    enum BridgeState state;
+};
+
+// Constellation to export into a pack
+// NOTE: Bridges are a span of a bridges arena shared by all the constellations
+struct Constellation {
+    int bridgesCount;
+    int startingScore;
+    const struct ConstellationBridge *bridges;
+};
+
+// Bridge lookup index of one constellation
+// NOTE: Open addressing hash tables over star pair keys (bridges) and star keys (incidence lists),
+// kept at most half full so a lookup probes a constant number of slots on average.
+// Memory is proportional to bridges count, not to the star grid size.
+// NOTE: Pack indices are not trusted, lookups probe every slot at most once and only return bridges below bridgesCount
+struct BridgeIndex {
+    int starCountX;
+    int bridgesCount;
+    int pairCapacity;                   // Bridges hash table slots, power of two
+    const unsigned long long *pairKeys; // Packed star pair of every slot (BRIDGE_INDEX_EMPTY_PAIR if unused)
+    const int *pairBridgeIds;           // Bridge of every slot
+    int starCapacity;                   // Stars hash table slots, power of two
+    const unsigned int *starKeys;       // Star of every slot (BRIDGE_INDEX_EMPTY_STAR if unused)
+    const int *starFirst;               // First entry in starBridgeIds of every slot
+    const int *starCounts;              // Entries in starBridgeIds of every slot
+    const int *starBridgeIds;           // Bridges touching every star, 2*bridgesCount entries
+    void *memory;                       // Owned memory, NULL if the index points into a pack
+};
+
+// Uniform grid of bridge segments, answers spatial queries in time proportional to the cells and bridges found
+// NOTE: Every bridge is listed in every cell its segment crosses (DDA traversal), so long bridges are found
+// away from their stars. Cells only cover the bridges bounding box and are about as many as bridges,
+// memory does not depend on the star grid size. Coordinates are in stars.
+struct BridgeGrid {
+    int bridgesCount;
+    int originX;                        // Bridges bounding box corner
+    int originY;
+    int cellStars;                      // Cell side, in stars
+    int cellCountX;
+    int cellCountY;
+    int *cellFirst;                     // First entry in cellBridgeIds of every cell, cellCountX*cellCountY + 1 entries
+    int *cellBridgeIds;                 // Bridges crossing every cell
+    int *segments;                      // Star coordinates x1, y1, x2, y2 of every bridge, for exact tests
+    unsigned int *queryMarks;           // Last query that found every bridge, a bridge in many cells is returned once
+    unsigned int queryId;
+};
+
+// One constellation of a pack, every pointer refers to the pack data
+struct ConstellationView {
+    int bridgesCount;
+    int startingScore;
+    int coordinateBits;                 // CONSTELLATION_COORDINATE_BITS (compact pack) or CONSTELLATION_WIDE_COORDINATE_BITS
+    const unsigned short *bridges;      // Packed bridges, 4-bit x1, y1, x2, y2 from the lowest bits (wide: one u16 each)
+    const unsigned char *bridgeStates;  // Packed default states, 2 bits per bridge (4 bridges per byte)
+    struct BridgeIndex index;
+};
+
+struct ConstellationPack {
+    const unsigned char *data;          // Pack data (mapped file or memory)
+    unsigned long long size;            // Pack data size in bytes
+    int constellationsCount;
+    int starCountX;
+    int starCountY;
+    int coordinateBits;                 // Bits per packed star coordinate
+    bool isMapped;                      // Data is a file mapping, unmapped on unload
+    void *mapping;                      // Platform file mapping handle (if required)
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+// Bridge index functions
+bool LoadBridgeIndex(struct BridgeIndex *index, const struct ConstellationBridge *bridges, int count, int starCountX, int starCountY);  // Build index, returns false on allocation failure
+void UnloadBridgeIndex(struct BridgeIndex *index);                                          // Free index memory (if owned)
+int FindBridge(const struct BridgeIndex *index, int x1, int y1, int x2, int y2);            // Get bridge joining two stars (any order), -1 if none (or invalid)
+int GetStarBridges(const struct BridgeIndex *index, int x, int y, const int **bridgeIds);   // Get bridges touching a star, returns count (0 if the list is invalid)
+
+// Bridge grid functions
+bool LoadBridgeGrid(struct BridgeGrid *grid, const struct ConstellationBridge *bridges, int count);   // Build grid (disabled bridges excluded), returns false on allocation failure
+void UnloadBridgeGrid(struct BridgeGrid *grid);                                             // Free grid memory
+int GetBridgesInRec(struct BridgeGrid *grid, float x, float y, float width, float height, int *bridgeIds, int capacity);   // Get bridges crossing a rectangle (stars), returns count (at most capacity)
+int GetBridgesNearPoint(struct BridgeGrid *grid, float x, float y, float distance, int *bridgeIds, int capacity);         // Get bridges closer than distance to a point (stars), returns count (at most capacity)
+
+// Constellation pack functions
+bool LoadConstellationPack(struct ConstellationPack *pack, const char *fileName);           // Map a pack file, header is validated in constant time
+bool LoadConstellationPackFromMemory(struct ConstellationPack *pack, const unsigned char *data, unsigned long long size);  // Use pack data from memory (not copied, must outlive the pack)
+void UnloadConstellationPack(struct ConstellationPack *pack);                               // Unmap pack file (if mapped)
+bool GetPackConstellation(const struct ConstellationPack *pack, int id, struct ConstellationView *view);  // Get constellation record in place, false if out of range or its sizes do not fit in the pack
+struct ConstellationBridge GetConstellationViewBridge(const struct ConstellationView *view, int bridgeId);  // Get bridge with its default state
+enum BridgeState GetConstellationViewBridgeState(const struct ConstellationView *view, int bridgeId);        // Get bridge default state
+unsigned char *ExportConstellationPack(const struct Constellation *constellations, int count, int starCountX, int starCountY, unsigned long long *size);  // Generate pack data, memory must be freed (NULL if a grid side exceeds CONSTELLATION_MAX_WIDE_STAR_COUNT)
+bool SaveConstellationPack(const char *fileName, const struct Constellation *constellations, int count, int starCountX, int starCountY);  // Export pack data to file
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // CONSTELLATION_H
@@ -0,0 +1,177 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellation generator tool
+*
+*   Generates random constellations on all the CPU cores (see generator.h), validates them,
+*   scores their difficulty and saves the ones in the requested difficulty range as a
+*   constellation pack, sorted from easiest to hardest, ready to be loaded by the game.
+*
+*   Build and run (headless, raylib library not required):
+*       make constellation_gen && ./constellation_gen resources/constellations.sfcp
+*       ./constellation_gen /tmp/hard.sfcp -n 100000 -d 60 100 -c /tmp/hard.csv
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+#include "generator.h"
+
+#include <stdio.h>                          // Required for: printf(), FILE, fopen(), fprintf(), fclose()
+#include <stdlib.h>                         // Required for: malloc(), free(), atoi(), atof(), strtoul(), qsort()
+#include <string.h>                         // Required for: strcmp()
+#include <time.h>                           // Required for: clock()
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const struct ConstellationDifficulty *sortDifficulties = NULL;   // Difficulties used by CompareDifficulties()
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int CompareDifficulties(const void *a, const void *b);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <output.sfcp> [-n count] [-s seed] [-t threads] [-d min max] [-c difficulties.csv]\n", argv[0]);
+        return 1;
+    }
+
+    struct GeneratorSettings settings = GetDefaultGeneratorSettings(STAR_COUNT_X, STAR_COUNT_Y);
+    const char *fileName = argv[1];
+    const char *csvFileName = NULL;
+    int count = 10000;
+    int threadsCount = 0;
+    float minScore = 0.0f;
+    float maxScore = 100.0f;
+    for (int i = 2; i < argc; i += 1)
+    {
+        if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) count = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) settings.seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) threadsCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-d") == 0) && (i + 2 < argc))
+        {
+            minScore = (float)atof(argv[++i]);
+            maxScore = (float)atof(argv[++i]);
+        }
+        else if ((strcmp(argv[i], "-c") == 0) && (i + 1 < argc)) csvFileName = argv[++i];
+        else
+        {
+            printf("Unknown option %s\n", argv[i]);
+            return 1;
+        }
+    }
+
+    if (count < 1)
+    {
+        printf("Invalid constellations count\n");
+        return 1;
+    }
+
+    struct ConstellationBridge *bridges = (struct ConstellationBridge *)malloc((size_t)count*settings.maxBridgesCount*sizeof(struct ConstellationBridge));
+    struct Constellation *constellations = (struct Constellation *)malloc(count*sizeof(struct Constellation));
+    struct ConstellationDifficulty *difficulties = (struct ConstellationDifficulty *)malloc(count*sizeof(struct ConstellationDifficulty));
+    int *order = (int *)malloc(count*sizeof(int));
+    struct Constellation *selected = (struct Constellation *)malloc(count*sizeof(struct Constellation));
+    if ((bridges == NULL) || (constellations == NULL) || (difficulties == NULL) || (order == NULL) || (selected == NULL))
+    {
+        printf("Failed to allocate %i constellations\n", count);
+        free(bridges);
+        free(constellations);
+        free(difficulties);
+        free(order);
+        free(selected);
+        return 1;
+    }
+
+    // NOTE: CPU time adds up the time of every thread
+    const clock_t start = clock();
+    GenerateConstellations(&settings, count, bridges, constellations, difficulties, threadsCount);
+    const double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    int validCount = 0;
+    int selectedCount = 0;
+    for (int i = 0; i < count; i += 1)
+    {
+        if (constellations[i].bridgesCount == 0) continue;
+
+        validCount += 1;
+        if ((difficulties[i].score >= minScore) && (difficulties[i].score <= maxScore)) order[selectedCount++] = i;
+    }
+
+    sortDifficulties = difficulties;
+    qsort(order, selectedCount, sizeof(int), CompareDifficulties);
+    for (int i = 0; i < selectedCount; i += 1) selected[i] = constellations[order[i]];
+
+    // Built-in constellations difficulty, as a reference for the difficulty range
+    int defaultCount = 0;
+    const struct Constellation *defaultConstellations = GetDefaultConstellations(&defaultCount);
+    float minDefaultScore = 100.0f;
+    float maxDefaultScore = 0.0f;
+    for (int i = 0; i < defaultCount; i += 1)
+    {
+        const float score = GetConstellationDifficulty(&defaultConstellations[i]).score;
+        if (score < minDefaultScore) minDefaultScore = score;
+        if (score > maxDefaultScore) maxDefaultScore = score;
+    }
+
+    printf("%i constellations generated in %.3fs of CPU time (%.0f per CPU minute): %i valid, %i in difficulty range\n",
+           count, seconds, (seconds > 0.0)? 60.0*count/seconds : 0.0, validCount, selectedCount);
+    if (selectedCount > 0)
+    {
+        printf("difficulty %.1f to %.1f, median %.1f (built-in constellations %.1f to %.1f)\n",
+               difficulties[order[0]].score, difficulties[order[selectedCount - 1]].score,
+               difficulties[order[selectedCount/2]].score, minDefaultScore, maxDefaultScore);
+    }
+
+    bool success = (selectedCount > 0) && SaveConstellationPack(fileName, selected, selectedCount, settings.starCountX, settings.starCountY);
+    if (!success) printf("Failed to save pack %s\n", fileName);
+
+    if (success && (csvFileName != NULL))
+    {
+        FILE *file = fopen(csvFileName, "w");
+        success = (file != NULL);
+        if (success)
+        {
+            fprintf(file, "constellation,bridges,starting_score,difficulty,path_length,branching,ambiguity\n");
+            for (int i = 0; i < selectedCount; i += 1)
+            {
+                const struct ConstellationDifficulty *difficulty = &difficulties[order[i]];
+                fprintf(file, "%i,%i,%i,%.2f,%.2f,%.3f,%.3f\n", i, selected[i].bridgesCount, selected[i].startingScore,
+                        difficulty->score, difficulty->pathLength, difficulty->branching, difficulty->ambiguity);
+            }
+            success = (fclose(file) == 0);
+        }
+        if (!success) printf("Failed to write %s\n", csvFileName);
+    }
+
+    free(bridges);
+    free(constellations);
+    free(difficulties);
+    free(order);
+    free(selected);
+
+    return success? 0 : 1;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Sort constellations from easiest to hardest, by id on ties so packs are reproducible
+int CompareDifficulties(const void *a, const void *b)
+{
+    const int idA = *(const int *)a;
+    const int idB = *(const int *)b;
+    const float scoreA = sortDifficulties[idA].score;
+    const float scoreB = sortDifficulties[idB].score;
+
+    if (scoreA < scoreB) return -1;
+    if (scoreA > scoreB) return 1;
+    return (idA > idB) - (idA < idB);
+}
@@ -0,0 +1,171 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellation pack tool
+*
+*   Exports the built-in constellations as a constellation pack file, then maps it back and
+*   checks random constellations against the built-in data. Constellations can be repeated
+*   to generate large packs and measure that load time does not depend on the pack size.
+*   Packs can have a larger star field than the built-in one, copies are then spread over it
+*   (the first ones are kept in place, next to the frog start).
+*
+*   Build and run (headless, raylib library not required):
+*       make constellation_pack && ./constellation_pack resources/constellations.sfcp
+*       ./constellation_pack /tmp/large.sfcp 10000      // 100000 constellations
+*       ./constellation_pack /tmp/wide.sfcp 100 1000 1000   // 1000x1000 stars field
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+
+#include <stdio.h>                          // Required for: printf()
+#include <stdlib.h>                         // Required for: malloc(), free(), atoi()
+#include <time.h>                           // Required for: clock()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define PACK_CHECKS_COUNT 1000              // Random constellations checked after loading
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    if (argc < 2)
+    {
+        printf("Usage: %s <output.sfcp> [copies] [starCountX starCountY]\n", argv[0]);
+        return 1;
+    }
+
+    const char *fileName = argv[1];
+    const int copies = (argc > 2)? atoi(argv[2]) : 1;
+    const int starCountX = (argc > 4)? atoi(argv[3]) : STAR_COUNT_X;
+    const int starCountY = (argc > 4)? atoi(argv[4]) : STAR_COUNT_Y;
+    if (copies < 1)
+    {
+        printf("Invalid copies count\n");
+        return 1;
+    }
+    if ((starCountX < STAR_COUNT_X) || (starCountX > CONSTELLATION_MAX_WIDE_STAR_COUNT) ||
+        (starCountY < STAR_COUNT_Y) || (starCountY > CONSTELLATION_MAX_WIDE_STAR_COUNT))
+    {
+        printf("Invalid star field, %ix%i to %ix%i stars\n", STAR_COUNT_X, STAR_COUNT_Y, CONSTELLATION_MAX_WIDE_STAR_COUNT, CONSTELLATION_MAX_WIDE_STAR_COUNT);
+        return 1;
+    }
+
+    int defaultCount = 0;
+    const struct Constellation *defaultConstellations = GetDefaultConstellations(&defaultCount);
+    int defaultBridgesCount = 0;
+    for (int i = 0; i < defaultCount; i += 1) defaultBridgesCount += defaultConstellations[i].bridgesCount;
+
+    const int count = defaultCount*copies;
+    struct Constellation *constellations = (struct Constellation *)malloc(count*sizeof(struct Constellation));
+    struct ConstellationBridge *bridges = (struct ConstellationBridge *)malloc((size_t)defaultBridgesCount*copies*sizeof(struct ConstellationBridge));
+    if ((constellations == NULL) || (bridges == NULL))
+    {
+        printf("Failed to allocate %i constellations\n", count);
+        free(constellations);
+        free(bridges);
+        return 1;
+    }
+
+    // Copies after the first ones are moved to a random place of the star field (none if it is the built-in one)
+    unsigned int randomState = 0x2545f491;
+    struct ConstellationBridge *copyBridges = bridges;
+    for (int i = 0; i < count; i += 1)
+    {
+        const struct Constellation *defaultConstellation = &defaultConstellations[i%defaultCount];
+
+        int offsetX = 0;
+        int offsetY = 0;
+        if (i >= defaultCount)
+        {
+            randomState ^= randomState << 13;
+            randomState ^= randomState >> 17;
+            randomState ^= randomState << 5;
+            offsetX = (int)(randomState%(unsigned int)(starCountX - STAR_COUNT_X + 1));
+            offsetY = (int)((randomState >> 16)%(unsigned int)(starCountY - STAR_COUNT_Y + 1));
+        }
+
+        for (int j = 0; j < defaultConstellation->bridgesCount; j += 1)
+        {
+            copyBridges[j] = defaultConstellation->bridges[j];
+            copyBridges[j].x1 += offsetX;
+            copyBridges[j].y1 += offsetY;
+            copyBridges[j].x2 += offsetX;
+            copyBridges[j].y2 += offsetY;
+        }
+
+        constellations[i] = *defaultConstellation;
+        constellations[i].bridges = copyBridges;
+        copyBridges += defaultConstellation->bridgesCount;
+    }
+
+    if (!SaveConstellationPack(fileName, constellations, count, starCountX, starCountY))
+    {
+        printf("Failed to save pack %s\n", fileName);
+        free(constellations);
+        free(bridges);
+        return 1;
+    }
+
+    // Map pack and check random constellations in place
+    struct ConstellationPack pack = { 0 };
+
+    clock_t start = clock();
+    const bool loaded = LoadConstellationPack(&pack, fileName);
+    const double loadSeconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    if (!loaded || (pack.constellationsCount != count))
+    {
+        printf("Failed to load pack %s\n", fileName);
+        free(constellations);
+        free(bridges);
+        return 1;
+    }
+
+    int mismatches = 0;
+
+    start = clock();
+    for (int k = 0; k < PACK_CHECKS_COUNT; k += 1)
+    {
+        randomState ^= randomState << 13;
+        randomState ^= randomState >> 17;
+        randomState ^= randomState << 5;
+        const int id = (int)(randomState%(unsigned int)count);
+
+        const struct Constellation *constellation = &constellations[id];
+        struct ConstellationView view = { 0 };
+        if (!GetPackConstellation(&pack, id, &view) ||
+            (view.bridgesCount != constellation->bridgesCount) || (view.startingScore != constellation->startingScore))
+        {
+            mismatches += 1;
+            continue;
+        }
+
+        for (int i = 0; i < constellation->bridgesCount; i += 1)
+        {
+            const struct ConstellationBridge bridge = constellation->bridges[i];
+            const struct ConstellationBridge packBridge = GetConstellationViewBridge(&view, i);
+            if ((packBridge.x1 != bridge.x1) || (packBridge.y1 != bridge.y1) ||
+                (packBridge.x2 != bridge.x2) || (packBridge.y2 != bridge.y2) || (packBridge.state != bridge.state) ||
+                (FindBridge(&view.index, bridge.x2, bridge.y2, bridge.x1, bridge.y1) != i))
+            {
+                mismatches += 1;
+            }
+        }
+    }
+    const double checkSeconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    printf("%s: %i constellations, %ix%i stars, %llu bytes\n", fileName, pack.constellationsCount, pack.starCountX, pack.starCountY, pack.size);
+    printf("load: %.1f us, random access: %.1f us/constellation, mismatches: %i\n",
+           1e6*loadSeconds, 1e6*checkSeconds/PACK_CHECKS_COUNT, mismatches);
+
+    UnloadConstellationPack(&pack);
+    free(constellations);
+    free(bridges);
+
+    return (mismatches == 0)? 0 : 1;
+}
@@ -0,0 +1,727 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Game simulation
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+
+#define RAYMATH_STATIC_INLINE
+#include "raymath.h"                        // Required for: Vector2Add(), Vector2Subtract(), Vector2Scale(), Vector2Length(), Vector2Lerp()
+
+#include <math.h>                           // Required for: lrintf(), fmaxf()
+#include <stdlib.h>                         // Required for: free()
+#include <string.h>                         // Required for: memset()
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+// Built-in constellations, used when no constellation pack file is available
+// NOTE: Bridges of all the constellations are stored back to back, every constellation is a span
+static const struct ConstellationBridge defaultBridges[] = {
+    // Constellation 0
+    { 9, 0, 8, 3, BRIDGE_ON_DEFAULT },
+    { 8, 3, 10, 4, BRIDGE_ON_DEFAULT },
+    { 10, 4, 9, 9, BRIDGE_OFF_DEFAULT },
+    { 9, 9, 7, 10, BRIDGE_OFF_DEFAULT },
+    { 7, 10, 3, 10, BRIDGE_OFF_DEFAULT },
+    { 3, 10, 1, 10, BRIDGE_OFF_DEFAULT },
+    { 1, 10, 0, 13, BRIDGE_OFF_DEFAULT },
+    { 3, 10, 4, 14, BRIDGE_OFF_DEFAULT },
+    { 4, 14, 0, 13, BRIDGE_OFF_DEFAULT },
+    { 1, 10, 2, 8, BRIDGE_OFF_DEFAULT },
+    { 2, 8, 4, 6, BRIDGE_OFF_DEFAULT },
+    { 4, 6, 6, 4, BRIDGE_OFF_DEFAULT },
+    { 6, 4, 6, 2, BRIDGE_OFF_DEFAULT },
+    { 6, 2, 8, 3, BRIDGE_OFF_DEFAULT },
+    { 1, 4, 4, 6, BRIDGE_OFF_DEFAULT },
+    { 0, 0, 1, 4, BRIDGE_OFF_DEFAULT },
+    { 1, 4, 6, 2, BRIDGE_OFF_DEFAULT },
+    // Constellation 1
+    { 0, 3, 3, 0, BRIDGE_ON_DEFAULT },
+    { 0, 3, 4, 6, BRIDGE_OFF_DEFAULT },
+    { 4, 6, 6, 7, BRIDGE_OFF_DEFAULT },
+    { 6, 7, 8, 4, BRIDGE_OFF_DEFAULT },
+    { 8, 4, 10, 3, BRIDGE_OFF_DEFAULT },
+    { 10, 3, 10, 1, BRIDGE_OFF_DEFAULT },
+    { 1, 8, 4, 6, BRIDGE_OFF_DEFAULT },
+    { 1, 8, 1, 10, BRIDGE_OFF_DEFAULT },
+    { 6, 7, 8, 10, BRIDGE_OFF_DEFAULT },
+    { 8, 10, 5, 11, BRIDGE_OFF_DEFAULT },
+    { 5, 11, 6, 14, BRIDGE_OFF_DEFAULT },
+    { 8, 10, 6, 14, BRIDGE_OFF_DEFAULT },
+    { 10, 13, 8, 10, BRIDGE_OFF_DEFAULT },
+    { 1, 14, 3, 14, BRIDGE_ON_DEFAULT },
+    { 3, 14, 6, 14, BRIDGE_OFF_DEFAULT },
+    // Constellation 2
+    { 9, 13, 9, 11, BRIDGE_OFF_DEFAULT },
+    { 9, 11, 7, 11, BRIDGE_OFF_DEFAULT },
+    { 9, 13, 5, 14, BRIDGE_OFF_DEFAULT },
+    { 4, 12, 7, 11, BRIDGE_ON_DEFAULT },
+    { 4, 12, 5, 14, BRIDGE_OFF_DEFAULT },
+    { 7, 11, 7, 8, BRIDGE_OFF_DEFAULT },
+    { 4, 12, 3, 9, BRIDGE_OFF_DEFAULT },
+    { 0, 11, 3, 9, BRIDGE_OFF_DEFAULT },
+    { 6, 6, 7, 8, BRIDGE_OFF_DEFAULT },
+    { 6, 6, 7, 4, BRIDGE_OFF_DEFAULT },
+    { 7, 4, 9, 3, BRIDGE_OFF_DEFAULT },
+    { 4, 5, 6, 6, BRIDGE_OFF_DEFAULT },
+    { 2, 4, 4, 5, BRIDGE_OFF_DEFAULT },
+    { 4, 2, 7, 4, BRIDGE_OFF_DEFAULT },
+    { 1, 2, 2, 4, BRIDGE_ON_DEFAULT },
+    { 2, 4, 4, 2, BRIDGE_ON_DEFAULT },
+    // Constellation 3
+    { 5, 14, 7, 12, BRIDGE_ON_DEFAULT },
+    { 7, 12, 10, 13, BRIDGE_OFF_DEFAULT },
+    { 10, 13, 10, 10, BRIDGE_OFF_DEFAULT },
+    { 8, 6, 10, 10, BRIDGE_OFF_DEFAULT },
+    { 8, 6, 10, 5, BRIDGE_OFF_DEFAULT },
+    { 7, 1, 10, 5, BRIDGE_ON_DEFAULT },
+    { 7, 1, 9, 1, BRIDGE_OFF_DEFAULT },
+    { 6, 3, 7, 1, BRIDGE_OFF_DEFAULT },
+    { 5, 7, 8, 6, BRIDGE_OFF_DEFAULT },
+    { 5, 7, 3, 6, BRIDGE_OFF_DEFAULT },
+    { 3, 6, 3, 3, BRIDGE_OFF_DEFAULT },
+    { 3, 3, 6, 3, BRIDGE_OFF_DEFAULT },
+    { 5, 7, 7, 12, BRIDGE_OFF_DEFAULT },
+    { 1, 11, 5, 14, BRIDGE_OFF_DEFAULT },
+    { 0, 4, 1, 1, BRIDGE_OFF_DEFAULT },
+    { 1, 1, 3, 3, BRIDGE_OFF_DEFAULT },
+    // Constellation 4
+    { 10, 14, 10, 12, BRIDGE_OFF_DEFAULT },
+    { 7, 12, 10, 14, BRIDGE_ON_DEFAULT },
+    { 7, 12, 7, 10, BRIDGE_OFF_DEFAULT },
+    { 10, 12, 9, 10, BRIDGE_OFF_DEFAULT },
+    { 9, 10, 7, 10, BRIDGE_OFF_DEFAULT },
+    { 7, 10, 8, 8, BRIDGE_OFF_DEFAULT },
+    { 8, 8, 9, 6, BRIDGE_OFF_DEFAULT },
+    { 7, 1, 9, 6, BRIDGE_OFF_DEFAULT },
+    { 7, 1, 9, 0, BRIDGE_ON_DEFAULT },
+    { 1, 11, 0, 9, BRIDGE_ON_DEFAULT },
+    { 7, 1, 3, 0, BRIDGE_OFF_DEFAULT },
+    { 3, 0, 1, 1, BRIDGE_OFF_DEFAULT },
+    { 3, 6, 3, 4, BRIDGE_OFF_DEFAULT },
+    { 3, 4, 1, 1, BRIDGE_OFF_DEFAULT },
+    { 3, 6, 0, 9, BRIDGE_OFF_DEFAULT },
+    { 3, 6, 8, 8, BRIDGE_OFF_DEFAULT },
+    // Constellation 5
+    { 7, 1, 10, 1, BRIDGE_ON_DEFAULT },
+    { 10, 1, 10, 4, BRIDGE_OFF_DEFAULT },
+    { 9, 7, 10, 4, BRIDGE_OFF_DEFAULT },
+    { 7, 10, 9, 7, BRIDGE_OFF_DEFAULT },
+    { 6, 12, 7, 10, BRIDGE_OFF_DEFAULT },
+    { 6, 12, 10, 14, BRIDGE_OFF_DEFAULT },
+    { 2, 12, 6, 12, BRIDGE_OFF_DEFAULT },
+    { 0, 11, 2, 12, BRIDGE_OFF_DEFAULT },
+    { 7, 10, 5, 9, BRIDGE_OFF_DEFAULT },
+    { 0, 11, 5, 9, BRIDGE_ON_DEFAULT },
+    { 5, 9, 3, 7, BRIDGE_OFF_DEFAULT },
+    { 3, 7, 3, 5, BRIDGE_OFF_DEFAULT },
+    { 3, 5, 2, 3, BRIDGE_OFF_DEFAULT },
+    { 2, 3, 2, 1, BRIDGE_OFF_DEFAULT },
+    { 7, 1, 7, 3, BRIDGE_OFF_DEFAULT },
+    { 7, 3, 2, 1, BRIDGE_OFF_DEFAULT },
+    // Constellation 6
+    { 0, 13, 2, 11, BRIDGE_OFF_DEFAULT },
+    { 2, 11, 2, 9, BRIDGE_OFF_DEFAULT },
+    { 2, 11, 5, 12, BRIDGE_ON_DEFAULT },
+    { 5, 12, 7, 13, BRIDGE_OFF_DEFAULT },
+    { 7, 13, 10, 12, BRIDGE_OFF_DEFAULT },
+    { 5, 12, 6, 9, BRIDGE_OFF_DEFAULT },
+    { 6, 9, 10, 12, BRIDGE_OFF_DEFAULT },
+    { 6, 9, 8, 7, BRIDGE_OFF_DEFAULT },
+    { 8, 7, 9, 5, BRIDGE_OFF_DEFAULT },
+    { 9, 5, 8, 2, BRIDGE_OFF_DEFAULT },
+    { 8, 2, 7, 0, BRIDGE_OFF_DEFAULT },
+    { 8, 7, 4, 5, BRIDGE_ON_DEFAULT },
+    { 4, 5, 7, 0, BRIDGE_OFF_DEFAULT },
+    { 4, 5, 3, 3, BRIDGE_OFF_DEFAULT },
+    { 3, 3, 1, 4, BRIDGE_OFF_DEFAULT },
+    { 1, 4, 0, 6, BRIDGE_OFF_DEFAULT },
+    // Constellation 7
+    { 9, 0, 10, 2, BRIDGE_OFF_DEFAULT },
+    { 10, 2, 8, 2, BRIDGE_ON_DEFAULT },
+    { 6, 3, 8, 2, BRIDGE_ON_DEFAULT },
+    { 6, 3, 3, 2, BRIDGE_ON_DEFAULT },
+    { 3, 2, 3, 0, BRIDGE_OFF_DEFAULT },
+    { 6, 3, 5, 5, BRIDGE_OFF_DEFAULT },
+    { 5, 5, 8, 6, BRIDGE_OFF_DEFAULT },
+    { 8, 6, 10, 2, BRIDGE_OFF_DEFAULT },
+    { 9, 10, 8, 6, BRIDGE_OFF_DEFAULT },
+    { 5, 5, 5, 9, BRIDGE_OFF_DEFAULT },
+    { 5, 9, 2, 9, BRIDGE_OFF_DEFAULT },
+    { 2, 9, 2, 11, BRIDGE_OFF_DEFAULT },
+    { 2, 11, 2, 13, BRIDGE_OFF_DEFAULT },
+    { 2, 13, 4, 13, BRIDGE_OFF_DEFAULT },
+    { 4, 13, 6, 13, BRIDGE_OFF_DEFAULT },
+    { 6, 13, 9, 10, BRIDGE_OFF_DEFAULT },
+    // Constellation 8
+    { 9, 14, 7, 14, BRIDGE_OFF_DEFAULT },
+    { 10, 12, 9, 14, BRIDGE_OFF_DEFAULT },
+    { 10, 12, 8, 10, BRIDGE_OFF_DEFAULT },
+    { 8, 10, 10, 8, BRIDGE_OFF_DEFAULT },
+    { 10, 8, 10, 6, BRIDGE_OFF_DEFAULT },
+    { 7, 14, 5, 12, BRIDGE_OFF_DEFAULT },
+    { 5, 12, 1, 13, BRIDGE_ON_DEFAULT },
+    { 5, 12, 5, 10, BRIDGE_OFF_DEFAULT },
+    { 5, 10, 3, 8, BRIDGE_OFF_DEFAULT },
+    { 0, 8, 1, 13, BRIDGE_OFF_DEFAULT },
+    { 3, 8, 0, 8, BRIDGE_OFF_DEFAULT },
+    { 5, 5, 3, 8, BRIDGE_OFF_DEFAULT },
+    { 5, 5, 7, 1, BRIDGE_ON_DEFAULT },
+    { 5, 5, 3, 4, BRIDGE_OFF_DEFAULT },
+    { 0, 8, 3, 4, BRIDGE_OFF_DEFAULT },
+    { 3, 4, 0, 0, BRIDGE_OFF_DEFAULT },
+    // Constellation 9
+    { 2, 13, 0, 14, BRIDGE_OFF_DEFAULT },
+    { 2, 13, 2, 11, BRIDGE_OFF_DEFAULT },
+    { 2, 11, 0, 11, BRIDGE_OFF_DEFAULT },
+    { 2, 11, 1, 9, BRIDGE_ON_DEFAULT },
+    { 2, 11, 4, 10, BRIDGE_OFF_DEFAULT },
+    { 4, 10, 1, 9, BRIDGE_OFF_DEFAULT },
+    { 4, 10, 6, 9, BRIDGE_OFF_DEFAULT },
+    { 6, 14, 2, 13, BRIDGE_OFF_DEFAULT },
+    { 9, 14, 6, 14, BRIDGE_OFF_DEFAULT },
+    { 6, 9, 8, 7, BRIDGE_OFF_DEFAULT },
+    { 8, 7, 10, 4, BRIDGE_OFF_DEFAULT },
+    { 8, 1, 10, 4, BRIDGE_OFF_DEFAULT },
+    { 1, 9, 2, 7, BRIDGE_OFF_DEFAULT },
+    { 3, 4, 2, 7, BRIDGE_OFF_DEFAULT },
+    { 3, 4, 6, 9, BRIDGE_OFF_DEFAULT },
+    { 3, 4, 0, 3, BRIDGE_OFF_DEFAULT },
+    { 0, 3, 2, 7, BRIDGE_ON_DEFAULT }
+};
+
+static const struct Constellation defaultConstellations[] = {
+    { 17, 2, &defaultBridges[0] },
+    { 15, 2, &defaultBridges[17] },
+    { 16, 3, &defaultBridges[32] },
+    { 16, 2, &defaultBridges[48] },
+    { 16, 3, &defaultBridges[64] },
+    { 16, 2, &defaultBridges[80] },
+    { 16, 2, &defaultBridges[96] },
+    { 16, 3, &defaultBridges[112] },
+    { 16, 2, &defaultBridges[128] },
+    { 17, 2, &defaultBridges[144] }
+};
+
+static const int defaultConstellationsCount = sizeof(defaultConstellations)/sizeof(struct Constellation);
+
+// Constellations pack shared by all game instances (read-only)
+static struct ConstellationPack constellationPack = { 0 };
+static unsigned char *defaultConstellationPackData = NULL;      // Built-in constellations exported as a pack
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void ResetPlayer(struct Player *player);
+static void ResetCamera(Camera2D *camera, const struct Player *player);
+static void ResetBridgeStates(struct GameInstance *game);
+static void ResetGameState(struct GameState *gameState);
+static int GetRandomValueFromState(unsigned int *state, int min, int max);
+static bool IsConstellationPlayable(int constellationId);
+static int GetRandomNewConstellationId(struct GameInstance *game);
+static void MovePlayer(struct Player *player, float deltaTime);
+static void UpdatePlayer(struct Player *player, const struct InputFrame *input, float deltaTime);
+static void UpdateCameraCenterSmoothFollow(Camera2D *camera, const struct Player *player, float delta);
+static void InteractPlayerAndStars(struct GameInstance *game, const struct InputFrame *input, int constellationId);
+static bool CheckCollisionRecsStrict(Rectangle rec1, Rectangle rec2);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool LoadConstellations(const char *fileName)
+{
+    UnloadConstellations();
+
+    // NOTE: Only the header and the first stages records are checked, the pack is never scanned
+    if ((fileName != NULL) && LoadConstellationPack(&constellationPack, fileName))
+    {
+        bool valid = (constellationPack.constellationsCount >= GAMESTATE_STAGES_COUNT);
+        for (int i = 0; valid && (i < GAMESTATE_STAGES_COUNT); i += 1) valid = IsConstellationPlayable(i);
+
+        if (valid) return true;
+
+        UnloadConstellationPack(&constellationPack);
+    }
+
+    // Fallback to built-in constellations
+    unsigned long long size = 0;
+    defaultConstellationPackData = ExportConstellationPack(defaultConstellations, defaultConstellationsCount, STAR_COUNT_X, STAR_COUNT_Y, &size);
+    if ((defaultConstellationPackData == NULL) || !LoadConstellationPackFromMemory(&constellationPack, defaultConstellationPackData, size))
+    {
+        UnloadConstellations();
+        return false;
+    }
+
+    return true;
+}
+
+void UnloadConstellations(void)
+{
+    UnloadConstellationPack(&constellationPack);
+
+    free(defaultConstellationPackData);
+    defaultConstellationPackData = NULL;
+}
+
+const struct Constellation *GetDefaultConstellations(int *count)
+{
+    *count = defaultConstellationsCount;
+    return defaultConstellations;
+}
+
+void InitGameInstance(struct GameInstance *game, unsigned int seed)
+{
+    // NOTE: A xorshift generator state must never be zero
+    game->randomState = (seed != 0) ? seed : 0x9e3779b9;
+
+    ResetPlayer(&game->player);
+    ResetCamera(&game->camera, &game->player);
+    ResetBridgeStates(game);
+    ResetGameState(&game->gameState);
+
+    game->prevPlayerPosition = game->player.position;
+    game->prevCameraTarget = game->camera.target;
+}
+
+void GameStep(struct GameInstance *game, const struct InputFrame *input, float deltaTime)
+{
+    struct GameState *gameState = &game->gameState;
+    struct Player *player = &game->player;
+
+    game->prevPlayerPosition = player->position;
+    game->prevCameraTarget = game->camera.target;
+
+    gameState->clockSeconds += deltaTime;
+    switch (gameState->state)
+    {
+        case GAMESTATE_START:
+        {
+            UpdatePlayer(player, input, deltaTime);
+            UpdateCameraCenterSmoothFollow(&game->camera, player, deltaTime);
+
+            if (gameState->clockSeconds >= 5.0f)
+            {
+                gameState->clockSeconds = 0;
+                struct GameStateStage *stage = &gameState->stages[gameState->stageId];
+                stage->constellationId = GetRandomNewConstellationId(game);
+                stage->requiredScore = GetConstellationRequiredScore(stage->constellationId);
+                ResetBridgeStates(game);
+                gameState->state = GAMESTATE_GAMEPLAY;
+            }
+        } break;
+        case GAMESTATE_GAMEPLAY:
+        {
+            struct GameStateStage *stage = &gameState->stages[gameState->stageId];
+
+            stage->timerSeconds += deltaTime;
+
+            UpdatePlayer(player, input, deltaTime);
+            UpdateCameraCenterSmoothFollow(&game->camera, player, deltaTime);
+            InteractPlayerAndStars(game, input, stage->constellationId);
+
+            if (stage->score == stage->requiredScore)
+            {
+                gameState->clockSeconds = 0;
+                gameState->state = GAMESTATE_CLEAR;
+            }
+        } break;
+        case GAMESTATE_CLEAR:
+        {
+            UpdatePlayer(player, input, deltaTime);
+            UpdateCameraCenterSmoothFollow(&game->camera, player, deltaTime);
+
+            if (gameState->clockSeconds <= 5.0f)
+            {
+                break;
+            }
+
+            if (gameState->stageId == GAMESTATE_STAGES_COUNT - 1)
+            {
+                gameState->clockSeconds = 0;
+                gameState->state = GAMESTATE_RESULT;
+            } else
+            {
+                gameState->clockSeconds = 0;
+                gameState->stageId += 1;
+                gameState->state = GAMESTATE_START;
+            }
+        } break;
+        case GAMESTATE_RESULT:
+        {
+            if (gameState->clockSeconds >= 2.0f)
+            {
+                if (input->buttons & INPUT_BUTTON_RESTART)
+                {
+                    ResetPlayer(&game->player);
+                    ResetCamera(&game->camera, &game->player);
+                    ResetBridgeStates(game);
+                    ResetGameState(&game->gameState);
+
+                    // Do not interpolate from the previous run positions
+                    game->prevPlayerPosition = game->player.position;
+                    game->prevCameraTarget = game->camera.target;
+                }
+            }
+        } break;
+    }
+}
+
+Vector2 GetInterpolatedPlayerPosition(const struct GameInstance *game, float alpha)
+{
+    return Vector2Lerp(game->prevPlayerPosition, game->player.position, alpha);
+}
+
+Vector2 GetInterpolatedCameraTarget(const struct GameInstance *game, float alpha)
+{
+    return Vector2Lerp(game->prevCameraTarget, game->camera.target, alpha);
+}
+
+int GetConstellationRequiredScore(int constellationId)
+{
+    struct ConstellationView view = { 0 };
+    if (!GetPackConstellation(&constellationPack, constellationId, &view)) return 0;
+
+    int requiredScore = view.bridgesCount - view.startingScore;
+    return requiredScore;
+}
+
+int GetConstellationsCount(void)
+{
+    return constellationPack.constellationsCount;
+}
+
+const struct ConstellationPack *GetConstellationPack(void)
+{
+    return &constellationPack;
+}
+
+bool GetGameConstellation(const struct GameInstance *game, struct ConstellationView *view)
+{
+    const struct GameStateStage *stage = &game->gameState.stages[game->gameState.stageId];
+    if (stage->constellationId == -1)
+    {
+        *view = (struct ConstellationView){ 0 };
+        return false;
+    }
+    return GetPackConstellation(&constellationPack, stage->constellationId, view);
+}
+
+enum BridgeState GetGameBridgeState(const struct GameInstance *game, const struct ConstellationView *view, int bridgeId)
+{
+    if (game->litBridges[bridgeId/32] & (1u << (bridgeId%32))) return BRIDGE_ON;
+    return GetConstellationViewBridgeState(view, bridgeId);
+}
+
+Vector2 GetStarPosition(int x, int y)
+{
+    Vector2 position = { x*STAR_SPACING_PIXELS, y*STAR_SPACING_PIXELS };
+    return position;
+}
+
+Vector2 GetLastStarPosition(void)
+{
+    return GetStarPosition(constellationPack.starCountX - 1, constellationPack.starCountY - 1);
+}
+
+Rectangle GetStarRec(Vector2 position)
+{
+    Rectangle starRec = { 0 };
+    starRec.x = position.x - (float)STAR_REC_WIDTH_PIXELS/2.0f;
+    starRec.y = position.y - (float)STAR_REC_HEIGHT_PIXELS/2.0f;
+    starRec.width = (float)STAR_REC_WIDTH_PIXELS;
+    starRec.height = (float)STAR_REC_HEIGHT_PIXELS;
+    return starRec;
+}
+
+Rectangle GetPlayerRec(Vector2 position)
+{
+    Rectangle playerRec = { 0 };
+    playerRec.x = position.x - (float)PLAYER_REC_WIDTH_PIXELS/2.0f;
+    playerRec.y = position.y - (float)PLAYER_REC_HEIGHT_PIXELS/2.0f;
+    playerRec.width = (float)PLAYER_REC_WIDTH_PIXELS;
+    playerRec.height = (float)PLAYER_REC_HEIGHT_PIXELS;
+    return playerRec;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+void ResetPlayer(struct Player *player)
+{
+    player->state = PLAYER_IDLE;
+    player->position = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
+    player->direction = (Vector2){ 0.0f, 0.0f };
+    player->speed = PLAYER_SPEED;
+    player->movementDurationSeconds = 0.0f;
+    player->isGrabbingStar = false;
+    player->grabbedStarX = -1;
+    player->grabbedStarY = -1;
+    player->flappingDurationSeconds = 0.0f;
+    player->flappingUp = true;
+    player->isFacingRight = false;
+}
+
+void ResetCamera(Camera2D *camera, const struct Player *player)
+{
+    camera->target = player->position;
+    camera->offset = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
+    camera->rotation = 0.0f;
+    camera->zoom = 1.0f;
+}
+
+// Reset bridge states to the defaults of the stage constellation
+// NOTE: Default states are read from the pack, only the lit bridges are game state
+void ResetBridgeStates(struct GameInstance *game)
+{
+    memset(game->litBridges, 0, sizeof(game->litBridges));
+    game->bridgesVersion += 1;
+}
+
+void ResetGameState(struct GameState *gameState)
+{
+    gameState->state = GAMESTATE_START;
+    gameState->clockSeconds = 0.0f;
+    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+    {
+        gameState->stages[i] = (struct GameStateStage){ -1, 0, 0, 0.0f };
+    }
+    gameState->stageId = 0;
+}
+
+// Get a random value in [min, max] from a xorshift32 generator state
+// NOTE: Replaces raylib GetRandomValue() so every instance owns its random sequence
+int GetRandomValueFromState(unsigned int *state, int min, int max)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return min + (int)(x%(unsigned int)(max - min + 1));
+}
+
+// Check if a pack constellation record is valid and fits in a game instance
+bool IsConstellationPlayable(int constellationId)
+{
+    struct ConstellationView view = { 0 };
+    return GetPackConstellation(&constellationPack, constellationId, &view) &&
+           (view.bridgesCount <= GAME_MAX_BRIDGES_COUNT) &&
+           (view.startingScore <= view.bridgesCount);
+}
+
+int GetRandomNewConstellationId(struct GameInstance *game)
+{
+    const int constellationsCount = constellationPack.constellationsCount;
+
+    bool cond = false;
+    int randId = -1;
+    int attempts = 0;
+    do
+    {
+        randId = GetRandomValueFromState(&game->randomState, 0, constellationsCount - 1);
+        cond = !IsConstellationPlayable(randId);
+        for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+        {
+            if (randId == game->gameState.stages[i].constellationId)
+            {
+                cond = true;
+                break;
+            }
+        }
+        attempts += 1;
+    } while (cond && (attempts < 64));
+
+    // NOTE: Packs with many invalid records fallback to the next playable constellation,
+    // there is always one since the first stages records are checked on load
+    for (int k = 0; cond && (k < constellationsCount); k += 1)
+    {
+        randId = (randId + 1)%constellationsCount;
+        cond = !IsConstellationPlayable(randId);
+        for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+        {
+            if (randId == game->gameState.stages[i].constellationId) cond = true;
+        }
+    }
+    return randId;
+}
+
+void MovePlayer(struct Player *player, float deltaTime)
+{
+    player->position.x += player->direction.x*player->speed*deltaTime;
+    player->position.y += player->direction.y*player->speed*deltaTime;
+
+    // The positions of the first and the last stars
+    // are used to determine the "walls" of the screen.
+    const Vector2 firstStar = GetStarPosition(0, 0);
+    const Vector2 lastStar = GetLastStarPosition();
+
+    if (player->position.x < firstStar.x)
+    {
+        player->position.x = firstStar.x;
+    } else if (player->position.x > lastStar.x)
+    {
+        player->position.x = lastStar.x;
+    }
+
+    if (player->position.y < firstStar.y)
+    {
+        player->position.y = firstStar.y;
+    } else if (player->position.y > lastStar.y)
+    {
+        player->position.y = lastStar.y;
+    }
+}
+
+void UpdatePlayer(struct Player *player, const struct InputFrame *input, float deltaTime)
+{
+    player->movementDurationSeconds += deltaTime;
+
+    switch (player->state)
+    {
+        case PLAYER_STUNNED:
+        {
+            if (player->movementDurationSeconds >= PLAYER_STUN_COOLDOWN_SECONDS)
+            {
+                player->movementDurationSeconds = 0.0f;
+                player->state = PLAYER_IDLE;
+            }
+        } break;
+        case PLAYER_IDLE:
+        {
+            player->direction.x = 0;
+            player->direction.y = 0;
+
+            if (input->buttons & INPUT_BUTTON_LEFT) player->direction.x -= 1;
+            if (input->buttons & INPUT_BUTTON_RIGHT) player->direction.x += 1;
+            if (input->buttons & INPUT_BUTTON_UP) player->direction.y -= 1;
+            if (input->buttons & INPUT_BUTTON_DOWN) player->direction.y += 1;
+
+            if (player->direction.x < 0)
+            {
+                player->isFacingRight = false;
+            } else if (player->direction.x > 0)
+            {
+                player->isFacingRight = true;
+            }
+
+            if (input->buttons & INPUT_BUTTON_BOOST)
+            {
+                player->speed += PLAYER_BOOST;
+                player->movementDurationSeconds = 0.0f;
+                player->state = PLAYER_JUMPING;
+            }
+
+            MovePlayer(player, deltaTime);
+        } break;
+        case PLAYER_JUMPING:
+        {
+            // Note that the direction cannot change while jumping.
+            // This is a way to nerf the jump mechanic.
+
+            if (player->movementDurationSeconds >= PLAYER_JUMP_COOLDOWN_SECONDS)
+            {
+                player->speed -= PLAYER_BOOST;
+                player->movementDurationSeconds = 0.0f;
+                player->state = PLAYER_IDLE;
+            }
+
+            MovePlayer(player, deltaTime);
+        } break;
+    }
+
+    // Wing flapping animation, part of the player state so drawing is side-effect free
+    player->flappingDurationSeconds += deltaTime;
+    if (player->flappingDurationSeconds >= PLAYER_FLAPPING_DURATION_SECONDS)
+    {
+        player->flappingDurationSeconds = 0.0f;
+        player->flappingUp = !player->flappingUp;
+    }
+}
+
+// TODO: Study this...
+void UpdateCameraCenterSmoothFollow(Camera2D *camera, const struct Player *player, float delta)
+{
+    const float minSpeed = 30;
+    const float minEffectLength = 10;
+    const float fractionSpeed = 0.8f;
+
+    camera->offset = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
+    Vector2 diff = Vector2Subtract(player->position, camera->target);
+    float length = Vector2Length(diff);
+
+    if (length > minEffectLength)
+    {
+        float speed = fmaxf(fractionSpeed*length, minSpeed);
+        camera->target = Vector2Add(camera->target, Vector2Scale(diff, speed*delta/length));
+    }
+}
+
+void InteractPlayerAndStars(struct GameInstance *game, const struct InputFrame *input, int constellationId)
+{
+    struct Player *player = &game->player;
+
+    if ((player->state == PLAYER_STUNNED) || !(input->buttons & INPUT_BUTTON_GRAB))
+    {
+           return;
+    }
+
+    const Rectangle playerRec = GetPlayerRec(player->position);
+
+    int closestStarX = lrintf(player->position.x/(float)STAR_SPACING_PIXELS);
+    int closestStarY = lrintf(player->position.y/(float)STAR_SPACING_PIXELS);
+
+    const Vector2 closestStarPos = GetStarPosition(closestStarX, closestStarY);
+    const Rectangle closestStarRec = GetStarRec(closestStarPos);
+
+    if (!CheckCollisionRecsStrict(playerRec, closestStarRec))
+    {
+        return;
+    }
+
+    if (player->isGrabbingStar)
+    {
+        if ((player->grabbedStarX == closestStarX) && (player->grabbedStarY == closestStarY))
+        {
+            // Do not allow to "drop" a grabbed star onto itself
+            return;
+        }
+
+        // NOTE: A record failing to load has no bridges, dropping the star stuns
+        struct ConstellationView view = { 0 };
+        const bool isConstellationValid = GetPackConstellation(&constellationPack, constellationId, &view);
+        const int constellationBridgeId = isConstellationValid? FindBridge(&view.index,
+                                                                           player->grabbedStarX, player->grabbedStarY,
+                                                                           closestStarX, closestStarY) : -1;
+        if ((constellationBridgeId == -1) || (GetGameBridgeState(game, &view, constellationBridgeId) != BRIDGE_OFF_DEFAULT))
+        {
+            player->movementDurationSeconds = 0.0f;
+            player->state = PLAYER_STUNNED;
+        } else
+        {
+            game->litBridges[constellationBridgeId/32] |= (1u << (constellationBridgeId%32));
+            game->bridgesVersion += 1;
+            game->gameState.stages[game->gameState.stageId].score += 1;
+        }
+        player->grabbedStarX = -1;
+        player->grabbedStarY = -1;
+        player->isGrabbingStar = false;
+    } else
+    {
+        player->grabbedStarX = closestStarX;
+        player->grabbedStarY = closestStarY;
+        player->isGrabbingStar = true;
+    }
+}
+
+// Check collision between two rectangles, same test as raylib CheckCollisionRecs()
+// NOTE: Reimplemented here to keep the simulation independent of the raylib library
+bool CheckCollisionRecsStrict(Rectangle rec1, Rectangle rec2)
+{
+    return ((rec1.x < (rec2.x + rec2.width)) && ((rec1.x + rec1.width) > rec2.x) &&
+            (rec1.y < (rec2.y + rec2.height)) && ((rec1.y + rec1.height) > rec2.y));
+}
@@ -0,0 +1,164 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Game simulation
+*
+*   All the mutable state of a game lives in a GameInstance and is advanced by GameStep().
+*   The simulation never calls into the raylib window, input or drawing modules (only raylib
+*   types are used), so any number of instances can be stepped in the same process, with or
+*   without a window.
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef GAME_H
+#define GAME_H
+
+#include "raylib.h"                         // Required for: Vector2, Rectangle, Camera2D
+
+#include "constellation.h"                  // Required for: struct Constellation, struct ConstellationView
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SCREEN_WIDTH_PIXELS 256
+#define SCREEN_HEIGHT_PIXELS 256
+
+// Fixed simulation tick, independent of the render frame rate
+#define GAME_TICK_SECONDS (1.0f/60.0f)
+#define GAME_MAX_FRAME_SECONDS 0.25f        // Longer frames are clamped to avoid a spiral of catch-up ticks
+
+// Star grid of the built-in constellations, the star field of a game is the loaded pack grid
+#define STAR_COUNT_X 11
+#define STAR_COUNT_Y 15
+#define STAR_SPACING_PIXELS 64
+#define STAR_REC_WIDTH_PIXELS 16
+#define STAR_REC_HEIGHT_PIXELS 16
+
+#define PLAYER_REC_WIDTH_PIXELS 20
+#define PLAYER_REC_HEIGHT_PIXELS 25
+// NOTE: Balance constants can be overridden at build time to evaluate changes (see playtest.c)
+#ifndef PLAYER_SPEED
+    #define PLAYER_SPEED 72.0f
+#endif
+#ifndef PLAYER_BOOST
+    #define PLAYER_BOOST 24.0f
+#endif
+#ifndef PLAYER_STUN_COOLDOWN_SECONDS
+    #define PLAYER_STUN_COOLDOWN_SECONDS 1.0f
+#endif
+#ifndef PLAYER_JUMP_COOLDOWN_SECONDS
+    #define PLAYER_JUMP_COOLDOWN_SECONDS 0.5f
+#endif
+#define PLAYER_FLAPPING_DURATION_SECONDS 0.7f
+
+#define GAMESTATE_STAGES_COUNT 3
+
+// Max bridges of a playable constellation, bounds the lit bridges bitset of a game instance
+#define GAME_MAX_BRIDGES_COUNT 1024
+#define GAME_LIT_BRIDGES_WORDS (GAME_MAX_BRIDGES_COUNT/32)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+enum PlayerState {
+    PLAYER_IDLE,
+    PLAYER_STUNNED,
+    PLAYER_JUMPING,
+};
+
+struct Player {
+    enum PlayerState state;
+    Vector2 position;
+    Vector2 direction;
+    float speed;
+    float movementDurationSeconds;
+    bool isGrabbingStar;
+    int grabbedStarX;
+    int grabbedStarY;
+    float flappingDurationSeconds;
+    bool flappingUp;
+    bool isFacingRight;
+};
+
+enum GameStateState {
+    GAMESTATE_START,
+    GAMESTATE_GAMEPLAY,
+    GAMESTATE_CLEAR,
+    GAMESTATE_RESULT,
+};
+
+struct GameStateStage {
+    int constellationId;
+    int score;
+    int requiredScore;          // Score to clear the stage, set when the constellation is chosen
+    float timerSeconds;
+};
+
+struct GameState {
+    enum GameStateState state;
+    float clockSeconds;
+    int stageId;
+    struct GameStateStage stages[GAMESTATE_STAGES_COUNT];
+};
+
+// Buttons of an input frame
+// NOTE: Movement and boost are sampled as held, grab, restart and debug as pressed this frame.
+// Debug toggles the frontend debug mode, it is ignored by the simulation (only recorded)
+enum InputButton {
+    INPUT_BUTTON_LEFT = 1 << 0,
+    INPUT_BUTTON_RIGHT = 1 << 1,
+    INPUT_BUTTON_UP = 1 << 2,
+    INPUT_BUTTON_DOWN = 1 << 3,
+    INPUT_BUTTON_BOOST = 1 << 4,
+    INPUT_BUTTON_GRAB = 1 << 5,
+    INPUT_BUTTON_RESTART = 1 << 6,
+    INPUT_BUTTON_DEBUG = 1 << 7,
+};
+
+struct InputFrame {
+    unsigned int buttons;       // Combination of InputButton flags
+};
+
+// Complete state of one game, no pointers inside so it can be freely copied
+struct GameInstance {
+    struct GameState gameState;
+    struct Player player;
+    Camera2D camera;
+    Vector2 prevPlayerPosition;         // Player position at the start of the last step, for render interpolation
+    Vector2 prevCameraTarget;           // Camera target at the start of the last step, for render interpolation
+    unsigned int litBridges[GAME_LIT_BRIDGES_WORDS];    // Bridges lit by the player in the current stage constellation, one bit per bridge
+    unsigned int bridgesVersion;        // Incremented on every bridge state change, lets renderers cache constellation drawings
+    unsigned int randomState;
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool LoadConstellations(const char *fileName);                          // Load constellations pack shared by all game instances, built-in constellations if NULL or invalid
+void UnloadConstellations(void);                                        // Unload constellations pack
+void InitGameInstance(struct GameInstance *game, unsigned int seed);    // Reset all the game state, seeding the game random generator
+void GameStep(struct GameInstance *game, const struct InputFrame *input, float deltaTime);    // Advance the game state machine by deltaTime seconds (GAME_TICK_SECONDS)
+Vector2 GetInterpolatedPlayerPosition(const struct GameInstance *game, float alpha);    // Get player position between the last two steps, alpha in [0, 1]
+Vector2 GetInterpolatedCameraTarget(const struct GameInstance *game, float alpha);      // Get camera target between the last two steps, alpha in [0, 1]
+
+int GetConstellationRequiredScore(int constellationId);
+int GetConstellationsCount(void);                                       // Get constellations count of the loaded pack
+const struct ConstellationPack *GetConstellationPack(void);            // Get the loaded pack, shared by all game instances
+bool GetGameConstellation(const struct GameInstance *game, struct ConstellationView *view);     // Get current stage constellation, false if not chosen yet
+enum BridgeState GetGameBridgeState(const struct GameInstance *game, const struct ConstellationView *view, int bridgeId);   // Get current stage constellation bridge state (BRIDGE_ON if lit)
+const struct Constellation *GetDefaultConstellations(int *count);       // Get built-in constellations (used to generate packs)
+Vector2 GetStarPosition(int x, int y);
+Vector2 GetLastStarPosition(void);                                      // Get position of the last star of the star field (pack grid)
+Rectangle GetStarRec(Vector2 position);
+Rectangle GetPlayerRec(Vector2 position);
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // GAME_H
@@ -0,0 +1,484 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellation generator
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "generator.h"
+
+#include "jobs.h"                           // Required for: RunJobs(), GetCpuCoresCount()
+
+#include <stdlib.h>                         // Required for: abs()
+#include <math.h>                           // Required for: sqrtf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define GENERATOR_MAX_THREADS JOBS_MAX_THREADS
+#define GENERATOR_MAX_ATTEMPTS 64           // Graphs restarted from scratch before giving up
+#define GENERATOR_MAX_TRIES 256             // Random stars or bridges tried before restarting a graph
+
+#define GENERATOR_AMBIGUOUS_COS 0.94f       // Bridges on a star closer than ~20 degrees are ambiguous
+#define GENERATOR_AMBIGUOUS_DISTANCE 0.5f   // Bridges closer to a star (grid units) are ambiguous
+#define GENERATOR_HARD_PATH_LENGTH 100.0f   // Path length (grid units) scored as the hardest
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Constellation graph being generated or validated
+struct GeneratorGraph {
+    int starsCount;
+    int starX[GENERATOR_MAX_STARS];
+    int starY[GENERATOR_MAX_STARS];
+    int bridgesCount;
+    int bridgeStars[GENERATOR_MAX_BRIDGES][2];
+};
+
+struct GeneratorJob {
+    const struct GeneratorSettings *settings;
+    int count;
+    struct ConstellationBridge *bridges;
+    struct Constellation *constellations;
+    struct ConstellationDifficulty *difficulties;
+    int firstId;                        // Job generates firstId, firstId + threadsCount...
+    int threadsCount;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int GetGeneratorRandomValue(unsigned int *state, int min, int max);
+static int GetChebyshevDistance(int x1, int y1, int x2, int y2);
+static bool IsPointOnSegment(int x, int y, int x1, int y1, int x2, int y2);
+static bool DoSegmentsCross(int ax1, int ay1, int ax2, int ay2, int bx1, int by1, int bx2, int by2);
+static int FindGraphStar(const struct GeneratorGraph *graph, int x, int y);
+static bool IsStarPositionValid(const struct GeneratorGraph *graph, const struct GeneratorSettings *settings, int x, int y);
+static bool IsBridgeValid(const struct GeneratorGraph *graph, const struct GeneratorSettings *settings, int star1, int star2);
+static bool GenerateGraph(struct GeneratorGraph *graph, const struct GeneratorSettings *settings, unsigned int *state, int starsCount, int bridgesCount);
+static void RunGeneratorJob(void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+struct GeneratorSettings GetDefaultGeneratorSettings(int starCountX, int starCountY)
+{
+    struct GeneratorSettings settings = { 0 };
+    settings.starCountX = starCountX;
+    settings.starCountY = starCountY;
+    settings.minBridgesCount = 15;
+    settings.maxBridgesCount = 17;
+    settings.minStartingScore = 2;
+    settings.maxStartingScore = 3;
+    settings.minBridgeLength = 2;
+    settings.maxBridgeLength = 5;
+    settings.seed = 0x9e3779b9;
+
+    return settings;
+}
+
+bool GenerateConstellation(const struct GeneratorSettings *settings, int id, struct ConstellationBridge *bridges, struct Constellation *constellation)
+{
+    *constellation = (struct Constellation){ 0, 0, bridges };
+
+    if ((settings->starCountX < 1) || (settings->starCountX > CONSTELLATION_MAX_STAR_COUNT) ||
+        (settings->starCountY < 1) || (settings->starCountY > CONSTELLATION_MAX_STAR_COUNT) ||
+        (settings->minBridgesCount < 1) || (settings->maxBridgesCount > GENERATOR_MAX_BRIDGES) ||
+        (settings->minBridgesCount > settings->maxBridgesCount) ||
+        (settings->minStartingScore < 0) || (settings->minStartingScore > settings->maxStartingScore) ||
+        (settings->minBridgeLength < 1) || (settings->minBridgeLength > settings->maxBridgeLength)) return false;
+
+    // NOTE: State only depends on (seed, id), mixed so neighbour ids are not correlated
+    unsigned int state = settings->seed ^ ((unsigned int)id*0x9e3779b9u);
+    state ^= state >> 16;
+    state *= 0x85ebca6bu;
+    state ^= state >> 13;
+    state *= 0xc2b2ae35u;
+    state ^= state >> 16;
+    if (state == 0) state = 0x9e3779b9;
+
+    // Built-in constellations have one to three independent cycles (bridges - stars + 1)
+    const int bridgesCount = GetGeneratorRandomValue(&state, settings->minBridgesCount, settings->maxBridgesCount);
+    int starsCount = bridgesCount + 1 - GetGeneratorRandomValue(&state, 1, 3);
+    if (starsCount < 2) starsCount = 2;
+    if (starsCount > GENERATOR_MAX_STARS) starsCount = GENERATOR_MAX_STARS;
+
+    struct GeneratorGraph graph = { 0 };
+    bool generated = false;
+    for (int attempt = 0; (attempt < GENERATOR_MAX_ATTEMPTS) && !generated; attempt += 1)
+    {
+        generated = GenerateGraph(&graph, settings, &state, starsCount, bridgesCount);
+    }
+    if (!generated) return false;
+
+    // Bridges are shuffled and randomly oriented, their order does not tell how the graph grew
+    for (int i = graph.bridgesCount - 1; i > 0; i -= 1)
+    {
+        const int j = GetGeneratorRandomValue(&state, 0, i);
+        const int star1 = graph.bridgeStars[i][0];
+        const int star2 = graph.bridgeStars[i][1];
+        graph.bridgeStars[i][0] = graph.bridgeStars[j][0];
+        graph.bridgeStars[i][1] = graph.bridgeStars[j][1];
+        graph.bridgeStars[j][0] = star1;
+        graph.bridgeStars[j][1] = star2;
+    }
+
+    int startingScore = GetGeneratorRandomValue(&state, settings->minStartingScore, settings->maxStartingScore);
+    if (startingScore > graph.bridgesCount - 1) startingScore = graph.bridgesCount - 1;
+
+    for (int i = 0; i < graph.bridgesCount; i += 1)
+    {
+        const int flip = GetGeneratorRandomValue(&state, 0, 1);
+        const int star1 = graph.bridgeStars[i][flip];
+        const int star2 = graph.bridgeStars[i][1 - flip];
+        bridges[i] = (struct ConstellationBridge){
+            graph.starX[star1], graph.starY[star1], graph.starX[star2], graph.starY[star2],
+            (i < startingScore)? BRIDGE_ON_DEFAULT : BRIDGE_OFF_DEFAULT
+        };
+    }
+
+    constellation->bridgesCount = graph.bridgesCount;
+    constellation->startingScore = startingScore;
+
+    return true;
+}
+
+bool GenerateConstellations(const struct GeneratorSettings *settings, int count, struct ConstellationBridge *bridges, struct Constellation *constellations, struct ConstellationDifficulty *difficulties, int threadsCount)
+{
+    if (threadsCount <= 0) threadsCount = GetCpuCoresCount();
+    if (threadsCount > GENERATOR_MAX_THREADS) threadsCount = GENERATOR_MAX_THREADS;
+    if (threadsCount > count) threadsCount = (count > 0)? count : 1;
+
+    struct GeneratorJob jobs[GENERATOR_MAX_THREADS] = { 0 };
+    for (int t = 0; t < threadsCount; t += 1) jobs[t] = (struct GeneratorJob){ settings, count, bridges, constellations, difficulties, t, threadsCount };
+
+    RunJobs(RunGeneratorJob, jobs, sizeof(struct GeneratorJob), threadsCount);
+
+    // Constellations failing to generate or validate are left empty
+    for (int i = 0; i < count; i += 1)
+    {
+        if (constellations[i].bridgesCount == 0) return false;
+    }
+    return true;
+}
+
+bool ValidateConstellation(const struct GeneratorSettings *settings, const struct Constellation *constellation)
+{
+    if ((constellation->bridgesCount < settings->minBridgesCount) || (constellation->bridgesCount > settings->maxBridgesCount) ||
+        (constellation->startingScore < settings->minStartingScore) || (constellation->startingScore > settings->maxStartingScore) ||
+        (constellation->startingScore >= constellation->bridgesCount)) return false;
+
+    // Collect the stars first, every bridge is then checked against all of them and the previous bridges
+    struct GeneratorGraph graph = { 0 };
+    int onCount = 0;
+    for (int i = 0; i < constellation->bridgesCount; i += 1)
+    {
+        const struct ConstellationBridge bridge = constellation->bridges[i];
+        if (bridge.state == BRIDGE_ON_DEFAULT) onCount += 1;
+        else if (bridge.state != BRIDGE_OFF_DEFAULT) return false;
+
+        const int xs[2] = { bridge.x1, bridge.x2 };
+        const int ys[2] = { bridge.y1, bridge.y2 };
+        for (int k = 0; k < 2; k += 1)
+        {
+            if (FindGraphStar(&graph, xs[k], ys[k]) != -1) continue;
+            if (!IsStarPositionValid(&graph, settings, xs[k], ys[k]) || (graph.starsCount == GENERATOR_MAX_STARS)) return false;
+
+            graph.starX[graph.starsCount] = xs[k];
+            graph.starY[graph.starsCount] = ys[k];
+            graph.starsCount += 1;
+        }
+    }
+    if (onCount != constellation->startingScore) return false;
+
+    // Union-find over the stars, the graph must be connected
+    int parents[GENERATOR_MAX_STARS] = { 0 };
+    for (int s = 0; s < graph.starsCount; s += 1) parents[s] = s;
+    int componentsCount = graph.starsCount;
+
+    for (int i = 0; i < constellation->bridgesCount; i += 1)
+    {
+        const struct ConstellationBridge bridge = constellation->bridges[i];
+        int star1 = FindGraphStar(&graph, bridge.x1, bridge.y1);
+        int star2 = FindGraphStar(&graph, bridge.x2, bridge.y2);
+        if (!IsBridgeValid(&graph, settings, star1, star2)) return false;
+
+        graph.bridgeStars[graph.bridgesCount][0] = star1;
+        graph.bridgeStars[graph.bridgesCount][1] = star2;
+        graph.bridgesCount += 1;
+
+        while (parents[star1] != star1) star1 = parents[star1];
+        while (parents[star2] != star2) star2 = parents[star2];
+        if (star1 != star2)
+        {
+            parents[star1] = star2;
+            componentsCount -= 1;
+        }
+    }
+
+    return (componentsCount == 1);
+}
+
+struct ConstellationDifficulty GetConstellationDifficulty(const struct Constellation *constellation)
+{
+    struct ConstellationDifficulty difficulty = { 0 };
+    if (constellation->bridgesCount == 0) return difficulty;
+
+    // Stars degrees, stars are x | y << 4
+    int degrees[CONSTELLATION_MAX_STAR_COUNT*CONSTELLATION_MAX_STAR_COUNT] = { 0 };
+    int lengthsSum = 0;
+    for (int i = 0; i < constellation->bridgesCount; i += 1)
+    {
+        const struct ConstellationBridge bridge = constellation->bridges[i];
+        degrees[bridge.x1 | (bridge.y1 << CONSTELLATION_COORDINATE_BITS)] += 1;
+        degrees[bridge.x2 | (bridge.y2 << CONSTELLATION_COORDINATE_BITS)] += 1;
+        lengthsSum += GetChebyshevDistance(bridge.x1, bridge.y1, bridge.x2, bridge.y2);
+    }
+
+    int starsCount = 0;
+    int oddStarsCount = 0;
+    int branchingStarsCount = 0;
+    for (int s = 0; s < CONSTELLATION_MAX_STAR_COUNT*CONSTELLATION_MAX_STAR_COUNT; s += 1)
+    {
+        if (degrees[s] == 0) continue;
+
+        starsCount += 1;
+        if (degrees[s]%2 == 1) oddStarsCount += 1;
+        if (degrees[s] >= 3) branchingStarsCount += 1;
+    }
+
+    // NOTE: A connected graph is covered by max(1, odd/2) trails, the frog jumps between them
+    const int trailsCount = (oddStarsCount/2 > 1)? oddStarsCount/2 : 1;
+    const float meanLength = (float)lengthsSum/constellation->bridgesCount;
+    difficulty.pathLength = lengthsSum + (trailsCount - 1)*meanLength;
+    difficulty.branching = (float)branchingStarsCount/starsCount;
+
+    // Bridges leaving a star at a narrow angle, and bridges grazing a star they do not touch
+    int ambiguousCount = 0;
+    for (int i = 0; i < constellation->bridgesCount; i += 1)
+    {
+        const struct ConstellationBridge a = constellation->bridges[i];
+        const float ax = (float)(a.x2 - a.x1);
+        const float ay = (float)(a.y2 - a.y1);
+        const float aLength = sqrtf(ax*ax + ay*ay);
+
+        for (int j = i + 1; j < constellation->bridgesCount; j += 1)
+        {
+            const struct ConstellationBridge b = constellation->bridges[j];
+            float bx = (float)(b.x2 - b.x1);
+            float by = (float)(b.y2 - b.y1);
+            float sign = 0.0f;
+            if (((a.x1 == b.x1) && (a.y1 == b.y1)) || ((a.x2 == b.x2) && (a.y2 == b.y2))) sign = 1.0f;
+            else if (((a.x1 == b.x2) && (a.y1 == b.y2)) || ((a.x2 == b.x1) && (a.y2 == b.y1))) sign = -1.0f;
+            if (sign == 0.0f) continue;
+
+            // Both directions leave the shared star
+            const float cosAngle = sign*(ax*bx + ay*by)/(aLength*sqrtf(bx*bx + by*by));
+            if (cosAngle > GENERATOR_AMBIGUOUS_COS) ambiguousCount += 1;
+        }
+
+        for (int s = 0; s < CONSTELLATION_MAX_STAR_COUNT*CONSTELLATION_MAX_STAR_COUNT; s += 1)
+        {
+            if (degrees[s] == 0) continue;
+
+            const int x = s & (CONSTELLATION_MAX_STAR_COUNT - 1);
+            const int y = s >> CONSTELLATION_COORDINATE_BITS;
+            if (((x == a.x1) && (y == a.y1)) || ((x == a.x2) && (y == a.y2))) continue;
+
+            // Distance from the star to the bridge segment
+            float t = ((x - a.x1)*ax + (y - a.y1)*ay)/(aLength*aLength);
+            t = (t < 0.0f)? 0.0f : ((t > 1.0f)? 1.0f : t);
+            const float dx = a.x1 + t*ax - x;
+            const float dy = a.y1 + t*ay - y;
+            if (dx*dx + dy*dy < GENERATOR_AMBIGUOUS_DISTANCE*GENERATOR_AMBIGUOUS_DISTANCE) ambiguousCount += 1;
+        }
+    }
+    difficulty.ambiguity = (float)ambiguousCount/constellation->bridgesCount;
+
+    const float pathScore = (difficulty.pathLength < GENERATOR_HARD_PATH_LENGTH)? difficulty.pathLength/GENERATOR_HARD_PATH_LENGTH : 1.0f;
+    const float ambiguityScore = (difficulty.ambiguity < 1.0f)? difficulty.ambiguity : 1.0f;
+    difficulty.score = 100.0f*(0.5f*pathScore + 0.25f*difficulty.branching + 0.25f*ambiguityScore);
+
+    return difficulty;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Get a random value in [min, max] from a xorshift state (never zero)
+int GetGeneratorRandomValue(unsigned int *state, int min, int max)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return min + (int)(x%(unsigned int)(max - min + 1));
+}
+
+int GetChebyshevDistance(int x1, int y1, int x2, int y2)
+{
+    const int dx = abs(x2 - x1);
+    const int dy = abs(y2 - y1);
+    return (dx > dy)? dx : dy;
+}
+
+// Check if a point lies on a segment, endpoints excluded
+bool IsPointOnSegment(int x, int y, int x1, int y1, int x2, int y2)
+{
+    if ((x2 - x1)*(y - y1) - (y2 - y1)*(x - x1) != 0) return false;
+    if (((x == x1) && (y == y1)) || ((x == x2) && (y == y2))) return false;
+
+    return (x >= ((x1 < x2)? x1 : x2)) && (x <= ((x1 > x2)? x1 : x2)) &&
+           (y >= ((y1 < y2)? y1 : y2)) && (y <= ((y1 > y2)? y1 : y2));
+}
+
+// Check if two segments cross at a point inside both of them
+// NOTE: Collinear overlaps always put a star on the other segment, IsPointOnSegment() catches them
+bool DoSegmentsCross(int ax1, int ay1, int ax2, int ay2, int bx1, int by1, int bx2, int by2)
+{
+    const long long b1 = (long long)(ax2 - ax1)*(by1 - ay1) - (long long)(ay2 - ay1)*(bx1 - ax1);
+    const long long b2 = (long long)(ax2 - ax1)*(by2 - ay1) - (long long)(ay2 - ay1)*(bx2 - ax1);
+    const long long a1 = (long long)(bx2 - bx1)*(ay1 - by1) - (long long)(by2 - by1)*(ax1 - bx1);
+    const long long a2 = (long long)(bx2 - bx1)*(ay2 - by1) - (long long)(by2 - by1)*(ax2 - bx1);
+
+    return (((b1 > 0) && (b2 < 0)) || ((b1 < 0) && (b2 > 0))) &&
+           (((a1 > 0) && (a2 < 0)) || ((a1 < 0) && (a2 > 0)));
+}
+
+int FindGraphStar(const struct GeneratorGraph *graph, int x, int y)
+{
+    for (int s = 0; s < graph->starsCount; s += 1)
+    {
+        if ((graph->starX[s] == x) && (graph->starY[s] == y)) return s;
+    }
+    return -1;
+}
+
+// Check if a new star fits: on the grid, apart from the other stars and off every bridge
+bool IsStarPositionValid(const struct GeneratorGraph *graph, const struct GeneratorSettings *settings, int x, int y)
+{
+    if ((x < 0) || (x >= settings->starCountX) || (y < 0) || (y >= settings->starCountY)) return false;
+
+    for (int s = 0; s < graph->starsCount; s += 1)
+    {
+        if (GetChebyshevDistance(x, y, graph->starX[s], graph->starY[s]) < GENERATOR_MIN_STAR_SPACING) return false;
+    }
+
+    for (int i = 0; i < graph->bridgesCount; i += 1)
+    {
+        const int star1 = graph->bridgeStars[i][0];
+        const int star2 = graph->bridgeStars[i][1];
+        if (IsPointOnSegment(x, y, graph->starX[star1], graph->starY[star1], graph->starX[star2], graph->starY[star2])) return false;
+    }
+
+    return true;
+}
+
+// Check if a new bridge fits: length in range, not repeated, crossing no bridge and passing over no star
+bool IsBridgeValid(const struct GeneratorGraph *graph, const struct GeneratorSettings *settings, int star1, int star2)
+{
+    if ((star1 < 0) || (star2 < 0) || (star1 == star2)) return false;
+
+    const int x1 = graph->starX[star1];
+    const int y1 = graph->starY[star1];
+    const int x2 = graph->starX[star2];
+    const int y2 = graph->starY[star2];
+
+    const int length = GetChebyshevDistance(x1, y1, x2, y2);
+    if ((length < settings->minBridgeLength) || (length > settings->maxBridgeLength)) return false;
+
+    for (int s = 0; s < graph->starsCount; s += 1)
+    {
+        if (IsPointOnSegment(graph->starX[s], graph->starY[s], x1, y1, x2, y2)) return false;
+    }
+
+    for (int i = 0; i < graph->bridgesCount; i += 1)
+    {
+        const int other1 = graph->bridgeStars[i][0];
+        const int other2 = graph->bridgeStars[i][1];
+        if (((other1 == star1) && (other2 == star2)) || ((other1 == star2) && (other2 == star1))) return false;
+        if (DoSegmentsCross(x1, y1, x2, y2, graph->starX[other1], graph->starY[other1], graph->starX[other2], graph->starY[other2])) return false;
+    }
+
+    return true;
+}
+
+// Grow a random tree of starsCount stars from a random star, then close cycles until bridgesCount
+bool GenerateGraph(struct GeneratorGraph *graph, const struct GeneratorSettings *settings, unsigned int *state, int starsCount, int bridgesCount)
+{
+    graph->starsCount = 1;
+    graph->bridgesCount = 0;
+    graph->starX[0] = GetGeneratorRandomValue(state, 0, settings->starCountX - 1);
+    graph->starY[0] = GetGeneratorRandomValue(state, 0, settings->starCountY - 1);
+
+    while (graph->starsCount < starsCount)
+    {
+        bool added = false;
+        for (int k = 0; (k < GENERATOR_MAX_TRIES) && !added; k += 1)
+        {
+            const int star = GetGeneratorRandomValue(state, 0, graph->starsCount - 1);
+            const int x = graph->starX[star] + GetGeneratorRandomValue(state, -settings->maxBridgeLength, settings->maxBridgeLength);
+            const int y = graph->starY[star] + GetGeneratorRandomValue(state, -settings->maxBridgeLength, settings->maxBridgeLength);
+            if (!IsStarPositionValid(graph, settings, x, y)) continue;
+
+            // New star is only kept if its bridge fits too
+            const int newStar = graph->starsCount;
+            graph->starX[newStar] = x;
+            graph->starY[newStar] = y;
+            graph->starsCount += 1;
+            if (IsBridgeValid(graph, settings, star, newStar))
+            {
+                graph->bridgeStars[graph->bridgesCount][0] = star;
+                graph->bridgeStars[graph->bridgesCount][1] = newStar;
+                graph->bridgesCount += 1;
+                added = true;
+            } else
+            {
+                graph->starsCount -= 1;
+            }
+        }
+        if (!added) return false;
+    }
+
+    while (graph->bridgesCount < bridgesCount)
+    {
+        bool added = false;
+        for (int k = 0; (k < GENERATOR_MAX_TRIES) && !added; k += 1)
+        {
+            const int star1 = GetGeneratorRandomValue(state, 0, graph->starsCount - 1);
+            const int star2 = GetGeneratorRandomValue(state, 0, graph->starsCount - 1);
+            if (!IsBridgeValid(graph, settings, star1, star2)) continue;
+
+            graph->bridgeStars[graph->bridgesCount][0] = star1;
+            graph->bridgeStars[graph->bridgesCount][1] = star2;
+            graph->bridgesCount += 1;
+            added = true;
+        }
+        if (!added) return false;
+    }
+
+    return true;
+}
+
+void RunGeneratorJob(void *data)
+{
+    struct GeneratorJob *job = (struct GeneratorJob *)data;
+
+    const int stride = job->settings->maxBridgesCount;
+    for (int id = job->firstId; id < job->count; id += job->threadsCount)
+    {
+        struct Constellation *constellation = &job->constellations[id];
+        if (!GenerateConstellation(job->settings, id, &job->bridges[(long long)id*stride], constellation) ||
+            !ValidateConstellation(job->settings, constellation))
+        {
+            constellation->bridgesCount = 0;
+            job->difficulties[id] = (struct ConstellationDifficulty){ 0 };
+            continue;
+        }
+
+        job->difficulties[id] = GetConstellationDifficulty(constellation);
+    }
+}
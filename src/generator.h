@@ -0,0 +1,76 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Constellation generator
+*
+*   Generates random constellations shaped like the hand-drawn ones: connected graphs of stars
+*   on the stage grid, with bridges of a bounded length that never cross, never pass over a
+*   star, and stars kept apart so every one is a distinct point on the minimap. A few bridges
+*   are lit by default (startingScore), as in the built-in constellations.
+*
+*   Every constellation is generated from (seed, id) only, so a set of constellations does not
+*   depend on the threads count used to generate it.
+*
+*   Difficulty is scored from 0 (easy) to 100 (hard) from:
+*     - Path length: bridges lengths plus the jumps between the trails covering all of them
+*     - Branching: share of stars with 3 or more bridges, choices to make along the route
+*     - Minimap ambiguity: bridges at narrow angles on a star or grazing another star,
+*       hard to tell apart on the minimap (MINIMAP_STAR_SPACING_PIXELS between stars)
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef GENERATOR_H
+#define GENERATOR_H
+
+#include "constellation.h"                  // Required for: struct Constellation, struct ConstellationBridge
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define GENERATOR_MAX_BRIDGES 64            // Max bridges of a generated constellation
+#define GENERATOR_MAX_STARS 64              // Max stars of a generated constellation
+#define GENERATOR_MIN_STAR_SPACING 2        // Min Chebyshev distance between two stars (grid units)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct GeneratorSettings {
+    int starCountX;                     // Stage grid size, at most CONSTELLATION_MAX_STAR_COUNT per side
+    int starCountY;
+    int minBridgesCount;
+    int maxBridgesCount;                // At most GENERATOR_MAX_BRIDGES
+    int minStartingScore;               // Bridges lit by default
+    int maxStartingScore;
+    int minBridgeLength;                // Chebyshev length of a bridge (grid units)
+    int maxBridgeLength;
+    unsigned int seed;
+};
+
+struct ConstellationDifficulty {
+    float score;                        // Difficulty from 0 (easy) to 100 (hard)
+    float pathLength;                   // Bridges lengths plus jumps between trails (grid units)
+    float branching;                    // Share of stars with 3 or more bridges
+    float ambiguity;                    // Ambiguous bridge pairs and grazed stars per bridge
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+struct GeneratorSettings GetDefaultGeneratorSettings(int starCountX, int starCountY);         // Get settings matching the built-in constellations
+bool GenerateConstellation(const struct GeneratorSettings *settings, int id, struct ConstellationBridge *bridges, struct Constellation *constellation);  // Generate constellation id into bridges (maxBridgesCount entries)
+bool GenerateConstellations(const struct GeneratorSettings *settings, int count, struct ConstellationBridge *bridges, struct Constellation *constellations, struct ConstellationDifficulty *difficulties, int threadsCount);  // Generate and score constellations 0..count-1 (bridges arena of count*maxBridgesCount), threadsCount 0 uses every core
+bool ValidateConstellation(const struct GeneratorSettings *settings, const struct Constellation *constellation);   // Check a constellation follows the generator rules
+struct ConstellationDifficulty GetConstellationDifficulty(const struct Constellation *constellation);             // Score constellation difficulty
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // GENERATOR_H
@@ -0,0 +1,163 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Thread jobs
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "jobs.h"
+
+#include <stdlib.h>                         // Required for: malloc(), free()
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI                           // Avoid conflicts with raylib types (Rectangle)
+    #define NOUSER                          // Avoid conflicts with raylib functions (CloseWindow, ShowCursor)
+    #include <windows.h>                    // Required for: CreateThread(), WaitForSingleObject(), GetSystemInfo(), InterlockedExchange()
+#else
+    #include <pthread.h>                    // Required for: pthread_create(), pthread_join()
+    #include <unistd.h>                     // Required for: sysconf()
+#endif
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Job of a batch as passed to its thread
+struct JobCall {
+    JobFunction function;
+    void *job;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+#if defined(_WIN32)
+static DWORD WINAPI JobThreadMain(LPVOID call);
+static DWORD WINAPI BackgroundJobThreadMain(LPVOID job);
+#else
+static void *JobThreadMain(void *call);
+static void *BackgroundJobThreadMain(void *job);
+#endif
+static void *StartJobThread(void *data, bool isBackground);
+static void JoinJobThread(void *thread);
+static void RunBackgroundJob(struct BackgroundJob *job);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+void RunJobs(JobFunction function, void *jobs, int jobSize, int jobsCount)
+{
+    if (jobsCount > JOBS_MAX_THREADS) jobsCount = JOBS_MAX_THREADS;
+
+    struct JobCall calls[JOBS_MAX_THREADS] = { 0 };
+    for (int t = 0; t < jobsCount; t += 1) calls[t] = (struct JobCall){ function, (char *)jobs + (size_t)t*jobSize };
+
+    // Job 0 runs on the calling thread, jobs of threads failing to start too
+    void *threads[JOBS_MAX_THREADS] = { 0 };
+    for (int t = 1; t < jobsCount; t += 1) threads[t] = StartJobThread(&calls[t], false);
+    if (jobsCount > 0) function(calls[0].job);
+    for (int t = 1; t < jobsCount; t += 1)
+    {
+        if (threads[t] != NULL) JoinJobThread(threads[t]);
+        else function(calls[t].job);
+    }
+}
+
+bool StartBackgroundJob(struct BackgroundJob *job, JobFunction function, void *data)
+{
+    *job = (struct BackgroundJob){ function, data, NULL, 0 };
+    job->thread = StartJobThread(job, true);
+    if (job->thread != NULL) return true;
+
+    RunBackgroundJob(job);
+    return false;
+}
+
+bool IsBackgroundJobDone(struct BackgroundJob *job)
+{
+#if defined(_MSC_VER)
+    const bool isDone = (InterlockedCompareExchange((volatile LONG *)&job->isDone, 0, 0) != 0);
+#else
+    const bool isDone = (__atomic_load_n(&job->isDone, __ATOMIC_ACQUIRE) != 0);
+#endif
+    if (isDone && (job->thread != NULL))
+    {
+        JoinJobThread(job->thread);
+        job->thread = NULL;
+    }
+    return isDone;
+}
+
+void WaitBackgroundJob(struct BackgroundJob *job)
+{
+    if (job->thread != NULL)
+    {
+        JoinJobThread(job->thread);
+        job->thread = NULL;
+    }
+}
+
+int GetCpuCoresCount(void)
+{
+#if defined(_WIN32)
+    SYSTEM_INFO info = { 0 };
+    GetSystemInfo(&info);
+    const int count = (int)info.dwNumberOfProcessors;
+#else
+    const int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return (count > 0)? count : 1;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+#if defined(_WIN32)
+DWORD WINAPI JobThreadMain(LPVOID call) { ((struct JobCall *)call)->function(((struct JobCall *)call)->job); return 0; }
+DWORD WINAPI BackgroundJobThreadMain(LPVOID job) { RunBackgroundJob((struct BackgroundJob *)job); return 0; }
+#else
+void *JobThreadMain(void *call) { ((struct JobCall *)call)->function(((struct JobCall *)call)->job); return NULL; }
+void *BackgroundJobThreadMain(void *job) { RunBackgroundJob((struct BackgroundJob *)job); return NULL; }
+#endif
+
+// Start a thread running a batch job call or a background job, returns its handle (NULL if it failed to start)
+void *StartJobThread(void *data, bool isBackground)
+{
+#if defined(_WIN32)
+    return (void *)CreateThread(NULL, 0, isBackground? BackgroundJobThreadMain : JobThreadMain, data, 0, NULL);
+#else
+    pthread_t *thread = (pthread_t *)malloc(sizeof(pthread_t));
+    if (thread == NULL) return NULL;
+
+    if (pthread_create(thread, NULL, isBackground? BackgroundJobThreadMain : JobThreadMain, data) != 0)
+    {
+        free(thread);
+        return NULL;
+    }
+    return thread;
+#endif
+}
+
+// Wait for a job thread to finish and release its handle
+void JoinJobThread(void *thread)
+{
+#if defined(_WIN32)
+    WaitForSingleObject((HANDLE)thread, INFINITE);
+    CloseHandle((HANDLE)thread);
+#else
+    pthread_join(*(pthread_t *)thread, NULL);
+    free(thread);
+#endif
+}
+
+// NOTE: Job results are written before isDone, pollers reading isDone (acquire) see them
+void RunBackgroundJob(struct BackgroundJob *job)
+{
+    job->function(job->data);
+#if defined(_MSC_VER)
+    InterlockedExchange((volatile LONG *)&job->isDone, 1);
+#else
+    __atomic_store_n(&job->isDone, 1, __ATOMIC_RELEASE);
+#endif
+}
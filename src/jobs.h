@@ -0,0 +1,57 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Thread jobs
+*
+*   Runs jobs on their own threads, used by the headless tools and the par time solver:
+*
+*    - RunJobs() runs a batch of jobs, one thread each, and returns once all of them are done.
+*      Job 0 runs on the calling thread, jobs of threads failing to start too.
+*    - Background jobs run on a thread while the caller goes on, polled with IsBackgroundJobDone().
+*      If no thread can start (no threads support, as web builds) the job runs on the calling thread.
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>                        // Required for: bool
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define JOBS_MAX_THREADS 64
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+typedef void (*JobFunction)(void *job);
+
+struct BackgroundJob {
+    JobFunction function;
+    void *data;
+    void *thread;                       // Platform thread handle, NULL if the job ran on the calling thread
+    volatile unsigned int isDone;       // Set by the job thread once the job returns
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void RunJobs(JobFunction function, void *jobs, int jobSize, int jobsCount);      // Run every job of an array on its own thread (at most JOBS_MAX_THREADS), returns when all are done
+bool StartBackgroundJob(struct BackgroundJob *job, JobFunction function, void *data);   // Start a job on a thread, false if it ran on the calling thread instead
+bool IsBackgroundJobDone(struct BackgroundJob *job);                          // Check if a background job finished, its thread is joined then
+void WaitBackgroundJob(struct BackgroundJob *job);                            // Wait for a background job to finish
+int GetCpuCoresCount(void);                                                   // Get the cores available to run jobs (1 at least)
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // JOBS_H
@@ -0,0 +1,156 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Minimap pyramid
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "minimap.h"
+
+#include <stdlib.h>                         // Required for: calloc(), free()
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int GetMinimapPyramidTileId(const struct MinimapPyramid *pyramid, struct ConstellationBridge bridge, int level);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool LoadMinimapPyramid(struct MinimapPyramid *pyramid, const struct ConstellationBridge *bridges, int count)
+{
+    *pyramid = (struct MinimapPyramid){ 0 };
+
+    // Bounding box of the enabled bridges, a constellation without them has no levels
+    int minX = 0, minY = 0, maxX = -1, maxY = -1;
+    for (int i = 0; i < count; i += 1)
+    {
+        if (bridges[i].state == BRIDGE_DISABLED) continue;
+
+        const int left = (bridges[i].x1 < bridges[i].x2)? bridges[i].x1 : bridges[i].x2;
+        const int right = (bridges[i].x1 < bridges[i].x2)? bridges[i].x2 : bridges[i].x1;
+        const int top = (bridges[i].y1 < bridges[i].y2)? bridges[i].y1 : bridges[i].y2;
+        const int bottom = (bridges[i].y1 < bridges[i].y2)? bridges[i].y2 : bridges[i].y1;
+        if (maxX < minX)
+        {
+            minX = left;
+            minY = top;
+            maxX = right;
+            maxY = bottom;
+        } else
+        {
+            minX = (left < minX)? left : minX;
+            minY = (top < minY)? top : minY;
+            maxX = (right > maxX)? right : maxX;
+            maxY = (bottom > maxY)? bottom : maxY;
+        }
+    }
+    if (maxX < minX) return true;
+
+    pyramid->originX = minX;
+    pyramid->originY = minY;
+    pyramid->starCountX = maxX - minX + 1;
+    pyramid->starCountY = maxY - minY + 1;
+    while ((((pyramid->starCountX - 1) >> pyramid->tileStarsShift) + 1 > MINIMAP_PYRAMID_MAX_TILES) ||
+           (((pyramid->starCountY - 1) >> pyramid->tileStarsShift) + 1 > MINIMAP_PYRAMID_MAX_TILES))
+    {
+        pyramid->tileStarsShift += 1;
+    }
+
+    // Levels halve the tiles per side until a single tile is left
+    int tileCountX = ((pyramid->starCountX - 1) >> pyramid->tileStarsShift) + 1;
+    int tileCountY = ((pyramid->starCountY - 1) >> pyramid->tileStarsShift) + 1;
+    int tilesCount = 0;
+    while (pyramid->levelsCount < MINIMAP_PYRAMID_MAX_LEVELS)
+    {
+        pyramid->levelTileCountX[pyramid->levelsCount] = tileCountX;
+        pyramid->levelTileCountY[pyramid->levelsCount] = tileCountY;
+        pyramid->levelFirst[pyramid->levelsCount] = tilesCount;
+        pyramid->levelsCount += 1;
+        tilesCount += tileCountX*tileCountY;
+
+        if ((tileCountX == 1) && (tileCountY == 1)) break;
+        tileCountX = (tileCountX + 1)/2;
+        tileCountY = (tileCountY + 1)/2;
+    }
+
+    pyramid->tiles = (struct MinimapTile *)calloc(tilesCount, sizeof(struct MinimapTile));
+    if (pyramid->tiles == NULL)
+    {
+        UnloadMinimapPyramid(pyramid);
+        return false;
+    }
+
+    for (int i = 0; i < count; i += 1)
+    {
+        if (bridges[i].state == BRIDGE_DISABLED) continue;
+
+        const bool isLit = (bridges[i].state == BRIDGE_ON) || (bridges[i].state == BRIDGE_ON_DEFAULT);
+        for (int level = 0; level < pyramid->levelsCount; level += 1)
+        {
+            struct MinimapTile *tile = &pyramid->tiles[GetMinimapPyramidTileId(pyramid, bridges[i], level)];
+            tile->bridgesCount += 1;
+            if (isLit) tile->litBridgesCount += 1;
+        }
+    }
+
+    for (int level = 0; level < pyramid->levelsCount; level += 1)
+    {
+        const int first = pyramid->levelFirst[level];
+        const int last = first + pyramid->levelTileCountX[level]*pyramid->levelTileCountY[level];
+        for (int i = first; i < last; i += 1)
+        {
+            if (pyramid->tiles[i].bridgesCount > pyramid->levelMaxBridgesCount[level]) pyramid->levelMaxBridgesCount[level] = pyramid->tiles[i].bridgesCount;
+        }
+    }
+
+    return true;
+}
+
+void UnloadMinimapPyramid(struct MinimapPyramid *pyramid)
+{
+    free(pyramid->tiles);
+    *pyramid = (struct MinimapPyramid){ 0 };
+}
+
+// NOTE: Caller keeps the lit state of bridges, a bridge must be counted lit once
+void SetMinimapPyramidBridgeLit(struct MinimapPyramid *pyramid, struct ConstellationBridge bridge, bool isLit)
+{
+    if ((pyramid->tiles == NULL) || (bridge.state == BRIDGE_DISABLED)) return;
+
+    const int midX = (bridge.x1 + bridge.x2)/2 - pyramid->originX;
+    const int midY = (bridge.y1 + bridge.y2)/2 - pyramid->originY;
+    if ((midX < 0) || (midX >= pyramid->starCountX) || (midY < 0) || (midY >= pyramid->starCountY)) return;
+
+    for (int level = 0; level < pyramid->levelsCount; level += 1)
+    {
+        pyramid->tiles[GetMinimapPyramidTileId(pyramid, bridge, level)].litBridgesCount += isLit? 1 : -1;
+    }
+}
+
+const struct MinimapTile *GetMinimapPyramidLevel(const struct MinimapPyramid *pyramid, int level, int *tileCountX, int *tileCountY)
+{
+    if ((pyramid->tiles == NULL) || (level < 0) || (level >= pyramid->levelsCount)) return NULL;
+
+    *tileCountX = pyramid->levelTileCountX[level];
+    *tileCountY = pyramid->levelTileCountY[level];
+    return &pyramid->tiles[pyramid->levelFirst[level]];
+}
+
+int GetMinimapPyramidTileStars(const struct MinimapPyramid *pyramid, int level)
+{
+    return 1 << (pyramid->tileStarsShift + level);
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Get the tile of a level holding the middle star of a bridge
+int GetMinimapPyramidTileId(const struct MinimapPyramid *pyramid, struct ConstellationBridge bridge, int level)
+{
+    const int shift = pyramid->tileStarsShift + level;
+    const int tileX = ((bridge.x1 + bridge.x2)/2 - pyramid->originX) >> shift;
+    const int tileY = ((bridge.y1 + bridge.y2)/2 - pyramid->originY) >> shift;
+    return pyramid->levelFirst[level] + tileY*pyramid->levelTileCountX[level] + tileX;
+}
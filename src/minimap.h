@@ -0,0 +1,75 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Minimap pyramid
+*
+*   Multi-resolution summary of a constellation for minimaps of any size: the bounding box of
+*   the constellation is split in square tiles, every tile counting the bridges it holds and how
+*   many of them are lit. Every level of the pyramid halves the tiles of the previous one per
+*   side, up to a single tile:
+*
+*    - A bridge belongs to the tile of its middle star, so a bridge is counted once per level.
+*    - Level 0 tiles are 1 star wide, or the smallest power of two that keeps the level within
+*      MINIMAP_PYRAMID_MAX_TILES tiles per side.
+*    - A minimap draws the finest level with tiles of a few pixels, the tiles drawn are bounded
+*      by the minimap pixels, not by the bridges of the constellation.
+*
+*   Lighting a bridge updates its tile on every level, one tile per level, O(log n).
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+#include "constellation.h"                  // Required for: struct ConstellationBridge
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define MINIMAP_PYRAMID_MAX_TILES 256       // Level 0 tiles per side at most
+#define MINIMAP_PYRAMID_MAX_LEVELS 16       // Enough to reduce MINIMAP_PYRAMID_MAX_TILES tiles to one
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct MinimapTile {
+    int bridgesCount;                   // Bridges with their middle star in the tile (disabled ones excluded)
+    int litBridgesCount;
+};
+
+// Tiles of every level, level 0 first, row by row
+struct MinimapPyramid {
+    int originX;                        // Constellation bounding box, in stars
+    int originY;
+    int starCountX;
+    int starCountY;
+    int tileStarsShift;                 // Level 0 tiles are 1 << tileStarsShift stars wide
+    int levelsCount;
+    int levelTileCountX[MINIMAP_PYRAMID_MAX_LEVELS];
+    int levelTileCountY[MINIMAP_PYRAMID_MAX_LEVELS];
+    int levelFirst[MINIMAP_PYRAMID_MAX_LEVELS];         // First tile of every level
+    int levelMaxBridgesCount[MINIMAP_PYRAMID_MAX_LEVELS];   // Bridges of the densest tile of every level
+    struct MinimapTile *tiles;
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool LoadMinimapPyramid(struct MinimapPyramid *pyramid, const struct ConstellationBridge *bridges, int count);  // Build pyramid (disabled bridges excluded, ON ones counted lit), returns false on allocation failure
+void UnloadMinimapPyramid(struct MinimapPyramid *pyramid);                     // Free pyramid memory
+void SetMinimapPyramidBridgeLit(struct MinimapPyramid *pyramid, struct ConstellationBridge bridge, bool isLit);    // Count a bridge lit or unlit again, on every level
+const struct MinimapTile *GetMinimapPyramidLevel(const struct MinimapPyramid *pyramid, int level, int *tileCountX, int *tileCountY);  // Get the tiles of a level (NULL if none)
+int GetMinimapPyramidTileStars(const struct MinimapPyramid *pyramid, int level);    // Get the stars per side of the tiles of a level
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // MINIMAP_H
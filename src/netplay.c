@@ -0,0 +1,414 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Versus netplay
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "netplay.h"
+
+#include "constellation.h"                  // Required for: GetConstellationsCount()
+
+#include <string.h>                         // Required for: memset()
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI                           // Avoid conflicts with raylib types (Rectangle)
+    #define NOUSER                          // Avoid conflicts with raylib functions (CloseWindow, ShowCursor)
+    #include <winsock2.h>                   // Required for: socket(), bind(), sendto(), recvfrom(), ioctlsocket()
+#else
+    #include <sys/socket.h>                 // Required for: socket(), bind(), sendto(), recvfrom()
+    #include <netinet/in.h>                 // Required for: struct sockaddr_in, INADDR_LOOPBACK, htons(), htonl()
+    #include <fcntl.h>                      // Required for: fcntl()
+    #include <unistd.h>                     // Required for: close()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define NETPLAY_PACKET_HELLO 1
+#define NETPLAY_PACKET_INPUTS 2
+#define NETPLAY_HELLO_SIZE 9
+
+// Buttons sent and played, debug only toggles the frontend debug mode
+#define NETPLAY_INPUT_BUTTONS (INPUT_BUTTON_LEFT | INPUT_BUTTON_RIGHT | INPUT_BUTTON_UP | INPUT_BUTTON_DOWN | \
+                               INPUT_BUTTON_BOOST | INPUT_BUTTON_GRAB | INPUT_BUTTON_RESTART)
+// Buttons predicted as still held, pressed ones are not repeated
+#define NETPLAY_HELD_BUTTONS (INPUT_BUTTON_LEFT | INPUT_BUTTON_RIGHT | INPUT_BUTTON_UP | INPUT_BUTTON_DOWN | INPUT_BUTTON_BOOST)
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void StartNetplayGames(struct NetplaySession *session);
+static void SimulateRemoteTick(struct NetplaySession *session, int tick);
+static void RollbackRemoteGame(struct NetplaySession *session, int tick);
+static void ReceiveInputs(struct NetplaySession *session, const unsigned char *packet, int size, int *rollbackTick);
+static void SendHello(struct NetplaySession *session);
+static void SendInputs(struct NetplaySession *session);
+static void SendPacket(struct NetplaySession *session, const unsigned char *packet, int size);
+static int GetFullTick(unsigned int lowBits, int reference);
+static void WriteU16(unsigned char *bytes, unsigned int value);
+static void WriteU32(unsigned char *bytes, unsigned int value);
+static unsigned int ReadU16(const unsigned char *bytes);
+static unsigned int ReadU32(const unsigned char *bytes);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool InitNetplaySession(struct NetplaySession *session, int playerId, unsigned short localPort, unsigned short remotePort, unsigned int seed)
+{
+    memset(session, 0, sizeof(struct NetplaySession));
+    session->playerId = playerId;
+    session->remotePort = remotePort;
+    session->seed = seed;
+    session->state = NETPLAY_CONNECTING;
+    session->socketHandle = OpenLoopbackSocket(localPort);
+
+    if ((playerId < 0) || (playerId > 1) || (session->socketHandle == -1))
+    {
+        CloseNetplaySession(session);
+        session->state = NETPLAY_FAILED;
+        return false;
+    }
+
+    // Player 1 plays player 0 seed, both games are started on the first packet received
+    InitGameInstance(&session->local, seed);
+    session->remote = session->local;
+
+    return true;
+}
+
+void CloseNetplaySession(struct NetplaySession *session)
+{
+    if (session->socketHandle != -1) CloseLoopbackSocket(session->socketHandle);
+    session->socketHandle = -1;
+}
+
+// Receive every packet queued, then re-simulate the remote game from the first input mispredicted
+// NOTE: Must be called every frame, also while steps wait for the remote player (inputs are resent)
+void PollNetplaySession(struct NetplaySession *session)
+{
+    if ((session->state == NETPLAY_FAILED) || (session->socketHandle == -1)) return;
+
+    unsigned char packet[NETPLAY_MAX_PACKET_SIZE] = { 0 };
+    unsigned short port = 0;
+    int rollbackTick = session->tick;
+    bool isReceiving = false;
+    bool isHelloAnswered = false;
+
+    int size = 0;
+    while ((size = ReceiveLoopbackPacket(session->socketHandle, packet, NETPLAY_MAX_PACKET_SIZE, &port)) > 0)
+    {
+        session->stats.packetsReceived += 1;
+        session->stats.bytesReceived += size;
+
+        const int kind = packet[0] & 0x0f;
+        if ((packet[0] >> 4) != 1 - session->playerId) continue;
+        isReceiving = true;
+
+        if ((kind == NETPLAY_PACKET_HELLO) && (size == NETPLAY_HELLO_SIZE))
+        {
+            if (ReadU32(packet + 5) != (unsigned int)GetConstellationsCount())
+            {
+                session->state = NETPLAY_FAILED;
+                return;
+            }
+
+            if (session->state == NETPLAY_CONNECTING)
+            {
+                if (session->playerId == 1) session->seed = ReadU32(packet + 1);
+                StartNetplayGames(session);
+            }
+
+            // Player 1 still connecting, it might have missed our hello (player 1 hellos are only sent connecting)
+            if ((session->playerId == 0) && (session->state == NETPLAY_PLAYING) && !isHelloAnswered) SendHello(session);
+            isHelloAnswered = true;
+        } else if (kind == NETPLAY_PACKET_INPUTS)
+        {
+            // Player 1 inputs mean it got our hello, player 0 inputs can not be played without its seed
+            if ((session->state == NETPLAY_CONNECTING) && (session->playerId == 0)) StartNetplayGames(session);
+            if (session->state == NETPLAY_PLAYING) ReceiveInputs(session, packet, size, &rollbackTick);
+        }
+    }
+
+    if (rollbackTick < session->tick) RollbackRemoteGame(session, rollbackTick);
+
+    if (isReceiving) session->silentPollsCount = 0;
+    else session->silentPollsCount += 1;
+
+    if ((session->state == NETPLAY_PLAYING) && (session->silentPollsCount >= NETPLAY_TIMEOUT_POLLS)) session->state = NETPLAY_DISCONNECTED;
+
+    // Keep calling the remote player, keep resending inputs while no step sends them
+    if (session->state == NETPLAY_CONNECTING) SendHello(session);
+    else if ((session->state == NETPLAY_PLAYING) && !session->inputsSent) SendInputs(session);
+    session->inputsSent = false;
+}
+
+bool StepNetplaySession(struct NetplaySession *session, const struct InputFrame *input)
+{
+    if ((session->state == NETPLAY_CONNECTING) || (session->state == NETPLAY_FAILED)) return false;
+
+    // Remote game can not be predicted further than a rollback can re-simulate
+    if ((session->state == NETPLAY_PLAYING) && (session->tick - session->remoteInputsCount >= NETPLAY_MAX_ROLLBACK_TICKS))
+    {
+        session->stats.stalledStepsCount += 1;
+        return false;
+    }
+
+    // Leading peer lets the remote player catch up, a step now and then so the game still runs smooth
+    if ((session->state == NETPLAY_PLAYING) && (session->tickLead > 1) && (session->tick - session->lastSkipTick >= NETPLAY_SKIP_INTERVAL_TICKS))
+    {
+        session->lastSkipTick = session->tick;
+        session->stats.skippedStepsCount += 1;
+        return false;
+    }
+
+    session->localInputs[session->localInputsCount%NETPLAY_INPUTS_RING] = (unsigned char)(input->buttons & NETPLAY_INPUT_BUTTONS);
+    session->localInputsCount += 1;
+    if (session->state == NETPLAY_PLAYING) SendInputs(session);
+
+    const struct InputFrame localInput = { session->localInputs[session->tick%NETPLAY_INPUTS_RING] };
+    GameStep(&session->local, &localInput, GAME_TICK_SECONDS);
+
+    // Remote game stays as it was once the remote player is disconnected
+    if (session->state == NETPLAY_PLAYING) SimulateRemoteTick(session, session->tick);
+
+    session->tick += 1;
+
+    return true;
+}
+
+long long OpenLoopbackSocket(unsigned short port)
+{
+#if defined(_WIN32)
+    WSADATA wsaData;
+    if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) return -1;
+
+    SOCKET handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == INVALID_SOCKET)
+    {
+        WSACleanup();
+        return -1;
+    }
+#else
+    int handle = socket(AF_INET, SOCK_DGRAM, 0);
+    if (handle < 0) return -1;
+#endif
+
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+#if defined(_WIN32)
+    u_long nonBlocking = 1;
+    if ((bind(handle, (struct sockaddr *)&address, sizeof(address)) != 0) || (ioctlsocket(handle, FIONBIO, &nonBlocking) != 0))
+#else
+    if ((bind(handle, (struct sockaddr *)&address, sizeof(address)) != 0) || (fcntl(handle, F_SETFL, fcntl(handle, F_GETFL, 0) | O_NONBLOCK) != 0))
+#endif
+    {
+        CloseLoopbackSocket((long long)handle);
+        return -1;
+    }
+
+    return (long long)handle;
+}
+
+void CloseLoopbackSocket(long long socketHandle)
+{
+#if defined(_WIN32)
+    closesocket((SOCKET)socketHandle);
+    WSACleanup();
+#else
+    close((int)socketHandle);
+#endif
+}
+
+bool SendLoopbackPacket(long long socketHandle, unsigned short port, const unsigned char *data, int size)
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+    address.sin_family = AF_INET;
+    address.sin_port = htons(port);
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+#if defined(_WIN32)
+    return (sendto((SOCKET)socketHandle, (const char *)data, size, 0, (struct sockaddr *)&address, sizeof(address)) == size);
+#else
+    return (sendto((int)socketHandle, data, (size_t)size, 0, (struct sockaddr *)&address, sizeof(address)) == size);
+#endif
+}
+
+// Receive a datagram if any is queued, datagrams larger than capacity are dropped
+int ReceiveLoopbackPacket(long long socketHandle, unsigned char *buffer, int capacity, unsigned short *port)
+{
+    struct sockaddr_in address;
+    memset(&address, 0, sizeof(address));
+
+#if defined(_WIN32)
+    int addressSize = sizeof(address);
+    const int size = recvfrom((SOCKET)socketHandle, (char *)buffer, capacity, 0, (struct sockaddr *)&address, &addressSize);
+#else
+    socklen_t addressSize = sizeof(address);
+    const int size = (int)recvfrom((int)socketHandle, buffer, (size_t)capacity, 0, (struct sockaddr *)&address, &addressSize);
+#endif
+
+    if (size <= 0) return 0;
+
+    *port = ntohs(address.sin_port);
+
+    return size;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Start both games with the seed played, the first local inputs are the delay (no buttons)
+void StartNetplayGames(struct NetplaySession *session)
+{
+    InitGameInstance(&session->local, session->seed);
+    session->remote = session->local;
+    session->tick = 0;
+
+    memset(session->localInputs, 0, sizeof(session->localInputs));
+    session->localInputsCount = NETPLAY_INPUT_DELAY_TICKS;
+    session->remoteAckCount = 0;
+    session->remoteInputsCount = 0;
+    session->tickLead = 0;
+    session->lastSkipTick = 0;
+    session->state = NETPLAY_PLAYING;
+}
+
+// Advance the remote game one tick, with its input if received or predicted from the last one received
+void SimulateRemoteTick(struct NetplaySession *session, int tick)
+{
+    session->remoteStates[tick%(NETPLAY_MAX_ROLLBACK_TICKS + 1)] = session->remote;
+
+    unsigned char buttons = 0;
+    if (tick < session->remoteInputsCount) buttons = session->remoteInputs[tick%NETPLAY_INPUTS_RING];
+    else if (session->remoteInputsCount > 0) buttons = session->remoteInputs[(session->remoteInputsCount - 1)%NETPLAY_INPUTS_RING] & NETPLAY_HELD_BUTTONS;
+    session->remotePlayedInputs[tick%NETPLAY_INPUTS_RING] = buttons;
+
+    const struct InputFrame input = { buttons };
+    GameStep(&session->remote, &input, GAME_TICK_SECONDS);
+}
+
+// Restore the remote game at a tick and re-simulate it up to the current tick
+// NOTE: Local game is never rolled back, local inputs are known before they are played
+void RollbackRemoteGame(struct NetplaySession *session, int tick)
+{
+    session->remote = session->remoteStates[tick%(NETPLAY_MAX_ROLLBACK_TICKS + 1)];
+    for (int i = tick; i < session->tick; i += 1) SimulateRemoteTick(session, i);
+
+    const int ticks = session->tick - tick;
+    session->stats.rollbacksCount += 1;
+    session->stats.resimulatedTicksCount += ticks;
+    if (ticks > session->stats.maxRollbackTicks) session->stats.maxRollbackTicks = ticks;
+}
+
+// Store remote inputs received in order, lowering rollbackTick to the first one played mispredicted
+void ReceiveInputs(struct NetplaySession *session, const unsigned char *packet, int size, int *rollbackTick)
+{
+    if ((size < 6) || (size != 6 + packet[5])) return;
+
+    const int ackCount = GetFullTick(ReadU16(packet + 1), session->remoteAckCount);
+    if ((ackCount > session->remoteAckCount) && (ackCount <= session->localInputsCount)) session->remoteAckCount = ackCount;
+
+    const int firstTick = GetFullTick(ReadU16(packet + 3), session->remoteInputsCount);
+    for (int i = 0; i < packet[5]; i += 1)
+    {
+        const int tick = firstTick + i;
+        if (tick < session->remoteInputsCount) continue;    // Resent, already received
+        if (tick > session->remoteInputsCount) break;       // Previous inputs lost, they will be resent
+
+        // Inputs ring holds the ticks that can be rolled back and the ones not played yet
+        if (tick >= session->tick + NETPLAY_INPUTS_RING - NETPLAY_MAX_ROLLBACK_TICKS - 1) break;
+
+        const unsigned char buttons = packet[6 + i] & NETPLAY_INPUT_BUTTONS;
+        session->remoteInputs[tick%NETPLAY_INPUTS_RING] = buttons;
+        session->remoteInputsCount += 1;
+
+        if ((tick < *rollbackTick) && (buttons != session->remotePlayedInputs[tick%NETPLAY_INPUTS_RING])) *rollbackTick = tick;
+    }
+
+    // Tick lead, only from the newest packet: its last input is the remote tick when sent, its ack our tick a latency before.
+    // Our lead seen here (plus latency) minus the remote lead seen there (minus latency), halved
+    // NOTE: Ticks are compared as inputs counts, both are NETPLAY_INPUT_DELAY_TICKS ahead of their tick
+    if (firstTick + packet[5] == session->remoteInputsCount)
+    {
+        const int localLead = session->localInputsCount - session->remoteInputsCount;
+        const int remoteLead = session->remoteInputsCount - ackCount;
+        session->tickLead = (localLead - remoteLead)/2;
+    }
+}
+
+void SendHello(struct NetplaySession *session)
+{
+    unsigned char packet[NETPLAY_HELLO_SIZE] = { 0 };
+    packet[0] = (unsigned char)(NETPLAY_PACKET_HELLO | (session->playerId << 4));
+    WriteU32(packet + 1, session->seed);
+    WriteU32(packet + 5, (unsigned int)GetConstellationsCount());
+
+    SendPacket(session, packet, NETPLAY_HELLO_SIZE);
+}
+
+// Send every local input not acknowledged by the remote player yet
+void SendInputs(struct NetplaySession *session)
+{
+    int count = session->localInputsCount - session->remoteAckCount;
+    if (count > NETPLAY_MAX_PACKET_INPUTS) count = NETPLAY_MAX_PACKET_INPUTS;
+
+    unsigned char packet[NETPLAY_MAX_PACKET_SIZE] = { 0 };
+    packet[0] = (unsigned char)(NETPLAY_PACKET_INPUTS | (session->playerId << 4));
+    WriteU16(packet + 1, (unsigned int)session->remoteInputsCount);
+    WriteU16(packet + 3, (unsigned int)session->remoteAckCount);
+    packet[5] = (unsigned char)count;
+    for (int i = 0; i < count; i += 1) packet[6 + i] = session->localInputs[(session->remoteAckCount + i)%NETPLAY_INPUTS_RING];
+
+    SendPacket(session, packet, 6 + count);
+    session->inputsSent = true;
+}
+
+void SendPacket(struct NetplaySession *session, const unsigned char *packet, int size)
+{
+    if (SendLoopbackPacket(session->socketHandle, session->remotePort, packet, size))
+    {
+        session->stats.packetsSent += 1;
+        session->stats.bytesSent += size;
+    }
+}
+
+// Get the tick closest to a reference tick with the given 16 low bits
+int GetFullTick(unsigned int lowBits, int reference)
+{
+    int delta = (int)((lowBits - (unsigned int)reference) & 0xffff);
+    if (delta >= 0x8000) delta -= 0x10000;
+
+    return reference + delta;
+}
+
+void WriteU16(unsigned char *bytes, unsigned int value)
+{
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+}
+
+void WriteU32(unsigned char *bytes, unsigned int value)
+{
+    bytes[0] = (unsigned char)value;
+    bytes[1] = (unsigned char)(value >> 8);
+    bytes[2] = (unsigned char)(value >> 16);
+    bytes[3] = (unsigned char)(value >> 24);
+}
+
+unsigned int ReadU16(const unsigned char *bytes)
+{
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8);
+}
+
+unsigned int ReadU32(const unsigned char *bytes)
+{
+    return (unsigned int)bytes[0] | ((unsigned int)bytes[1] << 8) | ((unsigned int)bytes[2] << 16) | ((unsigned int)bytes[3] << 24);
+}
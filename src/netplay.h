@@ -0,0 +1,122 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Versus netplay
+*
+*   Two players race through the same three stages over UDP, on localhost. Both games are seeded
+*   alike, so every frog plays the same constellations; each frog lights its own bridges and the
+*   fastest run wins. Every peer simulates both games with fixed ticks, from the inputs alone:
+*
+*    - Local input is delayed by NETPLAY_INPUT_DELAY_TICKS, it reaches the other peer before the
+*      tick it is played in most of the times.
+*    - Remote input not received yet is predicted (movement and boost held as last received).
+*      When it arrives and differs, the remote game is restored from the state saved at that tick
+*      and re-simulated up to the current tick (rollback).
+*    - Peers never run more than NETPLAY_MAX_ROLLBACK_TICKS ahead of the remote inputs received,
+*      they wait instead, so a rollback re-simulates at most that many ticks in a frame.
+*    - Player 1 starts on the first hello and player 0 on the first inputs, a one-way latency
+*      later. Every peer estimates its tick lead from the inputs acknowledged both ways (latency
+*      cancels out) and, while ahead by more than a tick, skips a step every
+*      NETPLAY_SKIP_INTERVAL_TICKS, so no peer keeps mispredicting the other one all the match.
+*
+*   GameInstance has no pointers, a saved state is a plain copy of it (see snapshot.h).
+*
+*   Packets (all numbers little-endian, u16 ticks are the low bits of the tick):
+*
+*       HELLO       u8 kind|player<<4, u32 seed, u32 constellations count          (connecting)
+*       INPUTS      u8 kind|player<<4, u16 inputs received (ack), u16 first tick,
+*                   u8 count, count u8 inputs                                      (one per tick)
+*
+*   An INPUTS packet carries every local input not acknowledged yet, so a lost packet is
+*   recovered by the next one. Inputs are the InputButton bits played (debug bit excluded).
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef NETPLAY_H
+#define NETPLAY_H
+
+#include "game.h"                           // Required for: struct GameInstance, struct InputFrame
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define NETPLAY_PORT 27960                  // Player 0 local port, player 1 uses the next one
+#define NETPLAY_INPUT_DELAY_TICKS 2
+#define NETPLAY_MAX_ROLLBACK_TICKS 10       // Ticks re-simulated in a frame at most
+#define NETPLAY_SKIP_INTERVAL_TICKS 8       // Ticks played between two steps skipped by the leading peer
+#define NETPLAY_INPUTS_RING 128             // Inputs kept per player (power of two, covers the ticks not acknowledged)
+#define NETPLAY_MAX_PACKET_INPUTS 64
+#define NETPLAY_MAX_PACKET_SIZE (6 + NETPLAY_MAX_PACKET_INPUTS)
+#define NETPLAY_TIMEOUT_POLLS 300           // Polls without packets before the remote player is disconnected (5 seconds at 60 fps)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+enum NetplayState {
+    NETPLAY_CONNECTING,                 // Waiting for the remote player
+    NETPLAY_PLAYING,
+    NETPLAY_DISCONNECTED,               // Remote player stopped sending, local game goes on alone
+    NETPLAY_FAILED                      // Socket error or different constellations packs
+};
+
+struct NetplayStats {
+    int rollbacksCount;
+    int resimulatedTicksCount;
+    int maxRollbackTicks;
+    int stalledStepsCount;              // Steps waited for remote inputs
+    int skippedStepsCount;              // Steps skipped to let the remote player catch up
+    int packetsSent;
+    int bytesSent;
+    int packetsReceived;
+    int bytesReceived;
+};
+
+struct NetplaySession {
+    long long socketHandle;             // -1 if not open
+    unsigned short remotePort;
+    int playerId;                       // 0 or 1, player 0 seed is played
+    enum NetplayState state;
+    unsigned int seed;
+    int tick;                           // Ticks played by both games
+    struct GameInstance local;          // Game of this peer player
+    struct GameInstance remote;         // Game of the remote player, predicted after its last input received
+    struct GameInstance remoteStates[NETPLAY_MAX_ROLLBACK_TICKS + 1];     // Remote game at the start of the last ticks
+    unsigned char localInputs[NETPLAY_INPUTS_RING];
+    int localInputsCount;               // Local inputs scheduled, NETPLAY_INPUT_DELAY_TICKS ahead of tick
+    int remoteAckCount;                 // Local inputs received by the remote player
+    unsigned char remoteInputs[NETPLAY_INPUTS_RING];
+    unsigned char remotePlayedInputs[NETPLAY_INPUTS_RING];   // Inputs the remote game ticks were simulated with
+    int remoteInputsCount;              // Remote inputs received, in order
+    int tickLead;                       // Ticks played ahead of the remote player, estimated on the last inputs received
+    int lastSkipTick;                   // Tick of the last step skipped
+    bool inputsSent;                    // Inputs packet sent since the last poll
+    int silentPollsCount;
+    struct NetplayStats stats;
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool InitNetplaySession(struct NetplaySession *session, int playerId, unsigned short localPort, unsigned short remotePort, unsigned int seed);    // Open the session socket and start connecting, seed is played if player 0
+void CloseNetplaySession(struct NetplaySession *session);                         // Close the session socket
+void PollNetplaySession(struct NetplaySession *session);                          // Receive remote packets (rolling back mispredicted ticks), send pending ones
+bool StepNetplaySession(struct NetplaySession *session, const struct InputFrame *input);    // Schedule local input and advance both games one tick, false if waiting for the remote player
+
+// Loopback UDP sockets, also used by the relay tool
+long long OpenLoopbackSocket(unsigned short port);                                 // Open a non-blocking UDP socket bound to 127.0.0.1:port, -1 on failure
+void CloseLoopbackSocket(long long socketHandle);
+bool SendLoopbackPacket(long long socketHandle, unsigned short port, const unsigned char *data, int size);  // Send a datagram to 127.0.0.1:port
+int ReceiveLoopbackPacket(long long socketHandle, unsigned char *buffer, int capacity, unsigned short *port);    // Receive a datagram if any, returns its size (0 if none) and sender port
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // NETPLAY_H
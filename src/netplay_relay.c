@@ -0,0 +1,312 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Netplay relay
+*
+*   Stands in for the network between two versus players on localhost: forwards the datagrams
+*   sent to port A to player 0 and the ones sent to port B to player 1 (players are learned from
+*   the datagrams they send), adding latency, jitter (reordering) and packet loss.
+*
+*       ./raylib_game --versus 0 --remote-port 27962
+*       ./raylib_game --versus 1 --remote-port 27963
+*
+*   Test mode (-t ticks) plays a versus session end-to-end in one process: the relay and two bot
+*   peers exchange real loopback datagrams, peers run uneven frames in virtual time (player 1
+*   joins late and drops frames). Every game must end equal on both peers (each local game and
+*   its remote copy, re-simulated by rollbacks), the rollbacks and bandwidth are reported.
+*
+*   Build and run (headless, raylib library not required):
+*       make netplay_relay && ./netplay_relay [-a port] [-b port] [-l latency_ms] [-j jitter_ms] [-p loss_percent] [-t ticks]
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+#include "netplay.h"
+
+#include <stdio.h>                          // Required for: printf()
+#include <stdlib.h>                         // Required for: atoi()
+#include <string.h>                         // Required for: strcmp(), memcmp(), memcpy(), memmove()
+#include <time.h>                           // Required for: clock()
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI                           // Avoid conflicts with raylib types (Rectangle)
+    #define NOUSER                          // Avoid conflicts with raylib functions (CloseWindow, ShowCursor)
+    #include <windows.h>                    // Required for: Sleep(), GetTickCount64()
+#else
+    #include <unistd.h>                     // Required for: usleep()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define RELAY_QUEUE_SIZE 4096               // Datagrams in flight
+#define RELAY_TEST_FRAME_SECONDS (1.0f/60.0f)
+#define RELAY_TEST_JOIN_FRAMES 30           // Player 1 starts polling later
+#define RELAY_TEST_BENCH_ROLLBACKS 100000
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct RelayPacket {
+    double dueSeconds;
+    int side;                           // 0 to player 0, 1 to player 1
+    int size;
+    unsigned char data[NETPLAY_MAX_PACKET_SIZE];
+};
+
+struct Relay {
+    long long sockets[2];               // Port A socket (player 0 talks to it), port B socket
+    unsigned short playerPorts[2];      // Learned from the datagrams received, 0 if not known yet
+    float latencySeconds;
+    float jitterSeconds;
+    int lossPercent;
+    unsigned int randomState;
+    struct RelayPacket queue[RELAY_QUEUE_SIZE];
+    int queueCount;
+    int forwardedCount;
+    int droppedCount;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static void PumpRelay(struct Relay *relay, double nowSeconds);
+static unsigned int GetRelayRandomBits(unsigned int *state);
+static unsigned int GetBotButtons(unsigned int *state, int tick);
+static bool GamesMatch(const struct GameInstance *a, const struct GameInstance *b);
+static int RunRelayTest(struct Relay *relay, int ticksCount);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    static struct Relay relay = { 0 };
+    unsigned short ports[2] = { NETPLAY_PORT + 2, NETPLAY_PORT + 3 };
+    int ticksCount = 0;
+    relay.randomState = 0x9e3779b9;
+
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "-a") == 0) ports[0] = (unsigned short)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-b") == 0) ports[1] = (unsigned short)atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-l") == 0) relay.latencySeconds = atoi(argv[i + 1])/1000.0f;
+        else if (strcmp(argv[i], "-j") == 0) relay.jitterSeconds = atoi(argv[i + 1])/1000.0f;
+        else if (strcmp(argv[i], "-p") == 0) relay.lossPercent = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "-t") == 0) ticksCount = atoi(argv[i + 1]);
+        else
+        {
+            printf("Usage: %s [-a port] [-b port] [-l latency_ms] [-j jitter_ms] [-p loss_percent] [-t ticks]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    relay.sockets[0] = OpenLoopbackSocket(ports[0]);
+    relay.sockets[1] = OpenLoopbackSocket(ports[1]);
+    if ((relay.sockets[0] == -1) || (relay.sockets[1] == -1))
+    {
+        printf("Failed to open relay ports %i and %i\n", ports[0], ports[1]);
+        return 1;
+    }
+
+    printf("Relay: %i <-> %i, latency %i ms, jitter %i ms, loss %i%%\n", ports[0], ports[1],
+           (int)(relay.latencySeconds*1000.0f), (int)(relay.jitterSeconds*1000.0f), relay.lossPercent);
+
+    int result = 0;
+    if (ticksCount > 0)
+    {
+        if (!LoadConstellations("resources/constellations.sfcp")) printf("Built-in constellations are used\n");
+        result = RunRelayTest(&relay, ticksCount);
+        UnloadConstellations();
+    } else
+    {
+        // NOTE: Runs until the process is stopped
+        for (;;)
+        {
+#if defined(_WIN32)
+            PumpRelay(&relay, GetTickCount64()/1000.0);
+            Sleep(1);
+#else
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            PumpRelay(&relay, now.tv_sec + now.tv_nsec/1e9);
+            usleep(1000);
+#endif
+        }
+    }
+
+    CloseLoopbackSocket(relay.sockets[0]);
+    CloseLoopbackSocket(relay.sockets[1]);
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Queue the datagrams received (or drop them), send the ones whose delay is over
+void PumpRelay(struct Relay *relay, double nowSeconds)
+{
+    for (int side = 0; side < 2; side += 1)
+    {
+        unsigned char data[NETPLAY_MAX_PACKET_SIZE] = { 0 };
+        unsigned short port = 0;
+        int size = 0;
+        while ((size = ReceiveLoopbackPacket(relay->sockets[side], data, NETPLAY_MAX_PACKET_SIZE, &port)) > 0)
+        {
+            relay->playerPorts[side] = port;
+
+            if ((int)(GetRelayRandomBits(&relay->randomState)%100) < relay->lossPercent)
+            {
+                relay->droppedCount += 1;
+                continue;
+            }
+            if (relay->queueCount == RELAY_QUEUE_SIZE) continue;
+
+            const float jitter = relay->jitterSeconds*(float)(GetRelayRandomBits(&relay->randomState)%1024)/1023.0f;
+            struct RelayPacket *packet = &relay->queue[relay->queueCount];
+            packet->dueSeconds = nowSeconds + relay->latencySeconds + jitter;
+            packet->side = 1 - side;
+            packet->size = size;
+            memcpy(packet->data, data, size);
+            relay->queueCount += 1;
+        }
+    }
+
+    // Due datagrams are sent, the others are kept in queue order
+    int keptCount = 0;
+    for (int i = 0; i < relay->queueCount; i += 1)
+    {
+        const struct RelayPacket *packet = &relay->queue[i];
+        const unsigned short port = relay->playerPorts[packet->side];
+        if ((packet->dueSeconds <= nowSeconds) && (port != 0))
+        {
+            if (SendLoopbackPacket(relay->sockets[packet->side], port, packet->data, packet->size)) relay->forwardedCount += 1;
+        } else
+        {
+            if (keptCount != i) relay->queue[keptCount] = *packet;
+            keptCount += 1;
+        }
+    }
+    relay->queueCount = keptCount;
+}
+
+// Get the next bits of a xorshift32 state (never zero)
+unsigned int GetRelayRandomBits(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+// Get the buttons of a bot: a held direction changed every half second, grabs and boosts now and then
+unsigned int GetBotButtons(unsigned int *state, int tick)
+{
+    static const unsigned int directions[9] = {
+        0, INPUT_BUTTON_RIGHT, INPUT_BUTTON_RIGHT | INPUT_BUTTON_DOWN, INPUT_BUTTON_DOWN, INPUT_BUTTON_DOWN | INPUT_BUTTON_LEFT,
+        INPUT_BUTTON_LEFT, INPUT_BUTTON_LEFT | INPUT_BUTTON_UP, INPUT_BUTTON_UP, INPUT_BUTTON_UP | INPUT_BUTTON_RIGHT
+    };
+
+    const unsigned int bits = GetRelayRandomBits(state);
+    unsigned int buttons = directions[((unsigned int)tick/30 + (bits >> 28))%9];
+    if (bits%16 == 0) buttons |= INPUT_BUTTON_GRAB;
+    if ((bits >> 8)%64 == 0) buttons |= INPUT_BUTTON_BOOST;
+
+    return buttons;
+}
+
+// Check two games are in the same state (fields compared, padding is not)
+bool GamesMatch(const struct GameInstance *a, const struct GameInstance *b)
+{
+    return (memcmp(&a->gameState, &b->gameState, sizeof(struct GameState)) == 0) &&
+           (a->player.state == b->player.state) &&
+           (a->player.position.x == b->player.position.x) && (a->player.position.y == b->player.position.y) &&
+           (a->player.isGrabbingStar == b->player.isGrabbingStar) &&
+           (memcmp(a->litBridges, b->litBridges, sizeof(a->litBridges)) == 0) &&
+           (a->randomState == b->randomState);
+}
+
+// Play a versus session between two bots through the relay, in virtual time
+int RunRelayTest(struct Relay *relay, int ticksCount)
+{
+    static struct NetplaySession peers[2] = { 0 };
+    unsigned int botStates[2] = { 0x1234567, 0x89abcdef };
+
+    if (!InitNetplaySession(&peers[0], 0, NETPLAY_PORT, NETPLAY_PORT + 2, 7) ||
+        !InitNetplaySession(&peers[1], 1, NETPLAY_PORT + 1, NETPLAY_PORT + 3, 0))
+    {
+        printf("Failed to open player ports %i and %i\n", NETPLAY_PORT, NETPLAY_PORT + 1);
+        return 1;
+    }
+
+    // Play the ticks, then keep polling until every input is received on both sides
+    const int maxFramesCount = 4*ticksCount + 3600;
+    int frame = 0;
+    for (; frame < maxFramesCount; frame += 1)
+    {
+        PumpRelay(relay, frame*RELAY_TEST_FRAME_SECONDS);
+
+        for (int i = 0; i < 2; i += 1)
+        {
+            if ((i == 1) && (frame < RELAY_TEST_JOIN_FRAMES)) continue;
+
+            // Player 1 drops every 9th frame and catches up on the next one
+            int stepsCount = 1;
+            if (i == 1) stepsCount = (frame%9 == 0)? 0 : ((frame%9 == 1)? 2 : 1);
+
+            PollNetplaySession(&peers[i]);
+            for (int j = 0; (j < stepsCount) && (peers[i].tick < ticksCount); j += 1)
+            {
+                const struct InputFrame input = { GetBotButtons(&botStates[i], peers[i].tick) };
+                if (!StepNetplaySession(&peers[i], &input)) break;
+            }
+        }
+
+        if ((peers[0].tick == ticksCount) && (peers[1].tick == ticksCount) &&
+            (peers[0].remoteInputsCount >= ticksCount) && (peers[1].remoteInputsCount >= ticksCount)) break;
+    }
+
+    const bool isPassed = (peers[0].state == NETPLAY_PLAYING) && (peers[1].state == NETPLAY_PLAYING) &&
+                          (peers[0].tick == ticksCount) && (peers[1].tick == ticksCount) &&
+                          GamesMatch(&peers[0].local, &peers[1].remote) && GamesMatch(&peers[1].local, &peers[0].remote);
+
+    printf("Ticks: %i per player, %i frames\n", ticksCount, frame);
+    for (int i = 0; i < 2; i += 1)
+    {
+        const struct NetplayStats *stats = &peers[i].stats;
+        printf("Player %i: %i rollbacks, %i ticks re-simulated (%i at most), %i steps stalled, %i skipped, %i packets sent, %.1f bytes per tick\n",
+               i, stats->rollbacksCount, stats->resimulatedTicksCount, stats->maxRollbackTicks, stats->stalledStepsCount,
+               stats->skippedStepsCount, stats->packetsSent, (float)stats->bytesSent/ticksCount);
+    }
+    printf("Relay: %i forwarded, %i dropped\n", relay->forwardedCount, relay->droppedCount);
+
+    // Worst rollback cost: the remote game re-simulated NETPLAY_MAX_ROLLBACK_TICKS ticks
+    static struct GameInstance game = { 0 };
+    unsigned int botState = 0x2468ace;
+    clock_t start = clock();
+    for (int i = 0; i < RELAY_TEST_BENCH_ROLLBACKS; i += 1)
+    {
+        game = peers[0].remote;
+        for (int j = 0; j < NETPLAY_MAX_ROLLBACK_TICKS; j += 1)
+        {
+            const struct InputFrame input = { GetBotButtons(&botState, j) };
+            GameStep(&game, &input, GAME_TICK_SECONDS);
+        }
+    }
+    const double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+    printf("Rollback of %i ticks: %.2f us (frame budget %.0f us)\n", NETPLAY_MAX_ROLLBACK_TICKS,
+           1e6*seconds/RELAY_TEST_BENCH_ROLLBACKS, 1e6*GAME_TICK_SECONDS);
+
+    printf("%s\n", isPassed? "PASSED: games match on both players" : "FAILED: games differ");
+
+    CloseNetplaySession(&peers[0]);
+    CloseNetplaySession(&peers[1]);
+
+    return isPassed? 0 : 1;
+}
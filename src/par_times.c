@@ -0,0 +1,126 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Par times tool
+*
+*   Solves the par time of every constellation of a pack on all the CPU cores (see solver.h)
+*   and prints a summary, optionally every par time as CSV. Par times not proven optimal (search
+*   out of budget) are listed, and have 0 in the CSV optimal column.
+*
+*   Build and run (headless, raylib library not required):
+*       make par_times && ./par_times [-p constellations.sfcp] [-t threads] [-o par_times.csv]
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+#include "solver.h"
+
+#include <stdio.h>                          // Required for: printf(), FILE, fopen(), fprintf(), fclose()
+#include <stdlib.h>                         // Required for: malloc(), free(), atoi()
+#include <string.h>                         // Required for: strcmp()
+#include <time.h>                           // Required for: clock()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define PAR_TIMES_MAX_UNPROVEN_LISTED 10    // Par times not proven optimal printed one by one, the rest are counted
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *packFileName = "resources/constellations.sfcp";
+    const char *csvFileName = NULL;
+    int threadsCount = 0;
+    for (int i = 1; i < argc; i += 1)
+    {
+        if ((strcmp(argv[i], "-p") == 0) && (i + 1 < argc)) packFileName = argv[++i];
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) threadsCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) csvFileName = argv[++i];
+        else
+        {
+            printf("Usage: %s [-p constellations.sfcp] [-t threads] [-o par_times.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!LoadConstellations(packFileName))
+    {
+        printf("Failed to load constellations\n");
+        return 1;
+    }
+
+    const struct ConstellationPack *pack = GetConstellationPack();
+    const int count = pack->constellationsCount;
+    struct ParTime *parTimes = (struct ParTime *)malloc(((count > 0)? count : 1)*sizeof(struct ParTime));
+    if (parTimes == NULL)
+    {
+        UnloadConstellations();
+        return 1;
+    }
+
+    // NOTE: CPU time adds up the time of every thread
+    const clock_t start = clock();
+    const bool solved = SolveParTimes(pack, parTimes, threadsCount, SOLVER_DEFAULT_NODES_BUDGET);
+    const double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    int optimalCount = 0;
+    int unsolvedCount = 0;
+    int minTicks = -1;
+    int maxTicks = -1;
+    for (int i = 0; i < count; i += 1)
+    {
+        if (parTimes[i].ticks < 0)
+        {
+            unsolvedCount += 1;
+            continue;
+        }
+
+        if (parTimes[i].isOptimal) optimalCount += 1;
+        if ((minTicks < 0) || (parTimes[i].ticks < minTicks)) minTicks = parTimes[i].ticks;
+        if (parTimes[i].ticks > maxTicks) maxTicks = parTimes[i].ticks;
+    }
+
+    printf("%i constellations solved in %.3fs of CPU time: %i optimal, %i unsolvable, par %.2fs to %.2fs\n",
+           count - unsolvedCount, seconds, optimalCount, unsolvedCount,
+           (minTicks < 0)? 0.0f : minTicks*GAME_TICK_SECONDS, (maxTicks < 0)? 0.0f : maxTicks*GAME_TICK_SECONDS);
+
+    // Search ran out of budget: the par time is the best route found, it may be beaten
+    int unprovenCount = 0;
+    for (int i = 0; i < count; i += 1)
+    {
+        if ((parTimes[i].ticks < 0) || parTimes[i].isOptimal) continue;
+
+        if (unprovenCount < PAR_TIMES_MAX_UNPROVEN_LISTED)
+        {
+            printf("constellation %i: par %.2fs NOT PROVEN optimal (%i bridges)\n", i, parTimes[i].ticks*GAME_TICK_SECONDS, parTimes[i].bridgesCount);
+        }
+        unprovenCount += 1;
+    }
+    if (unprovenCount > PAR_TIMES_MAX_UNPROVEN_LISTED) printf("... %i more par times NOT PROVEN optimal\n", unprovenCount - PAR_TIMES_MAX_UNPROVEN_LISTED);
+
+    bool success = true;
+    if (csvFileName != NULL)
+    {
+        FILE *file = fopen(csvFileName, "w");
+        success = (file != NULL);
+        if (success)
+        {
+            fprintf(file, "constellation,bridges,par_ticks,par_seconds,optimal\n");
+            for (int i = 0; i < count; i += 1)
+            {
+                fprintf(file, "%i,%i,%i,%.4f,%i\n", i, parTimes[i].bridgesCount, parTimes[i].ticks,
+                        (parTimes[i].ticks < 0)? -1.0f : parTimes[i].ticks*GAME_TICK_SECONDS, parTimes[i].isOptimal? 1 : 0);
+            }
+            success = (fclose(file) == 0);
+        }
+        if (!success) printf("Failed to write %s\n", csvFileName);
+    }
+
+    free(parTimes);
+    UnloadConstellations();
+
+    return (solved && success)? 0 : 1;
+}
@@ -0,0 +1,488 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Bot playtesting runner
+*
+*   Plays complete three-stage runs headless (START, GAMEPLAY, CLEAR up to RESULT) with bot
+*   players driving the real simulation through GameStep(), on all the CPU cores, and prints
+*   the stage times, stuns and wrong drops distributions of every constellation.
+*
+*   Bots see the game state only (player, stage constellation, lit bridges) and press buttons
+*   like a player would. They light the nearest unlit bridge first; a bot profile sets how
+*   often they drop on a wrong star, how often they boost and how long they hesitate.
+*
+*   Every run only depends on (seed, run id), so results do not depend on the threads count.
+*   Balance changes are evaluated by building variants, player constants can be overridden:
+*       make playtest PLAYTEST_DEFINES="-DPLAYER_SPEED=80.0f -DPLAYER_STUN_COOLDOWN_SECONDS=0.75f"
+*
+*   Build and run (headless, raylib library not required):
+*       make playtest && ./playtest [-p pack] [-n runs] [-b expert|casual|novice] [-s seed] [-t threads] [-o stats.csv]
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+#include "jobs.h"                           // Required for: RunJobs(), GetCpuCoresCount()
+
+#include <stdio.h>                          // Required for: printf(), FILE, fopen(), fprintf(), fclose()
+#include <stdlib.h>                         // Required for: calloc(), free(), atoi(), strtoul()
+#include <string.h>                         // Required for: strcmp()
+#include <time.h>                           // Required for: clock()
+#include <math.h>                           // Required for: fabsf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define PLAYTEST_MAX_THREADS JOBS_MAX_THREADS
+#define PLAYTEST_MAX_STAGE_TICKS (int)(600.0f/GAME_TICK_SECONDS)    // Stages longer than 10 minutes abort the run
+#define PLAYTEST_HISTOGRAM_BINS 120                                 // Stage times histogram, 1 second bins (last bin is overflow)
+
+// Bots grab once the frog overlaps the star by a small margin (overlap test is strict)
+#define BOT_REACH_X_PIXELS ((PLAYER_REC_WIDTH_PIXELS + STAR_REC_WIDTH_PIXELS)/2.0f - 2.0f)
+#define BOT_REACH_Y_PIXELS ((PLAYER_REC_HEIGHT_PIXELS + STAR_REC_HEIGHT_PIXELS)/2.0f - 2.0f)
+#define BOT_DEAD_ZONE_PIXELS 8.0f           // Axes closer than this are not moved along
+#define BOT_JUMP_PIXELS ((PLAYER_SPEED + PLAYER_BOOST)*PLAYER_JUMP_COOLDOWN_SECONDS)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct BotProfile {
+    const char *name;
+    float mistakeRate;                  // Chance to drop a star on a wrong star
+    float boostRate;                    // Chance to boost jump along a leg
+    int minReactionTicks;               // Ticks waited after every grab or drop
+    int maxReactionTicks;
+};
+
+struct Bot {
+    const struct BotProfile *profile;
+    unsigned int randomState;
+    int bridgeId;                       // Bridge being lit, -1 if none chosen
+    int grabX;                          // Star to grab
+    int grabY;
+    int dropX;                          // Star to drop on (wrong on mistakes)
+    int dropY;
+    bool isBoosting;                    // Current leg is boosted
+    int waitTicks;
+};
+
+// Stages results of one constellation
+// NOTE: Times are counted in ticks so results are exact, whatever the threads count
+struct PlaytestStats {
+    long long stagesCount;
+    long long ticksSum;
+    int minTicks;
+    int maxTicks;
+    long long stunsCount;
+    long long dropsCount;
+    long long wrongDropsCount;
+    long long timeoutsCount;
+    unsigned int histogram[PLAYTEST_HISTOGRAM_BINS];
+};
+
+struct PlaytestJob {
+    const struct BotProfile *profile;
+    unsigned int seed;
+    long long runsCount;
+    int firstRun;                       // Job plays firstRun, firstRun + threadsCount...
+    int threadsCount;
+    int constellationsCount;
+    struct PlaytestStats *stats;        // One per constellation, owned by the job
+    long long ticksCount;
+};
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static const struct BotProfile botProfiles[] = {
+    { "expert", 0.0f, 1.0f, 0, 0 },
+    { "casual", 0.08f, 0.5f, 6, 30 },
+    { "novice", 0.2f, 0.0f, 15, 60 },
+};
+
+static const int botProfilesCount = sizeof(botProfiles)/sizeof(struct BotProfile);
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static int GetBotRandomValue(struct Bot *bot, int min, int max);
+static bool GetBotChance(struct Bot *bot, float rate);
+static void ChooseBotBridge(struct Bot *bot, const struct GameInstance *game, const struct ConstellationView *view);
+static struct InputFrame GetBotInputFrame(struct Bot *bot, const struct GameInstance *game);
+static long long PlayRun(const struct BotProfile *profile, unsigned int seed, struct PlaytestStats *stats, int constellationsCount);
+static void RunPlaytestJob(void *data);
+static float GetHistogramPercentile(const struct PlaytestStats *stats, float percentile);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *packFileName = "resources/constellations.sfcp";
+    const char *csvFileName = NULL;
+    const struct BotProfile *profile = &botProfiles[1];
+    long long runsCount = 10000;
+    unsigned int seed = 0x9e3779b9;
+    int threadsCount = 0;
+    for (int i = 1; i < argc; i += 1)
+    {
+        if ((strcmp(argv[i], "-p") == 0) && (i + 1 < argc)) packFileName = argv[++i];
+        else if ((strcmp(argv[i], "-n") == 0) && (i + 1 < argc)) runsCount = atoll(argv[++i]);
+        else if ((strcmp(argv[i], "-s") == 0) && (i + 1 < argc)) seed = (unsigned int)strtoul(argv[++i], NULL, 0);
+        else if ((strcmp(argv[i], "-t") == 0) && (i + 1 < argc)) threadsCount = atoi(argv[++i]);
+        else if ((strcmp(argv[i], "-o") == 0) && (i + 1 < argc)) csvFileName = argv[++i];
+        else if ((strcmp(argv[i], "-b") == 0) && (i + 1 < argc))
+        {
+            i += 1;
+            profile = NULL;
+            for (int k = 0; k < botProfilesCount; k += 1)
+            {
+                if (strcmp(argv[i], botProfiles[k].name) == 0) profile = &botProfiles[k];
+            }
+            if (profile == NULL)
+            {
+                printf("Unknown bot %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else
+        {
+            printf("Usage: %s [-p constellations.sfcp] [-n runs] [-b expert|casual|novice] [-s seed] [-t threads] [-o stats.csv]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (runsCount < 1)
+    {
+        printf("Invalid runs count\n");
+        return 1;
+    }
+
+    if (!LoadConstellations(packFileName))
+    {
+        printf("Failed to load constellations\n");
+        return 1;
+    }
+
+    const int constellationsCount = GetConstellationsCount();
+    if (threadsCount <= 0) threadsCount = GetCpuCoresCount();
+    if (threadsCount > PLAYTEST_MAX_THREADS) threadsCount = PLAYTEST_MAX_THREADS;
+    if (threadsCount > runsCount) threadsCount = (int)runsCount;
+
+    // NOTE: Every job owns its stats, merged once all the jobs are done
+    struct PlaytestJob jobs[PLAYTEST_MAX_THREADS] = { 0 };
+    bool allocated = true;
+    for (int t = 0; t < threadsCount; t += 1)
+    {
+        jobs[t] = (struct PlaytestJob){ profile, seed, runsCount, t, threadsCount, constellationsCount, NULL, 0 };
+        jobs[t].stats = (struct PlaytestStats *)calloc(constellationsCount, sizeof(struct PlaytestStats));
+        if (jobs[t].stats == NULL) allocated = false;
+    }
+    if (!allocated)
+    {
+        printf("Failed to allocate stats\n");
+        for (int t = 0; t < threadsCount; t += 1) free(jobs[t].stats);
+        UnloadConstellations();
+        return 1;
+    }
+
+    // NOTE: CPU time adds up the time of every thread
+    const clock_t start = clock();
+
+    RunJobs(RunPlaytestJob, jobs, sizeof(struct PlaytestJob), threadsCount);
+
+    const double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    // Merge jobs stats into the first job ones
+    struct PlaytestStats *stats = jobs[0].stats;
+    long long ticksCount = jobs[0].ticksCount;
+    for (int t = 1; t < threadsCount; t += 1)
+    {
+        ticksCount += jobs[t].ticksCount;
+        for (int c = 0; c < constellationsCount; c += 1)
+        {
+            const struct PlaytestStats *other = &jobs[t].stats[c];
+            if (other->stagesCount > 0)
+            {
+                if ((stats[c].stagesCount == 0) || (other->minTicks < stats[c].minTicks)) stats[c].minTicks = other->minTicks;
+                if (other->maxTicks > stats[c].maxTicks) stats[c].maxTicks = other->maxTicks;
+            }
+            stats[c].stagesCount += other->stagesCount;
+            stats[c].ticksSum += other->ticksSum;
+            stats[c].stunsCount += other->stunsCount;
+            stats[c].dropsCount += other->dropsCount;
+            stats[c].wrongDropsCount += other->wrongDropsCount;
+            stats[c].timeoutsCount += other->timeoutsCount;
+            for (int b = 0; b < PLAYTEST_HISTOGRAM_BINS; b += 1) stats[c].histogram[b] += other->histogram[b];
+        }
+    }
+
+    struct PlaytestStats total = { 0 };
+    for (int c = 0; c < constellationsCount; c += 1)
+    {
+        total.stagesCount += stats[c].stagesCount;
+        total.ticksSum += stats[c].ticksSum;
+        total.stunsCount += stats[c].stunsCount;
+        total.dropsCount += stats[c].dropsCount;
+        total.wrongDropsCount += stats[c].wrongDropsCount;
+        total.timeoutsCount += stats[c].timeoutsCount;
+    }
+
+    printf("%lli %s runs (%lli ticks) in %.3fs of CPU time, %.2f million runs per CPU hour\n",
+           runsCount, profile->name, ticksCount, seconds, (seconds > 0.0)? 3600.0*runsCount/seconds/1e6 : 0.0);
+    printf("%lli stages cleared: mean %.2fs, %.3f stuns per stage, %.2f%% wrong drops, %lli timeouts\n",
+           total.stagesCount, (total.stagesCount > 0)? total.ticksSum*GAME_TICK_SECONDS/total.stagesCount : 0.0f,
+           (total.stagesCount > 0)? (double)total.stunsCount/total.stagesCount : 0.0,
+           (total.dropsCount > 0)? 100.0*total.wrongDropsCount/total.dropsCount : 0.0, total.timeoutsCount);
+
+    bool success = true;
+    if (csvFileName != NULL)
+    {
+        FILE *file = fopen(csvFileName, "w");
+        success = (file != NULL);
+        if (success)
+        {
+            fprintf(file, "constellation,stages,mean_seconds,p50_seconds,p90_seconds,min_seconds,max_seconds,stuns_per_stage,wrong_drop_rate,timeouts\n");
+            for (int c = 0; c < constellationsCount; c += 1)
+            {
+                const struct PlaytestStats *s = &stats[c];
+                if ((s->stagesCount == 0) && (s->timeoutsCount == 0)) continue;
+
+                const double stagesCount = (s->stagesCount > 0)? (double)s->stagesCount : 1.0;
+                fprintf(file, "%i,%lli,%.3f,%.1f,%.1f,%.3f,%.3f,%.4f,%.4f,%lli\n", c, s->stagesCount,
+                        s->ticksSum*GAME_TICK_SECONDS/stagesCount,
+                        GetHistogramPercentile(s, 0.5f), GetHistogramPercentile(s, 0.9f),
+                        s->minTicks*GAME_TICK_SECONDS, s->maxTicks*GAME_TICK_SECONDS,
+                        s->stunsCount/stagesCount, (s->dropsCount > 0)? (double)s->wrongDropsCount/s->dropsCount : 0.0,
+                        s->timeoutsCount);
+            }
+            success = (fclose(file) == 0);
+        }
+        if (!success) printf("Failed to write %s\n", csvFileName);
+    }
+
+    for (int t = 0; t < threadsCount; t += 1) free(jobs[t].stats);
+    UnloadConstellations();
+
+    return success? 0 : 1;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Get a random value in [min, max] from the bot xorshift state (never zero)
+int GetBotRandomValue(struct Bot *bot, int min, int max)
+{
+    unsigned int x = bot->randomState;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    bot->randomState = x;
+
+    return min + (int)(x%(unsigned int)(max - min + 1));
+}
+
+bool GetBotChance(struct Bot *bot, float rate)
+{
+    return (GetBotRandomValue(bot, 0, 9999) < (int)(rate*10000.0f));
+}
+
+// Choose the unlit bridge with the star nearest to the frog, and the star to drop it on
+void ChooseBotBridge(struct Bot *bot, const struct GameInstance *game, const struct ConstellationView *view)
+{
+    const Vector2 position = game->player.position;
+    float bestDistance = 0.0f;
+    bot->bridgeId = -1;
+
+    for (int i = 0; i < view->bridgesCount; i += 1)
+    {
+        if (GetGameBridgeState(game, view, i) != BRIDGE_OFF_DEFAULT) continue;
+
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(view, i);
+        for (int k = 0; k < 2; k += 1)
+        {
+            const Vector2 star = (k == 0)? GetStarPosition(bridge.x1, bridge.y1) : GetStarPosition(bridge.x2, bridge.y2);
+            const float dx = fabsf(star.x - position.x);
+            const float dy = fabsf(star.y - position.y);
+            const float distance = (dx > dy)? dx : dy;
+            if ((bot->bridgeId != -1) && (distance >= bestDistance)) continue;
+
+            bestDistance = distance;
+            bot->bridgeId = i;
+            bot->grabX = (k == 0)? bridge.x1 : bridge.x2;
+            bot->grabY = (k == 0)? bridge.y1 : bridge.y2;
+            bot->dropX = (k == 0)? bridge.x2 : bridge.x1;
+            bot->dropY = (k == 0)? bridge.y2 : bridge.y1;
+        }
+    }
+
+    // Mistakes drop on a star of a random bridge, wrong unless it happens to make another unlit bridge
+    if ((bot->bridgeId != -1) && GetBotChance(bot, bot->profile->mistakeRate))
+    {
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(view, GetBotRandomValue(bot, 0, view->bridgesCount - 1));
+        const bool first = (GetBotRandomValue(bot, 0, 1) == 0);
+        const int x = first? bridge.x1 : bridge.x2;
+        const int y = first? bridge.y1 : bridge.y2;
+        if ((x != bot->grabX) || (y != bot->grabY))
+        {
+            bot->dropX = x;
+            bot->dropY = y;
+        }
+    }
+
+    bot->isBoosting = GetBotChance(bot, bot->profile->boostRate);
+}
+
+struct InputFrame GetBotInputFrame(struct Bot *bot, const struct GameInstance *game)
+{
+    struct InputFrame input = { 0 };
+    const struct Player *player = &game->player;
+
+    // Stars are only placed during gameplay, a stun makes the frog let the star go
+    if ((game->gameState.state != GAMESTATE_GAMEPLAY) || (player->state == PLAYER_STUNNED))
+    {
+        bot->bridgeId = -1;
+        return input;
+    }
+
+    if (bot->waitTicks > 0)
+    {
+        bot->waitTicks -= 1;
+        return input;
+    }
+
+    if (!player->isGrabbingStar)
+    {
+        struct ConstellationView view = { 0 };
+        if (!GetGameConstellation(game, &view)) return input;
+
+        if ((bot->bridgeId == -1) || (GetGameBridgeState(game, &view, bot->bridgeId) != BRIDGE_OFF_DEFAULT)) ChooseBotBridge(bot, game, &view);
+        if (bot->bridgeId == -1) return input;
+    }
+
+    const Vector2 target = player->isGrabbingStar? GetStarPosition(bot->dropX, bot->dropY) : GetStarPosition(bot->grabX, bot->grabY);
+    const float dx = target.x - player->position.x;
+    const float dy = target.y - player->position.y;
+
+    if ((fabsf(dx) < BOT_REACH_X_PIXELS) && (fabsf(dy) < BOT_REACH_Y_PIXELS))
+    {
+        input.buttons |= INPUT_BUTTON_GRAB;
+        if (player->isGrabbingStar) bot->bridgeId = -1;
+        bot->waitTicks = GetBotRandomValue(bot, bot->profile->minReactionTicks, bot->profile->maxReactionTicks);
+        return input;
+    }
+
+    if (dx <= -BOT_DEAD_ZONE_PIXELS) input.buttons |= INPUT_BUTTON_LEFT;
+    else if (dx >= BOT_DEAD_ZONE_PIXELS) input.buttons |= INPUT_BUTTON_RIGHT;
+    if (dy <= -BOT_DEAD_ZONE_PIXELS) input.buttons |= INPUT_BUTTON_UP;
+    else if (dy >= BOT_DEAD_ZONE_PIXELS) input.buttons |= INPUT_BUTTON_DOWN;
+
+    // Jumps lock the direction, only boost if no moving axis overshoots the star
+    const bool jumpFitsX = !(input.buttons & (INPUT_BUTTON_LEFT | INPUT_BUTTON_RIGHT)) || (fabsf(dx) >= BOT_JUMP_PIXELS);
+    const bool jumpFitsY = !(input.buttons & (INPUT_BUTTON_UP | INPUT_BUTTON_DOWN)) || (fabsf(dy) >= BOT_JUMP_PIXELS);
+    if (bot->isBoosting && (player->state == PLAYER_IDLE) && jumpFitsX && jumpFitsY) input.buttons |= INPUT_BUTTON_BOOST;
+
+    return input;
+}
+
+// Play one run up to the results screen, returns the ticks simulated
+long long PlayRun(const struct BotProfile *profile, unsigned int seed, struct PlaytestStats *stats, int constellationsCount)
+{
+    struct GameInstance game = { 0 };
+    InitGameInstance(&game, seed);
+
+    struct Bot bot = { 0 };
+    bot.profile = profile;
+    bot.randomState = (seed*0x85ebca6bu) | 1u;
+    bot.bridgeId = -1;
+
+    long long ticksCount = 0;
+    int stageTicks = 0;
+    int stuns = 0;
+    int drops = 0;
+    int wrongDrops = 0;
+    while (game.gameState.state != GAMESTATE_RESULT)
+    {
+        const struct InputFrame input = GetBotInputFrame(&bot, &game);
+        const enum GameStateState state = game.gameState.state;
+        const int constellationId = game.gameState.stages[game.gameState.stageId].constellationId;
+        const bool wasGrabbing = game.player.isGrabbingStar;
+        const bool wasStunned = (game.player.state == PLAYER_STUNNED);
+
+        GameStep(&game, &input, GAME_TICK_SECONDS);
+        ticksCount += 1;
+
+        if (state != GAMESTATE_GAMEPLAY) continue;
+
+        stageTicks += 1;
+        if (wasGrabbing && !game.player.isGrabbingStar)
+        {
+            drops += 1;
+            if (game.player.state == PLAYER_STUNNED) wrongDrops += 1;
+        }
+        if (!wasStunned && (game.player.state == PLAYER_STUNNED)) stuns += 1;
+
+        if ((constellationId < 0) || (constellationId >= constellationsCount)) break;
+        struct PlaytestStats *s = &stats[constellationId];
+
+        if (stageTicks > PLAYTEST_MAX_STAGE_TICKS)
+        {
+            s->timeoutsCount += 1;
+            break;
+        }
+
+        if (game.gameState.state != GAMESTATE_GAMEPLAY)
+        {
+            if ((s->stagesCount == 0) || (stageTicks < s->minTicks)) s->minTicks = stageTicks;
+            if (stageTicks > s->maxTicks) s->maxTicks = stageTicks;
+            s->stagesCount += 1;
+            s->ticksSum += stageTicks;
+            s->stunsCount += stuns;
+            s->dropsCount += drops;
+            s->wrongDropsCount += wrongDrops;
+
+            int bin = (int)(stageTicks*GAME_TICK_SECONDS);
+            if (bin >= PLAYTEST_HISTOGRAM_BINS) bin = PLAYTEST_HISTOGRAM_BINS - 1;
+            s->histogram[bin] += 1;
+
+            stageTicks = 0;
+            stuns = 0;
+            drops = 0;
+            wrongDrops = 0;
+        }
+    }
+
+    return ticksCount;
+}
+
+void RunPlaytestJob(void *data)
+{
+    struct PlaytestJob *job = (struct PlaytestJob *)data;
+
+    for (long long run = job->firstRun; run < job->runsCount; run += job->threadsCount)
+    {
+        // NOTE: Run seed only depends on (seed, run id), mixed so neighbour runs are not correlated
+        unsigned int seed = job->seed ^ ((unsigned int)run*0x9e3779b9u);
+        seed ^= seed >> 16;
+        seed *= 0x85ebca6bu;
+        seed ^= seed >> 13;
+        seed *= 0xc2b2ae35u;
+        seed ^= seed >> 16;
+
+        job->ticksCount += PlayRun(job->profile, seed, job->stats, job->constellationsCount);
+    }
+}
+
+
+// Get a stage time percentile (seconds) from the histogram, upper edge of its bin
+float GetHistogramPercentile(const struct PlaytestStats *stats, float percentile)
+{
+    const long long rank = (long long)(percentile*stats->stagesCount);
+    long long count = 0;
+    for (int b = 0; b < PLAYTEST_HISTOGRAM_BINS; b += 1)
+    {
+        count += stats->histogram[b];
+        if (count > rank) return (float)(b + 1);
+    }
+    return (float)PLAYTEST_HISTOGRAM_BINS;
+}
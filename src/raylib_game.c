@@ -15,14 +15,31 @@
 #include "rlgl.h"
 #include "raymath.h"
 
+#include "game.h"                           // Game simulation: GameInstance, GameStep()
+#include "recording.h"                      // Input recording: InputRecording, RecordInputFrame()
+#include "snapshot.h"                       // Game snapshots: SnapshotRing, RewindGameSnapshot()
+#include "netplay.h"                        // Versus netplay: NetplaySession, StepNetplaySession()
+#include "telemetry.h"                      // Telemetry: RecordTelemetryGameEvents(), RecordTelemetryFrame()
+#include "render.h"                         // Rendering constants: sprites, minimap, palette
+#include "solver.h"                         // Par time solver: SolveParTime()
+#include "jobs.h"                           // Thread jobs: StartBackgroundJob(), IsBackgroundJobDone()
+#include "swarm.h"                          // Frog swarm: FrogSwarm, UpdateFrogSwarm()
+#include "minimap.h"                        // Minimap pyramid: MinimapPyramid, SetMinimapPyramidBridgeLit()
+
+#if defined(SUPPORT_BAKED_ASSETS)
+    #include "baked_assets.h"               // Baked assets: spritesheet pixels, font atlases (generated by asset_baker)
+#endif
+
 #if defined(PLATFORM_WEB)
     #define CUSTOM_MODAL_DIALOGS            // Force custom modal dialogs usage
     #include <emscripten/emscripten.h>      // Emscripten library - LLVM to JavaScript compiler
 #endif
 
 #include <stdio.h>                          // Required for: printf()
-#include <stdlib.h>                         // Required for: 
-#include <string.h>                         // Required for: 
+#include <stdlib.h>                         // Required for: atoi(), malloc(), free(), qsort()
+#include <string.h>                         // Required for: strcmp(), memcmp()
+#include <signal.h>                         // Required for: signal(), raise()
+#include <time.h>                           // Required for: time()
 
 //----------------------------------------------------------------------------------
 // Defines and Macros
@@ -36,41 +53,22 @@
     #define LOG(...)
 #endif
 
-#define SCREEN_WIDTH_PIXELS 256
-#define SCREEN_HEIGHT_PIXELS 256
-
-#define MINIMAP_WIDTH_PIXELS 60
-#define MINIMAP_HEIGHT_PIXELS 80
-#define MINIMAP_BORDER_PIXELS 2
-#define MINIMAP_STAR_SPACING_PIXELS 5
-
-#define SPRITESHEET_FROG_OFFSET_X_PIXELS 0
-#define SPRITESHEET_FROG_OFFSET_Y_PIXELS 0
-#define SPRITESHEET_STAR_OFFSET_X_PIXELS 384
-#define SPRITESHEET_STAR_OFFSET_Y_PIXELS 0
-
-#define STAR_COUNT_X 11
-#define STAR_COUNT_Y 15
-#define STAR_SPACING_PIXELS 64
-#define STAR_SPRITE_WIDTH_PIXELS 32
-#define STAR_SPRITE_HEIGHT_PIXELS 32
-#define STAR_REC_WIDTH_PIXELS 16
-#define STAR_REC_HEIGHT_PIXELS 16
-
-#define PLAYER_SPRITE_WIDTH_PIXELS 64
-#define PLAYER_SPRITE_HEIGHT_PIXELS 64
-#define PLAYER_REC_WIDTH_PIXELS 20
-#define PLAYER_REC_HEIGHT_PIXELS 25
-#define PLAYER_SPEED 72.0f
-#define PLAYER_BOOST 24.0f
-#define PLAYER_STUN_COOLDOWN_SECONDS 1.0f
-#define PLAYER_JUMP_COOLDOWN_SECONDS 0.5f
-#define PLAYER_FLAPPING_DURATION_SECONDS 0.7f
-
-#define CONSTELLATION_MAX_BRIDGES_COUNT 20
-#define CONSTELLATION_BRIDGE_LINE_THICKNESS 3.5f
-
-#define GAMESTATE_STAGES_COUNT 3
+#define STAGE_PANEL_HEIGHT_PIXELS 20        // Stage panel layer, at the bottom of the screen
+#define RESULT_LINES_POS_Y_PIXELS 40
+#define RESULT_LINES_HEIGHT_PIXELS (30*GAMESTATE_STAGES_COUNT + 10)
+
+#define STAR_FIELD_TILE_STARS (SCREEN_WIDTH_PIXELS/STAR_SPACING_PIXELS + 2)     // Stars per side of the star field layer, it covers the view at zoom 1
+#define VIEW_CULL_MARGIN_PIXELS 16          // Margin around the camera view kept on culling, covers star sprites and bridge lines crossing its border
+#define HOVER_DISTANCE_STARS 0.5f           // Bridges closer to the frog are highlighted on debug mode
+#define MINIMAP_TILE_MIN_PIXELS 2.0f        // Minimap pyramid tiles drawn are this wide at least
+#define PAR_TICKS_SOLVING -2                // Stage par time still being solved
+
+#define REWIND_TICKS_PER_FRAME 2            // Rewind plays back at twice the game speed
+#define VERSUS_OPPONENT_ALPHA 0.5f          // Opponent frog is drawn see-through
+
+#define PROFILER_FRAMES_COUNT 120           // Frames kept by the profiler overlay (frame-time graph width in pixels)
+#define PROFILER_GRAPH_HEIGHT_PIXELS 40
+#define PROFILER_GRAPH_MAX_SECONDS (2.0f*GAME_TICK_SECONDS)     // Frame time at the top of the graph
 
 //----------------------------------------------------------------------------------
 // Types and Structures Definition
@@ -84,80 +82,67 @@ typedef enum {
 
 // TODO: Define your custom data types here
 
-enum PlayerSpriteFrames {
-    PLAYER_SPRITE_IDLE_WITHOUT_STAR = 0,
-    PLAYER_SPRITE_IDLE_WITH_STAR,
-    PLAYER_SPRITE_JUMPING_WITHOUT_STAR,
-    PLAYER_SPRITE_JUMPING_WITH_STAR,
-    PLAYER_SPRITE_STUNNED,
-    PLAYER_SPRITE_FRAMES,
-};
-
-enum PlayerState {
-    PLAYER_IDLE,
-    PLAYER_STUNNED,
-    PLAYER_JUMPING,
-};
-
-struct Player {
-    enum PlayerState state;
-    Vector2 position;
-    Vector2 direction;
-    float speed;
-    float movementDurationSeconds;
-    bool isGrabbingStar;
-    int grabbedStarX;
-    int grabbedStarY;
-    float flappingDurationSeconds;
-    bool flappingUp;
-    bool isFacingRight;
-};
-
-enum StarSpriteFrames {
-    STAR_SPRITE_OFF = 0,
-    STAR_SPRITE_ON,
-    STAR_SPRITE_FRAMES
-};
-
-enum BridgeState {
-    BRIDGE_OFF_DEFAULT,
-    BRIDGE_ON_DEFAULT,
-    BRIDGE_ON,
-    BRIDGE_DISABLED,
+// Phases of UpdateDrawFrame(), timed in benchmark mode and by the profiler overlay
+enum BenchPhase {
+    BENCH_PHASE_UPDATE = 0,
+    BENCH_PHASE_MAIN_RENDER,
+    BENCH_PHASE_MINIMAP,
+    BENCH_PHASE_COMPOSITE,
+    BENCH_PHASE_PRESENT,                // EndDrawing(): buffers swap, frame rate wait and input polling
+    BENCH_PHASES_COUNT
 };
 
-struct ConstellationBridge {
-    int x1;
-    int y1;
-    int x2;
-    int y2;
-    enum BridgeState state;
+// Draw work submitted to rlgl in a frame, counted from the render batch before every flush
+struct RenderStats {
+    int drawCalls;
+    int batches;                        // Non empty batches flushed
+    int vertices;
+    int textureBinds;                   // Draw calls binding a different texture than the previous one
+    int sprites;                        // DrawSprite() calls
 };
 
-struct Constellation {
-    int count;
-    int startingScore;
-    struct ConstellationBridge bridges[CONSTELLATION_MAX_BRIDGES_COUNT];
+// Text shown by the stage panel, the panel layer is redrawn when it changes
+struct StagePanelKey {
+    int stageId;
+    int seconds;
+    int score;
+    int requiredScore;                  // -1 if the stage constellation is not chosen yet
 };
 
-enum GameStateState {
-    GAMESTATE_START,
-    GAMESTATE_GAMEPLAY,
-    GAMESTATE_CLEAR,
-    GAMESTATE_RESULT,
+// Lines shown by the results screen, the results layer is redrawn when they change
+struct ResultLinesKey {
+    int linesCount;
+    int seconds[GAMESTATE_STAGES_COUNT];
+    int parTicks[GAMESTATE_STAGES_COUNT];       // -1 if not solvable, PAR_TICKS_SOLVING while solved
+    int isParOptimal[GAMESTATE_STAGES_COUNT];
 };
 
-struct GameStateStage {
+// Par time of a stage constellation, solved on a background job
+struct StageParJob {
+    struct ConstellationView view;
     int constellationId;
-    int score;
-    float timerSeconds;
+    Vector2 startPosition;              // Frog position when the job started, the route starts there
+    struct ParTime parTime;
 };
 
-struct GameState {
-    enum GameStateState state;
-    float clockSeconds;
+// Everything the main render shows, its pass is skipped while this does not change (idle mode)
+// NOTE: Compared with memcmp(), only ints and floats so there is no padding
+struct MainRenderKey {
+    int state;
     int stageId;
-    struct GameStateStage stages[GAMESTATE_STAGES_COUNT];
+    int constellationId;
+    int bridgesVersion;
+    int textPhase;                      // Countdown digit, START/CLEAR/PRESS (R) text shown or not
+    int playerState;
+    int playerGrabbedStarX;             // -1 if not grabbing a star
+    int playerGrabbedStarY;
+    int playerFlappingUp;
+    int playerFacingRight;
+    Vector2 playerPosition;             // Interpolated positions, as drawn
+    Camera2D camera;
+    int debugMode;
+    struct StagePanelKey stagePanel;
+    struct ResultLinesKey resultLines;
 };
 
 //----------------------------------------------------------------------------------
@@ -171,353 +156,305 @@ static RenderTexture2D mainRender = { 0 };  // Initialized at init
 
 static RenderTexture2D minimapRender = { 0 };  // Initialized at init
 
+// Minimap is retained: redrawn only when the constellation shown or its bridges change
+static bool minimapValid = false;
+static int minimapConstellationId = -1;
+static unsigned int minimapBridgesVersion = 0;
+static bool minimapDebugMode = false;
+static int minimapRedrawCount = 0;
+static int minimapSkippedCount = 0;
+
+// Minimap layout: the pack star field if it fits MINIMAP_STAR_SPACING_PIXELS, the constellation bounding box otherwise.
+// Bridges are drawn as lines at full spacing, scaled down constellations are drawn from the minimap pyramid tiles
+static struct MinimapPyramid minimapPyramid = { 0 };
+static int minimapPyramidConstellationId = -1;
+static unsigned int minimapPyramidLitBridges[GAME_LIT_BRIDGES_WORDS] = { 0 };  // Lit bridges already counted in the pyramid
+static Rectangle minimapStars = { 0 };          // Stars shown, first star and stars per side
+static float minimapSpacing = MINIMAP_STAR_SPACING_PIXELS;
+static Vector2 minimapOffset = { 0 };           // Centers the stars shown in the minimap
+static bool minimapTilesShown = false;
+
+// Star field layer: a tile of OFF stars prerendered once, rebuilt only when the debug overlay changes
+// NOTE: Stars are a regular lattice, the stars in view are drawn as a sub-rectangle of the tile whatever the field size
+static RenderTexture2D starFieldRender = { 0 };    // Initialized on first use
+static bool starFieldDebugMode = false;
+
+// Par time of every stage shown on results screen, solved off the frame once its constellation is chosen
+// NOTE: A stage job is not restarted while running, a constellation chosen meanwhile is solved once it is done
+static struct StageParJob stageParJobs[GAMESTATE_STAGES_COUNT] = { 0 };
+static struct BackgroundJob stageParBackgroundJobs[GAMESTATE_STAGES_COUNT] = { 0 };
+static bool isStageParSolving[GAMESTATE_STAGES_COUNT] = { 0 };
+static int stageParConstellationIds[GAMESTATE_STAGES_COUNT] = { -1, -1, -1 };   // Constellation of the par time solved
+static struct ParTime stageParTimes[GAMESTATE_STAGES_COUNT] = { 0 };
+
+// Stage panel (HUD) and results lines layers, redrawn only when their text changes
+static RenderTexture2D stagePanelRender = { 0 };   // Initialized at init
+static struct StagePanelKey stagePanelKey = { 0 };
+static bool stagePanelValid = false;
+static RenderTexture2D resultLinesRender = { 0 };  // Initialized at init
+static struct ResultLinesKey resultLinesKey = { 0 };
+static bool resultLinesValid = false;
+
+// Lit bridges geometry of the stage constellation: bridge quads and de-duplicated lit stars
+// NOTE: Simulation only lights bridges, newly lit ones are appended, it is rebuilt on constellation change or reset.
+// Only the bridges in the camera view (bridge grid query) and the lit stars they own are submitted
+static bool bridgeGeometryValid = false;
+static int bridgeGeometryConstellationId = -1;
+static unsigned int bridgeGeometryVersion = 0;
+static unsigned int bridgeGeometryLitBridges[GAME_LIT_BRIDGES_WORDS] = { 0 };  // Lit bridges already in the geometry
+static unsigned int bridgeGeometryBridges[GAME_LIT_BRIDGES_WORDS] = { 0 };     // Bridges in the geometry, lit or ON by default
+static Vector2 bridgeLines[2*GAME_MAX_BRIDGES_COUNT] = { 0 };   // Star positions of every lit bridge
+static Vector2 bridgeQuads[4*GAME_MAX_BRIDGES_COUNT] = { 0 };   // Line corners of every lit bridge, in quad order
+static int bridgeGeometryStarIds[2*GAME_MAX_BRIDGES_COUNT] = { 0 };  // Lit stars every lit bridge lit first, -1 if none
+static int bridgeGeometryIds[GAME_MAX_BRIDGES_COUNT] = { 0 };        // Geometry of every constellation bridge, -1 if not lit
+static int bridgeGeometryCount = 0;
+static Vector2 litStarPositions[2*GAME_MAX_BRIDGES_COUNT] = { 0 };
+static int litStarsCount = 0;
+static int visibleBridgeIds[GAME_MAX_BRIDGES_COUNT] = { 0 };    // Lit bridges in the camera view, filled on draw
+static int visibleLitStarIds[2*GAME_MAX_BRIDGES_COUNT] = { 0 };
+
+// Bridge grid of the stage constellation, rebuilt on constellation change (lit or not, in star units)
+static struct BridgeGrid bridgeGrid = { 0 };
+static int bridgeGridConstellationId = -1;
+static int bridgeGridIds[GAME_MAX_BRIDGES_COUNT] = { 0 };       // Query results, filled on draw
+
+// Idle mode: main render is redrawn only when its key changes, the previous frame is presented again otherwise
+static bool idleModeEnabled = true;            // Disabled on benchmark, every frame is drawn
+static bool mainRenderValid = false;
+static struct MainRenderKey mainRenderKey = { 0 };
+static int mainRenderRedrawCount = 0;
+static int mainRenderSkippedCount = 0;
+
 // TODO: Define global variables here, recommended to make them static
 
-// https://lospec.com/palette-list/oil-6
 static Color palette[6] = {
-    (Color){ 0xfb, 0xf5, 0xef, 0xff },
-    (Color){ 0xf2, 0xd3, 0xab, 0xff },
-    (Color){ 0xc6, 0x9f, 0xa5, 0xff },
-    (Color){ 0x8b, 0x6d, 0x9c, 0xff },
-    (Color){ 0x49, 0x4d, 0x7e, 0xff },
-    (Color){ 0x27, 0x27, 0x44, 0xff },
+    PALETTE_COLOR_0,
+    PALETTE_COLOR_1,
+    PALETTE_COLOR_2,
+    PALETTE_COLOR_3,
+    PALETTE_COLOR_4,
+    PALETTE_COLOR_5,
 };
 
 static bool debugMode = false;
 
-static struct Player player = { 0 };
+static Texture2D spritesheet = { 0 };
 
-static Camera2D camera = { 0 };
+static Font fonts[FONT_SIZES_COUNT] = { 0 };   // One font per size drawn, see GetFont()
+static const int fontSizes[FONT_SIZES_COUNT] = FONT_SIZES;
 
-static Texture2D spritesheet = { 0 };
+static struct GameInstance game = { 0 };
 
-static Font font = { 0 };
+static float tickAccumulatorSeconds = 0.0f;     // Frame time not yet consumed by fixed simulation ticks
+static unsigned int pendingPressedButtons = 0;  // Pressed buttons waiting for the next simulation tick
 
-// Constellations
-static struct Constellation constellations[] =
-    {
-        {
-            17,
-            2,
-            {
-                { 9, 0, 8, 3, BRIDGE_ON_DEFAULT },
-                { 8, 3, 10, 4, BRIDGE_ON_DEFAULT },
-                { 10, 4, 9, 9, BRIDGE_OFF_DEFAULT },
-                { 9, 9, 7, 10, BRIDGE_OFF_DEFAULT },
-                { 7, 10, 3, 10, BRIDGE_OFF_DEFAULT },
-                { 3, 10, 1, 10, BRIDGE_OFF_DEFAULT },
-                { 1, 10, 0, 13, BRIDGE_OFF_DEFAULT },
-                { 3, 10, 4, 14, BRIDGE_OFF_DEFAULT },
-                { 4, 14, 0, 13, BRIDGE_OFF_DEFAULT },
-                { 1, 10, 2, 8, BRIDGE_OFF_DEFAULT },
-                { 2, 8, 4, 6, BRIDGE_OFF_DEFAULT },
-                { 4, 6, 6, 4, BRIDGE_OFF_DEFAULT },
-                { 6, 4, 6, 2, BRIDGE_OFF_DEFAULT },
-                { 6, 2, 8, 3, BRIDGE_OFF_DEFAULT },
-                { 1, 4, 4, 6, BRIDGE_OFF_DEFAULT },
-                { 0, 0, 1, 4, BRIDGE_OFF_DEFAULT },
-                { 1, 4, 6, 2, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            15,
-            2,
-            {
-                { 0, 3, 3, 0, BRIDGE_ON_DEFAULT },
-                { 0, 3, 4, 6, BRIDGE_OFF_DEFAULT },
-                { 4, 6, 6, 7, BRIDGE_OFF_DEFAULT },
-                { 6, 7, 8, 4, BRIDGE_OFF_DEFAULT },
-                { 8, 4, 10, 3, BRIDGE_OFF_DEFAULT },
-                { 10, 3, 10, 1, BRIDGE_OFF_DEFAULT },
-                { 1, 8, 4, 6, BRIDGE_OFF_DEFAULT },
-                { 1, 8, 1, 10, BRIDGE_OFF_DEFAULT },
-                { 6, 7, 8, 10, BRIDGE_OFF_DEFAULT },
-                { 8, 10, 5, 11, BRIDGE_OFF_DEFAULT },
-                { 5, 11, 6, 14, BRIDGE_OFF_DEFAULT },
-                { 8, 10, 6, 14, BRIDGE_OFF_DEFAULT },
-                { 10, 13, 8, 10, BRIDGE_OFF_DEFAULT },
-                { 1, 14, 3, 14, BRIDGE_ON_DEFAULT },
-                { 3, 14, 6, 14, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            3,
-            {
-                { 9, 13, 9, 11, BRIDGE_OFF_DEFAULT },
-                { 9, 11, 7, 11, BRIDGE_OFF_DEFAULT },
-                { 9, 13, 5, 14, BRIDGE_OFF_DEFAULT },
-                { 4, 12, 7, 11, BRIDGE_ON_DEFAULT },
-                { 4, 12, 5, 14, BRIDGE_OFF_DEFAULT },
-                { 7, 11, 7, 8, BRIDGE_OFF_DEFAULT },
-                { 4, 12, 3, 9, BRIDGE_OFF_DEFAULT },
-                { 0, 11, 3, 9, BRIDGE_OFF_DEFAULT },
-                { 6, 6, 7, 8, BRIDGE_OFF_DEFAULT },
-                { 6, 6, 7, 4, BRIDGE_OFF_DEFAULT },
-                { 7, 4, 9, 3, BRIDGE_OFF_DEFAULT },
-                { 4, 5, 6, 6, BRIDGE_OFF_DEFAULT },
-                { 2, 4, 4, 5, BRIDGE_OFF_DEFAULT },
-                { 4, 2, 7, 4, BRIDGE_OFF_DEFAULT },
-                { 1, 2, 2, 4, BRIDGE_ON_DEFAULT },
-                { 2, 4, 4, 2, BRIDGE_ON_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            2,
-            {
-                { 5, 14, 7, 12, BRIDGE_ON_DEFAULT },
-                { 7, 12, 10, 13, BRIDGE_OFF_DEFAULT },
-                { 10, 13, 10, 10, BRIDGE_OFF_DEFAULT },
-                { 8, 6, 10, 10, BRIDGE_OFF_DEFAULT },
-                { 8, 6, 10, 5, BRIDGE_OFF_DEFAULT },
-                { 7, 1, 10, 5, BRIDGE_ON_DEFAULT },
-                { 7, 1, 9, 1, BRIDGE_OFF_DEFAULT },
-                { 6, 3, 7, 1, BRIDGE_OFF_DEFAULT },
-                { 5, 7, 8, 6, BRIDGE_OFF_DEFAULT },
-                { 5, 7, 3, 6, BRIDGE_OFF_DEFAULT },
-                { 3, 6, 3, 3, BRIDGE_OFF_DEFAULT },
-                { 3, 3, 6, 3, BRIDGE_OFF_DEFAULT },
-                { 5, 7, 7, 12, BRIDGE_OFF_DEFAULT },
-                { 1, 11, 5, 14, BRIDGE_OFF_DEFAULT },
-                { 0, 4, 1, 1, BRIDGE_OFF_DEFAULT },
-                { 1, 1, 3, 3, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            3,
-            {
-                { 10, 14, 10, 12, BRIDGE_OFF_DEFAULT },
-                { 7, 12, 10, 14, BRIDGE_ON_DEFAULT },
-                { 7, 12, 7, 10, BRIDGE_OFF_DEFAULT },
-                { 10, 12, 9, 10, BRIDGE_OFF_DEFAULT },
-                { 9, 10, 7, 10, BRIDGE_OFF_DEFAULT },
-                { 7, 10, 8, 8, BRIDGE_OFF_DEFAULT },
-                { 8, 8, 9, 6, BRIDGE_OFF_DEFAULT },
-                { 7, 1, 9, 6, BRIDGE_OFF_DEFAULT },
-                { 7, 1, 9, 0, BRIDGE_ON_DEFAULT },
-                { 1, 11, 0, 9, BRIDGE_ON_DEFAULT },
-                { 7, 1, 3, 0, BRIDGE_OFF_DEFAULT },
-                { 3, 0, 1, 1, BRIDGE_OFF_DEFAULT },
-                { 3, 6, 3, 4, BRIDGE_OFF_DEFAULT },
-                { 3, 4, 1, 1, BRIDGE_OFF_DEFAULT },
-                { 3, 6, 0, 9, BRIDGE_OFF_DEFAULT },
-                { 3, 6, 8, 8, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            2,
-            {
-                { 7, 1, 10, 1, BRIDGE_ON_DEFAULT },
-                { 10, 1, 10, 4, BRIDGE_OFF_DEFAULT },
-                { 9, 7, 10, 4, BRIDGE_OFF_DEFAULT },
-                { 7, 10, 9, 7, BRIDGE_OFF_DEFAULT },
-                { 6, 12, 7, 10, BRIDGE_OFF_DEFAULT },
-                { 6, 12, 10, 14, BRIDGE_OFF_DEFAULT },
-                { 2, 12, 6, 12, BRIDGE_OFF_DEFAULT },
-                { 0, 11, 2, 12, BRIDGE_OFF_DEFAULT },
-                { 7, 10, 5, 9, BRIDGE_OFF_DEFAULT },
-                { 0, 11, 5, 9, BRIDGE_ON_DEFAULT },
-                { 5, 9, 3, 7, BRIDGE_OFF_DEFAULT },
-                { 3, 7, 3, 5, BRIDGE_OFF_DEFAULT },
-                { 3, 5, 2, 3, BRIDGE_OFF_DEFAULT },
-                { 2, 3, 2, 1, BRIDGE_OFF_DEFAULT },
-                { 7, 1, 7, 3, BRIDGE_OFF_DEFAULT },
-                { 7, 3, 2, 1, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            2,
-            {
-                { 0, 13, 2, 11, BRIDGE_OFF_DEFAULT },
-                { 2, 11, 2, 9, BRIDGE_OFF_DEFAULT },
-                { 2, 11, 5, 12, BRIDGE_ON_DEFAULT },
-                { 5, 12, 7, 13, BRIDGE_OFF_DEFAULT },
-                { 7, 13, 10, 12, BRIDGE_OFF_DEFAULT },
-                { 5, 12, 6, 9, BRIDGE_OFF_DEFAULT },
-                { 6, 9, 10, 12, BRIDGE_OFF_DEFAULT },
-                { 6, 9, 8, 7, BRIDGE_OFF_DEFAULT },
-                { 8, 7, 9, 5, BRIDGE_OFF_DEFAULT },
-                { 9, 5, 8, 2, BRIDGE_OFF_DEFAULT },
-                { 8, 2, 7, 0, BRIDGE_OFF_DEFAULT },
-                { 8, 7, 4, 5, BRIDGE_ON_DEFAULT },
-                { 4, 5, 7, 0, BRIDGE_OFF_DEFAULT },
-                { 4, 5, 3, 3, BRIDGE_OFF_DEFAULT },
-                { 3, 3, 1, 4, BRIDGE_OFF_DEFAULT },
-                { 1, 4, 0, 6, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            3,
-            {
-                { 9, 0, 10, 2, BRIDGE_OFF_DEFAULT },
-                { 10, 2, 8, 2, BRIDGE_ON_DEFAULT },
-                { 6, 3, 8, 2, BRIDGE_ON_DEFAULT },
-                { 6, 3, 3, 2, BRIDGE_ON_DEFAULT },
-                { 3, 2, 3, 0, BRIDGE_OFF_DEFAULT },
-                { 6, 3, 5, 5, BRIDGE_OFF_DEFAULT },
-                { 5, 5, 8, 6, BRIDGE_OFF_DEFAULT },
-                { 8, 6, 10, 2, BRIDGE_OFF_DEFAULT },
-                { 9, 10, 8, 6, BRIDGE_OFF_DEFAULT },
-                { 5, 5, 5, 9, BRIDGE_OFF_DEFAULT },
-                { 5, 9, 2, 9, BRIDGE_OFF_DEFAULT },
-                { 2, 9, 2, 11, BRIDGE_OFF_DEFAULT },
-                { 2, 11, 2, 13, BRIDGE_OFF_DEFAULT },
-                { 2, 13, 4, 13, BRIDGE_OFF_DEFAULT },
-                { 4, 13, 6, 13, BRIDGE_OFF_DEFAULT },
-                { 6, 13, 9, 10, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            16,
-            2,
-            {
-                { 9, 14, 7, 14, BRIDGE_OFF_DEFAULT },
-                { 10, 12, 9, 14, BRIDGE_OFF_DEFAULT },
-                { 10, 12, 8, 10, BRIDGE_OFF_DEFAULT },
-                { 8, 10, 10, 8, BRIDGE_OFF_DEFAULT },
-                { 10, 8, 10, 6, BRIDGE_OFF_DEFAULT },
-                { 7, 14, 5, 12, BRIDGE_OFF_DEFAULT },
-                { 5, 12, 1, 13, BRIDGE_ON_DEFAULT },
-                { 5, 12, 5, 10, BRIDGE_OFF_DEFAULT },
-                { 5, 10, 3, 8, BRIDGE_OFF_DEFAULT },
-                { 0, 8, 1, 13, BRIDGE_OFF_DEFAULT },
-                { 3, 8, 0, 8, BRIDGE_OFF_DEFAULT },
-                { 5, 5, 3, 8, BRIDGE_OFF_DEFAULT },
-                { 5, 5, 7, 1, BRIDGE_ON_DEFAULT },
-                { 5, 5, 3, 4, BRIDGE_OFF_DEFAULT },
-                { 0, 8, 3, 4, BRIDGE_OFF_DEFAULT },
-                { 3, 4, 0, 0, BRIDGE_OFF_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        },
-        {
-            17,
-            2,
-            {
-                { 2, 13, 0, 14, BRIDGE_OFF_DEFAULT },
-                { 2, 13, 2, 11, BRIDGE_OFF_DEFAULT },
-                { 2, 11, 0, 11, BRIDGE_OFF_DEFAULT },
-                { 2, 11, 1, 9, BRIDGE_ON_DEFAULT },
-                { 2, 11, 4, 10, BRIDGE_OFF_DEFAULT },
-                { 4, 10, 1, 9, BRIDGE_OFF_DEFAULT },
-                { 4, 10, 6, 9, BRIDGE_OFF_DEFAULT },
-                { 6, 14, 2, 13, BRIDGE_OFF_DEFAULT },
-                { 9, 14, 6, 14, BRIDGE_OFF_DEFAULT },
-                { 6, 9, 8, 7, BRIDGE_OFF_DEFAULT },
-                { 8, 7, 10, 4, BRIDGE_OFF_DEFAULT },
-                { 8, 1, 10, 4, BRIDGE_OFF_DEFAULT },
-                { 1, 9, 2, 7, BRIDGE_OFF_DEFAULT },
-                { 3, 4, 2, 7, BRIDGE_OFF_DEFAULT },
-                { 3, 4, 6, 9, BRIDGE_OFF_DEFAULT },
-                { 3, 4, 0, 3, BRIDGE_OFF_DEFAULT },
-                { 0, 3, 2, 7, BRIDGE_ON_DEFAULT },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED },
-                { -1, -1, -1, -1, BRIDGE_DISABLED }
-            }
-        }
-    };
+// Input of every tick is recorded, saved on exit so the session can be replayed (see replay_verify.c)
+static struct InputRecording recording = { 0 };
+static bool recordingEnabled = false;
+
+// State of the last ticks, captured after every tick: held backspace rewinds, dumped on crash
+static struct SnapshotRing snapshotRing = { 0 };
+
+// Versus mode (--versus PLAYER): race another player on localhost, both games are advanced by the netplay session
+static int versusPlayerId = -1;                 // Not playing versus if -1
+static int versusPort = 0;                      // Local port, NETPLAY_PORT + player if 0
+static int versusRemotePort = 0;                // Remote player (or relay) port, the other player port if 0
+static bool versusEnabled = false;
+static struct NetplaySession netplay = { 0 };
+
+// Telemetry (--telemetry prefix): gameplay events and frame times, written by a background thread (see telemetry.h)
+static const char *telemetryFileNamePrefix = NULL;  // Telemetry off if NULL
+static double telemetryTime = 0.0;              // Frame time recorded with the events of its ticks
 
-static int numberOfConstellations = sizeof(constellations)/sizeof(struct Constellation);
+static const char *packFileName = "resources/constellations.sfcp";     // Constellations pack (--pack file)
 
-static struct GameState gameState = { 0 };
+// Benchmark mode (--bench N): N frames uncapped, fixed frame time and scripted input, every phase timed
+static int benchFramesCount = 0;                // Not benchmarking if 0
+static int benchFrameId = 0;
+static double *benchPhaseSeconds = NULL;        // Phase times of every frame, BENCH_PHASES_COUNT per frame
+
+// Stress mode (--stress N): N frogs wandering the star field with the player, drawn as a single sprites batch
+static int swarmFrogsCount = 0;
+static struct FrogSwarm swarm = { 0 };          // No frogs if not stressing
+static Rectangle frogSpriteTexcoords[SWARM_SPRITES_COUNT] = { 0 };     // Frog sprites source rectangles, normalized
+static int swarmDrawnCount = 0;                 // Frogs inside the camera view, last frame drawn
+
+// Profiler (F3 debug mode overlay): phase times of the last frames, draw work of the last frame
+// NOTE: Phases are always timed, the overlay can be shown at any time with the graph filled
+static double phaseStartTime = 0.0;
+static double profilerPhaseSeconds[PROFILER_FRAMES_COUNT][BENCH_PHASES_COUNT] = { 0 };
+static int profilerFrameId = 0;                 // Ring position of the current frame
+static rlRenderBatch renderBatch = { 0 };       // Used instead of rlgl default batch, so its draw calls can be counted
+static struct RenderStats renderStats = { 0 };          // Current frame, counting
+static struct RenderStats prevRenderStats = { 0 };      // Last frame, shown by the overlay
 
 //----------------------------------------------------------------------------------
 // Module Functions Declaration
 //----------------------------------------------------------------------------------
 static void UpdateDrawFrame(void);      // Update and Draw one frame
 
-static void ResetPlayer(struct Player *player);
-static void ResetCamera(Camera2D *camera, struct Player *player);
-static void ResetConstellations(void);
-static void ResetGameState(struct GameState *gameState);
-static int GetRandomNewConstellationId(struct GameState *gameState);
-static void UpdatePlayer(struct Player *player, float delta);
-static void UpdateCameraCenterSmoothFollow(Camera2D *camera, struct Player *player, float delta);
-static void InteractPlayerAndStars(struct GameState *gameState, struct Player *player, int constellationId);
-static int GetConstellationRequiredScore(int constellationId);
-static Vector2 GetStarPosition(int x, int y);
-static Rectangle GetStarRec(Vector2 position);
-static Rectangle GetPlayerRec(Vector2 position);
-static int GetConstellationBridgeIndex(int constellationId, int x1, int y1, int x2, int y2);
-static void DrawSprite(int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position);
+static struct InputFrame PollInputFrame(void);
+#if !defined(PLATFORM_WEB)
+static void SaveCrashSnapshots(int signalId);
+#endif
+static int GetGameTick(void);           // Ticks played by the current game, from the snapshot ring
+static struct InputFrame GetBenchInputFrame(int frame);
+static void EndBenchPhase(enum BenchPhase phase);
+static int CompareDoubles(const void *a, const void *b);
+static void PrintBenchReport(void);
+static void CountRenderBatch(void);
+static void DrawProfilerOverlay(int posX, int posY);
+static void DrawSprite(int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position, Color tint);
 static void DrawStar(int x, int y, int frameNumber);
-static void DrawDebugGrid(int spacingPixels);
-static void DrawStars(void);
-static void DrawBridges(int constellationId);
-static void DrawPlayer(struct Player *player, float deltaTime);
-static Vector2 GetMinimapStarPosition(int x, int y);
+static Font GetFont(int fontSize);
+static Rectangle GetCameraViewRec(Camera2D camera);
+static void DrawDebugGrid(int spacingPixels, Rectangle view);
+static void UpdateStarFieldRender(void);
+static void DrawStars(Rectangle view);
+static void UpdateBridgeGeometry(const struct GameInstance *game);
+static void AddBridgeGeometry(const struct ConstellationView *constellation, int bridgeId);
+static void CheckRenderBatchLimit(int verticesCount);
+static void DrawBridges(const struct GameInstance *game, Rectangle view);
+static void DrawHoveredBridges(const struct GameInstance *game, Vector2 position);
+static void DrawPlayer(const struct Player *player, Vector2 position, Color tint);
+static void DrawFrogSwarm(Camera2D camera);
+static void DrawVersusStatus(void);
+static Vector2 GetMinimapStarPosition(float x, float y);
+static void UpdateMinimapPyramid(const struct GameInstance *game, int constellationId);
+static void UpdateMinimapLayout(void);
 static void DrawMinimapFrame(void);
-static void DrawMinimapConstellation(int constellationId);
-static void DrawStagePanel(struct GameState *gameState);
+static void DrawMinimapConstellation(const struct GameInstance *game);
+static void DrawMinimapTiles(void);
+static void DrawMinimapViewport(Camera2D camera, Vector2 position, float scale);
+static void UpdateMinimapRender(const struct GameInstance *game);
+static void UpdateStagePanelRender(const struct GameInstance *game);
+static void DrawStagePanel(void);
+static void UpdateResultLinesRender(const struct GameInstance *game);
+static void DrawResultLines(void);
+static void RunStageParJob(void *data);
+static void UpdateStageParTimes(const struct GameInstance *game);
+static struct ParTime GetStageParTime(const struct GameState *gameState, int stageId);
+static struct MainRenderKey GetMainRenderKey(const struct GameInstance *game, Vector2 playerPosition, Camera2D camera);
 
 //------------------------------------------------------------------------------------
 // Program main entry point
 //------------------------------------------------------------------------------------
-int main(void)
+int main(int argc, char *argv[])
 {
 #if !defined(_DEBUG)
     SetTraceLogLevel(LOG_NONE);         // Disable raylib trace log messsages
 #endif
 
+#if !defined(PLATFORM_WEB)
+    // Benchmark mode: game is run offscreen for N frames, phase timings are printed as JSON
+    // Stress mode: N frogs are added to the game, can be combined with benchmark mode
+    // Versus mode: player 0 or 1 races the other one on localhost, ports can be changed to go through a relay
+    // Pack: constellations pack played, its grid is the star field
+    // Telemetry: gameplay events and frame times are logged to prefix_N.sftl files, off by default
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        if (strcmp(argv[i], "--bench") == 0) benchFramesCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--stress") == 0) swarmFrogsCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--versus") == 0) versusPlayerId = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--port") == 0) versusPort = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--remote-port") == 0) versusRemotePort = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--pack") == 0) packFileName = argv[i + 1];
+        else if (strcmp(argv[i], "--telemetry") == 0) telemetryFileNamePrefix = argv[i + 1];
+    }
+
+    if (benchFramesCount > 0)
+    {
+        benchPhaseSeconds = (double *)malloc(BENCH_PHASES_COUNT*benchFramesCount*sizeof(double));
+        if (benchPhaseSeconds == NULL) return 1;
+
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        idleModeEnabled = false;
+    }
+#else
+    (void)argc;
+    (void)argv;
+#endif
+
     // Initialization
     //--------------------------------------------------------------------------------------
     InitWindow(SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, "raylib 9yr gamejam");
+
+    // Same batch size as rlgl default batch, only made accessible to the profiler
+    renderBatch = rlLoadRenderBatch(1, RL_DEFAULT_BATCH_BUFFER_ELEMENTS);
+    rlSetRenderBatchActive(&renderBatch);
     
     // TODO: Load resources / Initialize variables at this point
 
-    // Load spritesheet
-    spritesheet = LoadTexture("resources/spritesheet2.png");
+    // Load spritesheet and fonts, from the executable if assets are baked
+#if defined(SUPPORT_BAKED_ASSETS)
+    spritesheet = LoadTextureFromImage((Image){ (void *)bakedSpritesheetData, BAKED_SPRITESHEET_WIDTH, BAKED_SPRITESHEET_HEIGHT, 1, BAKED_SPRITESHEET_FORMAT });
+
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
+    {
+        // NOTE: Glyphs and rectangles are used in place, only the atlas texture is loaded
+        const struct BakedFont *baked = &bakedFonts[i];
+        fonts[i].baseSize = baked->size;
+        fonts[i].glyphCount = FONT_GLYPH_COUNT;
+        fonts[i].glyphPadding = FONT_GLYPH_PADDING;
+        fonts[i].recs = baked->recs;
+        fonts[i].glyphs = baked->glyphs;
+        fonts[i].texture = LoadTextureFromImage((Image){ (void *)baked->atlasData, baked->atlasWidth, baked->atlasHeight, 1, baked->atlasFormat });
+    }
+#else
+    spritesheet = LoadTexture(SPRITESHEET_FILE_NAME);
+
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1) fonts[i] = LoadFontEx(FONT_FILE_NAME, fontSizes[i], NULL, FONT_GLYPH_COUNT);
+#endif
+
+    // Load constellations pack (memory mapped), built-in constellations are used if not available
+    LoadConstellations(packFileName);
+    if (benchFramesCount == 0) LOG("CONSTELLATIONS: %i\n", GetConstellationsCount());
+
+    // NOTE: Benchmark uses a fixed seed, so every run plays the same constellations
+    const unsigned int seed = (benchFramesCount > 0)? 1 : (unsigned int)GetRandomValue(1, 0x7fffffff);
+    InitGameInstance(&game, seed);
+    InitSnapshotRing(&snapshotRing, &game, 0);
+
+    if ((swarmFrogsCount > 0) && InitFrogSwarm(&swarm, swarmFrogsCount, seed))
+    {
+        if (benchFramesCount == 0) LOG("STRESS MODE: %i FROGS\n", swarm.count);
+        idleModeEnabled = false;    // Frogs always move
+
+        for (int i = 0; i < SWARM_SPRITES_COUNT; i += 1)
+        {
+            const Rectangle rec = GetFrogSpriteRec(i);
+            frogSpriteTexcoords[i] = (Rectangle){ rec.x/spritesheet.width, rec.y/spritesheet.height,
+                                                  rec.width/spritesheet.width, rec.height/spritesheet.height };
+        }
+    }
 
-    font = LoadFont("resources/Autriche-4n84.ttf");
+#if !defined(PLATFORM_WEB)
+    InitInputRecording(&recording, seed);
+    recordingEnabled = (benchFramesCount == 0);
 
-    ResetPlayer(&player);
+    if ((telemetryFileNamePrefix != NULL) && (benchFramesCount == 0)) InitTelemetry(telemetryFileNamePrefix);
 
-    ResetCamera(&camera, &player);
+    // NOTE: Local game plays its inputs delayed and the opponent decides the seed, versus is not recorded
+    if ((versusPlayerId != -1) && (benchFramesCount == 0))
+    {
+        const int port = (versusPort != 0)? versusPort : NETPLAY_PORT + versusPlayerId;
+        const int remotePort = (versusRemotePort != 0)? versusRemotePort : NETPLAY_PORT + 1 - versusPlayerId;
+        versusEnabled = InitNetplaySession(&netplay, versusPlayerId, (unsigned short)port, (unsigned short)remotePort, seed);
 
-    ResetConstellations();
+        if (versusEnabled)
+        {
+            LOG("VERSUS: PLAYER %i, PORT %i TO %i\n", versusPlayerId, port, remotePort);
+            recordingEnabled = false;
+            idleModeEnabled = false;    // Opponent frog is not part of the main render key
+            game = netplay.local;
+        } else LOG("VERSUS: PORT %i NOT AVAILABLE\n", port);
+    }
 
-    ResetGameState(&gameState);
+    // NOTE: Snapshots are saved as they are, the crashed tick and the ones before it can be inspected
+    signal(SIGSEGV, SaveCrashSnapshots);
+    signal(SIGABRT, SaveCrashSnapshots);
+    signal(SIGFPE, SaveCrashSnapshots);
+#endif
 
     // Render texture to draw full screen, enables screen scaling
     // NOTE: If screen is scaled, mouse input should be scaled proportionally
@@ -527,28 +464,73 @@ int main(void)
     minimapRender = LoadRenderTexture(MINIMAP_WIDTH_PIXELS, MINIMAP_HEIGHT_PIXELS);
     SetTextureFilter(minimapRender.texture, TEXTURE_FILTER_BILINEAR);
 
+    stagePanelRender = LoadRenderTexture(SCREEN_WIDTH_PIXELS, STAGE_PANEL_HEIGHT_PIXELS);
+    resultLinesRender = LoadRenderTexture(SCREEN_WIDTH_PIXELS, RESULT_LINES_HEIGHT_PIXELS);
+
 #if defined(PLATFORM_WEB)
-    emscripten_set_main_loop(UpdateDrawFrame, 60, 1);
+    emscripten_set_main_loop(UpdateDrawFrame, 0, 1);   // Run at the display refresh rate, simulation uses fixed ticks
 #else
-    SetTargetFPS(60);     // Set our game frames-per-second
+    SetTargetFPS((benchFramesCount > 0)? 0 : 60);     // Set our game frames-per-second, uncapped on benchmark
     //--------------------------------------------------------------------------------------
 
     // Main game loop
-    while (!WindowShouldClose())    // Detect window close button
+    while (!WindowShouldClose() && ((benchFramesCount == 0) || (benchFrameId < benchFramesCount)))    // Detect window close button
     {
         UpdateDrawFrame();
     }
+
+    if (benchFramesCount > 0) PrintBenchReport();
 #endif
 
     // De-Initialization
     //--------------------------------------------------------------------------------------
+    UnloadRenderTexture(starFieldRender);
+
     UnloadRenderTexture(minimapRender);
 
+    UnloadRenderTexture(stagePanelRender);
+
+    UnloadRenderTexture(resultLinesRender);
+
     UnloadRenderTexture(mainRender);
 
-    UnloadFont(font);
+    UnloadBridgeGrid(&bridgeGrid);
+
+    UnloadMinimapPyramid(&minimapPyramid);
+
+#if defined(SUPPORT_BAKED_ASSETS)
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1) UnloadTexture(fonts[i].texture);
+#else
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1) UnloadFont(fonts[i]);
+#endif
+
+    if (recordingEnabled && (recording.ticksCount > 0))
+    {
+        const char *recordingFileName = TextFormat("session_%lld.sfr", (long long)time(NULL));
+        if (SaveInputRecording(recordingFileName, &recording, &game)) LOG("INPUT RECORDING: %s\n", recordingFileName);
+    }
+    UnloadInputRecording(&recording);
+
+    if (versusEnabled) CloseNetplaySession(&netplay);
+
+    CloseTelemetry();
+
+    UnloadFrogSwarm(&swarm);
+
+    free(benchPhaseSeconds);
+
+    // Par time jobs read the pack constellations
+    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+    {
+        if (isStageParSolving[i]) WaitBackgroundJob(&stageParBackgroundJobs[i]);
+    }
+
+    UnloadConstellations();
 
     UnloadTexture(spritesheet);
+
+    rlSetRenderBatchActive(NULL);       // Back to rlgl default batch
+    rlUnloadRenderBatch(renderBatch);
     
     // TODO: Unload all loaded resources at this point
 
@@ -564,7 +546,11 @@ int main(void)
 // Update and draw frame
 void UpdateDrawFrame(void)
 {
-    float deltaTime = GetFrameTime();
+    // NOTE: Benchmark frames run exactly one tick each, so results do not depend on the frame rate
+    float deltaTime = (benchFramesCount > 0)? GAME_TICK_SECONDS : GetFrameTime();
+    if (deltaTime > GAME_MAX_FRAME_SECONDS) deltaTime = GAME_MAX_FRAME_SECONDS;
+
+    phaseStartTime = GetTime();
 
     // Update
     //----------------------------------------------------------------------------------
@@ -588,217 +574,218 @@ void UpdateDrawFrame(void)
     // TODO: Update variables / Implement example logic at this point
     //----------------------------------------------------------------------------------
 
-    if (IsKeyPressed(KEY_F3))
+    struct InputFrame input = (benchFramesCount > 0)? GetBenchInputFrame(benchFrameId) : PollInputFrame();
+    telemetryTime = GetTime();
+
+    if (input.buttons & INPUT_BUTTON_DEBUG)
     {
-        if (debugMode)
-        {
-            LOG("Debug mode is ON\n");
-        } else
-        {
-            LOG("Debug mode is OFF\n");
-        }
         debugMode = !debugMode;
+        RecordTelemetryEvent(TELEMETRY_DEBUG_MODE, debugMode, game.gameState.stageId, GetGameTick(), (unsigned long long)(telemetryTime*1e6));
     }
 
-    gameState.clockSeconds += deltaTime;
-    switch (gameState.state)
+    // Pressed buttons are latched until a tick consumes them, frames might run zero ticks
+    pendingPressedButtons |= input.buttons & (INPUT_BUTTON_GRAB | INPUT_BUTTON_RESTART | INPUT_BUTTON_DEBUG);
+
+    if (versusEnabled)
     {
-        case GAMESTATE_START:
+        // Versus: both games are advanced by the netplay session, late opponent inputs roll its game back
+        PollNetplaySession(&netplay);
+
+        tickAccumulatorSeconds += deltaTime;
+        while (tickAccumulatorSeconds >= GAME_TICK_SECONDS)
         {
-            UpdatePlayer(&player, deltaTime);
-            UpdateCameraCenterSmoothFollow(&camera, &player, deltaTime);
+            input.buttons = (input.buttons & ~(INPUT_BUTTON_GRAB | INPUT_BUTTON_RESTART | INPUT_BUTTON_DEBUG)) | pendingPressedButtons;
 
-            if (gameState.clockSeconds >= 5.0f)
+            // Waiting for the opponent (or connecting), the last tick is shown until the next one can be played
+            if (!StepNetplaySession(&netplay, &input))
             {
-                gameState.clockSeconds = 0;
-                gameState.stages[gameState.stageId].constellationId = GetRandomNewConstellationId(&gameState);
-                gameState.state = GAMESTATE_GAMEPLAY;
+                tickAccumulatorSeconds = GAME_TICK_SECONDS;
+                break;
             }
-        } break;
-        case GAMESTATE_GAMEPLAY:
-        {
-            struct GameStateStage *stage = &gameState.stages[gameState.stageId];
-
-            stage->timerSeconds += deltaTime;
 
-            UpdatePlayer(&player, deltaTime);
-            UpdateCameraCenterSmoothFollow(&camera, &player, deltaTime);
-            InteractPlayerAndStars(&gameState, &player, stage->constellationId);
+            pendingPressedButtons = 0;
+            CaptureGameSnapshot(&snapshotRing, &netplay.local);
+            RecordTelemetryGameEvents(&game, &netplay.local, GetGameTick(), (unsigned long long)(telemetryTime*1e6));
+            game = netplay.local;
+            tickAccumulatorSeconds -= GAME_TICK_SECONDS;
+        }
 
-            if (stage->score == GetConstellationRequiredScore(stage->constellationId))
-            {
-                gameState.clockSeconds = 0;
-                gameState.state = GAMESTATE_CLEAR;
-            }
-        } break;
-        case GAMESTATE_CLEAR:
+        game = netplay.local;
+    } else if ((benchFramesCount == 0) && IsKeyDown(KEY_BACKSPACE))
+    {
+        // Rewind through the last ticks instead of advancing, recorded input after the restored tick is dropped
+        // so the recording still replays into the current game
+        const int prevTick = GetGameTick();
+        const int tick = RewindGameSnapshot(&snapshotRing, REWIND_TICKS_PER_FRAME, &game);
+        if (recordingEnabled) recordingEnabled = TruncateInputRecording(&recording, tick);
+        if (tick != prevTick) RecordTelemetryEvent(TELEMETRY_REWIND, prevTick - tick, game.gameState.stageId, tick, (unsigned long long)(telemetryTime*1e6));
+
+        tickAccumulatorSeconds = 0.0f;
+        pendingPressedButtons = 0;
+    } else
+    {
+        // Advance the simulation in fixed ticks, render rate does not change gameplay
+        tickAccumulatorSeconds += deltaTime;
+        while (tickAccumulatorSeconds >= GAME_TICK_SECONDS)
         {
-            UpdatePlayer(&player, deltaTime);
-            UpdateCameraCenterSmoothFollow(&camera, &player, deltaTime);
+            input.buttons = (input.buttons & ~(INPUT_BUTTON_GRAB | INPUT_BUTTON_RESTART | INPUT_BUTTON_DEBUG)) | pendingPressedButtons;
+            pendingPressedButtons = 0;
 
-            if (gameState.clockSeconds <= 5.0f)
-            {
-                break;
-            }
+            if (recordingEnabled) recordingEnabled = RecordInputFrame(&recording, &input);
 
-            if (gameState.stageId == GAMESTATE_STAGES_COUNT - 1)
-            {
-                gameState.clockSeconds = 0;
-                gameState.state = GAMESTATE_RESULT;
-            } else
-            {
-                gameState.clockSeconds = 0;
-                gameState.stageId += 1;
-                gameState.state = GAMESTATE_START;
-            }
-        } break;
-        case GAMESTATE_RESULT:
-        {
-            if (gameState.clockSeconds >= 2.0f)
-            {
-                if (IsKeyPressed(KEY_R))
-                {
-                    ResetPlayer(&player);
-                    ResetCamera(&camera, &player);
-                    ResetConstellations();
-                    ResetGameState(&gameState);
-                }
-            }
-        } break;
+            const struct GameInstance prevGame = game;
+            GameStep(&game, &input, GAME_TICK_SECONDS);
+            CaptureGameSnapshot(&snapshotRing, &game);
+            RecordTelemetryGameEvents(&prevGame, &game, GetGameTick(), (unsigned long long)(telemetryTime*1e6));
+            if (swarm.count > 0) UpdateFrogSwarm(&swarm, GAME_TICK_SECONDS);
+            tickAccumulatorSeconds -= GAME_TICK_SECONDS;
+        }
     }
 
+    // Fraction of a tick elapsed since the last step, used to interpolate rendering
+    const float alpha = tickAccumulatorSeconds/GAME_TICK_SECONDS;
+    const Vector2 playerPosition = GetInterpolatedPlayerPosition(&game, alpha);
+
+    Camera2D camera = game.camera;
+    camera.target = GetInterpolatedCameraTarget(&game, alpha);
+
+    const struct GameState *gameState = &game.gameState;
+    const Rectangle view = GetCameraViewRec(camera);
+
+    // Opponent frog is drawn while it plays the stage shown
+    const struct GameState *opponentState = &netplay.remote.gameState;
+    const bool isOpponentShown = versusEnabled && (netplay.state != NETPLAY_CONNECTING) &&
+                                 (opponentState->state != GAMESTATE_RESULT) && (opponentState->stageId == gameState->stageId);
+    const Vector2 opponentPosition = GetInterpolatedPlayerPosition(&netplay.remote, alpha);
+
+    EndBenchPhase(BENCH_PHASE_UPDATE);
+
     // Draw
     //----------------------------------------------------------------------------------
-    // Render all screen to texture (for scaling)
-    BeginTextureMode(mainRender);
-        ClearBackground(palette[0]);
-        
-        // TODO: Draw screen at 256x256
-        DrawRectangle(0, 0, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, palette[5]);
+    // NOTE: Must be done outside of any other texture mode
+    UpdateStarFieldRender();
+    UpdateStageParTimes(&game);
+    if (gameState->state == GAMESTATE_RESULT) UpdateResultLinesRender(&game);
+    else UpdateStagePanelRender(&game);
+
+    // Idle mode: static screens (results, idle frog between flaps, countdown between seconds) are not redrawn
+    const struct MainRenderKey renderKey = GetMainRenderKey(&game, playerPosition, camera);
+    if (idleModeEnabled && mainRenderValid && (memcmp(&mainRenderKey, &renderKey, sizeof(struct MainRenderKey)) == 0))
+    {
+        mainRenderSkippedCount += 1;
+    } else
+    {
+        mainRenderValid = true;
+        mainRenderKey = renderKey;
+        mainRenderRedrawCount += 1;
 
-        BeginMode2D(camera);
+        // Render all screen to texture (for scaling)
+        BeginTextureMode(mainRender);
+            ClearBackground(palette[0]);
 
-            if (debugMode)
-            {
-                DrawDebugGrid(STAR_SPACING_PIXELS);
-            }
+            // TODO: Draw screen at 256x256
+            DrawRectangle(0, 0, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS, palette[5]);
 
-            switch (gameState.state)
+            CountRenderBatch();
+            BeginMode2D(camera);
+
+                if (debugMode)
+                {
+                    DrawDebugGrid(STAR_SPACING_PIXELS, view);
+                }
+
+                switch (gameState->state)
+                {
+                    case GAMESTATE_START:
+                    {
+                        DrawStars(view);
+                        DrawFrogSwarm(camera);
+                        if (isOpponentShown) DrawPlayer(&netplay.remote.player, opponentPosition, Fade(WHITE, VERSUS_OPPONENT_ALPHA));
+                        DrawPlayer(&game.player, playerPosition, WHITE);
+                    } break;
+                    case GAMESTATE_GAMEPLAY:
+                    {
+                        DrawStars(view);
+                        DrawBridges(&game, view);
+                        if (debugMode) DrawHoveredBridges(&game, playerPosition);
+                        DrawFrogSwarm(camera);
+                        if (isOpponentShown) DrawPlayer(&netplay.remote.player, opponentPosition, Fade(WHITE, VERSUS_OPPONENT_ALPHA));
+                        DrawPlayer(&game.player, playerPosition, WHITE);
+                    } break;
+                    case GAMESTATE_CLEAR:
+                    {
+                        DrawStars(view);
+                        DrawBridges(&game, view);
+                        if (debugMode) DrawHoveredBridges(&game, playerPosition);
+                        DrawFrogSwarm(camera);
+                        if (isOpponentShown) DrawPlayer(&netplay.remote.player, opponentPosition, Fade(WHITE, VERSUS_OPPONENT_ALPHA));
+                        DrawPlayer(&game.player, playerPosition, WHITE);
+                    } break;
+                    case GAMESTATE_RESULT:
+                    {
+                    } break;
+                }
+
+            CountRenderBatch();
+            EndMode2D();
+
+            switch (gameState->state)
             {
                 case GAMESTATE_START:
                 {
-                    DrawStars();
-                    DrawPlayer(&player, deltaTime);
+                    if ((gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 4.0f))
+                    {
+                        const int seconds = (int)gameState->clockSeconds;
+                        const Vector2 textPos = (Vector2){ 100, 160};
+                        DrawTextEx(GetFont(60), TextFormat("%i", 4 - seconds), textPos, 60, 1.0f, palette[0]);
+                    }
+
+                    DrawStagePanel();
                 } break;
                 case GAMESTATE_GAMEPLAY:
                 {
-                    DrawStars();
-                    DrawBridges(gameState.stages[gameState.stageId].constellationId);
-                    DrawPlayer(&player, deltaTime);
+                    if ((gameState->clockSeconds >= 0.0f) && (gameState->clockSeconds <= 1.5f))
+                    {
+                        const Vector2 textPos = (Vector2){ 40, 170};
+                        DrawTextEx(GetFont(40), "START", textPos, 40, 1.0f, palette[0]);
+                    }
+                    DrawStagePanel();
                 } break;
                 case GAMESTATE_CLEAR:
                 {
-                    DrawStars();
-                    DrawBridges(gameState.stages[gameState.stageId].constellationId);
-                    DrawPlayer(&player, deltaTime);
+                    if ((gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 5.0f))
+                    {
+                        const Vector2 textPos = (Vector2){ 40, 170};
+                        DrawTextEx(GetFont(40), "CLEAR", textPos, 40, 1.0f, palette[0]);
+                    }
+                    DrawStagePanel();
                 } break;
                 case GAMESTATE_RESULT:
                 {
-                } break;
-            }
-
-        EndMode2D();
-
-        switch (gameState.state)
-        {
-            case GAMESTATE_START:
-            {
-                if ((gameState.clockSeconds >= 1.0f) && (gameState.clockSeconds <= 4.0f))
-                {
-                    const int seconds = (int)gameState.clockSeconds;
-                    const Vector2 textPos = (Vector2){ 100, 160};
-                    DrawTextEx(font, TextFormat("%i", 4 - seconds), textPos, 60, 1.0f, palette[0]);
-                }
+                    DrawResultLines();
 
-                DrawStagePanel(&gameState);
-            } break;
-            case GAMESTATE_GAMEPLAY:
-            {
-                if ((gameState.clockSeconds >= 0.0f) && (gameState.clockSeconds <= 1.5f))
-                {
-                    const Vector2 textPos = (Vector2){ 40, 170};
-                    DrawTextEx(font, "START", textPos, 40, 1.0f, palette[0]);
-                }
-                DrawStagePanel(&gameState);
-            } break;
-            case GAMESTATE_CLEAR:
-            {
-                if ((gameState.clockSeconds >= 1.0f) && (gameState.clockSeconds <= 5.0f))
-                {
-                    const Vector2 textPos = (Vector2){ 40, 170};
-                    DrawTextEx(font, "CLEAR", textPos, 40, 1.0f, palette[0]);
-                }
-                DrawStagePanel(&gameState);
-            } break;
-            case GAMESTATE_RESULT:
-            {
-                if (gameState.clockSeconds >= 1.0f)
-                {
-                    // TODO: Rename variables
-                    const int stageId = (int)(gameState.clockSeconds - 1.0f);
-                    const int max = (stageId < GAMESTATE_STAGES_COUNT - 1) ? stageId : GAMESTATE_STAGES_COUNT - 1;
-                    for (int i = 0; i <= max; i += 1)
+                    if (gameState->clockSeconds >= 5.0f)
                     {
-                        int seconds = (int)(gameState.stages[i].timerSeconds);
-                        int minutes = seconds/60;
-                        seconds -= minutes*60;
-                        // TODO: Share the constellation id
-                        DrawTextEx(font,
-                                TextFormat("STAGE %i: %02i:%02i", i + 1, minutes, seconds),
-                                (Vector2){ 20, 40 + 30*i},
-                                20,
-                                1.0f,
-                                palette[0]);
+                        if (gameState->clockSeconds - (int)(gameState->clockSeconds) >= 0.5)
+                        {
+                            DrawTextEx(GetFont(20), "  PRESS (R)  ", (Vector2){ 40, 210}, 20, 1.0f, palette[0]);
+                            DrawTextEx(GetFont(20), "TO PLAY AGAIN", (Vector2){ 15, 230}, 20, 1.0f, palette[0]);
+                        }
                     }
-                }
+                } break;
+            }
 
-                if (gameState.clockSeconds >= 5.0f)
-                {
-                    if (gameState.clockSeconds - (int)(gameState.clockSeconds) >= 0.5)
-                    {
-                        DrawTextEx(font, "  PRESS (R)  ", (Vector2){ 40, 210}, 20, 1.0f, palette[0]);
-                        DrawTextEx(font, "TO PLAY AGAIN", (Vector2){ 15, 230}, 20, 1.0f, palette[0]);
-                    }
-                }
-            } break;
-        }
+            if (versusEnabled) DrawVersusStatus();
 
-    EndTextureMode();
+        CountRenderBatch();
+        EndTextureMode();
+    }
 
-    BeginTextureMode(minimapRender);
+    EndBenchPhase(BENCH_PHASE_MAIN_RENDER);
 
-        switch (gameState.state)
-        {
-            case GAMESTATE_START:
-            {
-                DrawMinimapFrame();
-            } break;
-            case GAMESTATE_GAMEPLAY:
-            {
-                DrawMinimapFrame();
-                DrawMinimapConstellation(gameState.stages[gameState.stageId].constellationId);
-            } break;
-            case GAMESTATE_CLEAR:
-            {
-                DrawMinimapFrame();
-                DrawMinimapConstellation(gameState.stages[gameState.stageId].constellationId);
-            } break;
-            case GAMESTATE_RESULT:
-            {
-            } break;
-        }
+    UpdateMinimapRender(&game);
 
-    EndTextureMode();
+    EndBenchPhase(BENCH_PHASE_MINIMAP);
     
     BeginDrawing();
         ClearBackground(palette[0]);
@@ -811,7 +798,7 @@ void UpdateDrawFrame(void)
                        0.0f, 
                        WHITE);
 
-        if (gameState.state != GAMESTATE_RESULT)
+        if (gameState->state != GAMESTATE_RESULT)
         {
             DrawTexturePro(minimapRender.texture,
                            (Rectangle){ 0, 0, (float)minimapRender.texture.width, -(float)minimapRender.texture.height },
@@ -819,6 +806,12 @@ void UpdateDrawFrame(void)
                            (Vector2){ 0, 0 },
                            0.0f, 
                            WHITE);
+
+            // NOTE: Camera moves every frame, its viewport is drawn over the retained minimap
+            if (minimapConstellationId != -1)
+            {
+                DrawMinimapViewport(camera, (Vector2){ (SCREEN_WIDTH_PIXELS - MINIMAP_WIDTH_PIXELS - 5)*screenScale, 5*screenScale }, screenScale);
+            }
         }
 
         // Draw equivalent mouse position on the main render-texture
@@ -828,396 +821,586 @@ void UpdateDrawFrame(void)
         if (debugMode)
         {
             DrawFPS(0, 0);
+            DrawText(TextFormat("MINIMAP: %i DRAWN %i SKIPPED", minimapRedrawCount, minimapSkippedCount), 0, 20, 10, LIME);
+            DrawText(TextFormat("MAIN: %i DRAWN %i SKIPPED", mainRenderRedrawCount, mainRenderSkippedCount), 0, 30, 10, LIME);
+            int posY = 40;
+            if (swarm.count > 0)
+            {
+                DrawText(TextFormat("SWARM: %i FROGS %i DRAWN", swarm.count, swarmDrawnCount), 0, posY, 10, LIME);
+                posY += 10;
+            }
+            if (versusEnabled)
+            {
+                DrawText(TextFormat("VERSUS: %i ROLLBACKS (MAX %i TICKS) %i STALLS %i SKIPS", netplay.stats.rollbacksCount,
+                                    netplay.stats.maxRollbackTicks, netplay.stats.stalledStepsCount, netplay.stats.skippedStepsCount), 0, posY, 10, LIME);
+                posY += 10;
+            }
+            DrawText(TextFormat("TELEMETRY: %u RECORDS %u DROPPED", GetTelemetryRecordsCount(), GetTelemetryDroppedCount()), 0, posY, 10, LIME);
+            DrawProfilerOverlay(0, posY + 15);
         }
+
+        // NOTE: Batch is flushed here so composite time includes its submission, not the buffers swap
+        CountRenderBatch();
+        rlDrawRenderBatchActive();
+
+        EndBenchPhase(BENCH_PHASE_COMPOSITE);
     EndDrawing();
+
+    EndBenchPhase(BENCH_PHASE_PRESENT);
+    if (benchFramesCount > 0) benchFrameId += 1;
+
+    RecordTelemetryFrame(GetGameTick(), (unsigned long long)(telemetryTime*1e6), profilerPhaseSeconds[profilerFrameId], BENCH_PHASES_COUNT);
+
+    profilerFrameId = (profilerFrameId + 1)%PROFILER_FRAMES_COUNT;
+    prevRenderStats = renderStats;
+    renderStats = (struct RenderStats){ 0 };
     //----------------------------------------------------------------------------------  
 }
 
-void ResetPlayer(struct Player *player)
+// Sample the keyboard into an input frame for the game simulation
+struct InputFrame PollInputFrame(void)
 {
-    player->state = PLAYER_IDLE;
-    player->position = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
-    player->direction = (Vector2){ 0.0f, 0.0f };
-    player->speed = PLAYER_SPEED;
-    player->movementDurationSeconds = 0.0f;
-    player->isGrabbingStar = false;
-    player->grabbedStarX = -1;
-    player->grabbedStarY = -1;
-    player->flappingDurationSeconds = 0.0f;
-    player->flappingUp = true;
-    player->isFacingRight = false;
+    struct InputFrame input = { 0 };
+
+    if (IsKeyDown(KEY_LEFT)) input.buttons |= INPUT_BUTTON_LEFT;
+    if (IsKeyDown(KEY_RIGHT)) input.buttons |= INPUT_BUTTON_RIGHT;
+    if (IsKeyDown(KEY_UP)) input.buttons |= INPUT_BUTTON_UP;
+    if (IsKeyDown(KEY_DOWN)) input.buttons |= INPUT_BUTTON_DOWN;
+    if (IsKeyDown(KEY_LEFT_SHIFT)) input.buttons |= INPUT_BUTTON_BOOST;
+    if (IsKeyPressed(KEY_SPACE)) input.buttons |= INPUT_BUTTON_GRAB;
+    if (IsKeyPressed(KEY_R)) input.buttons |= INPUT_BUTTON_RESTART;
+    if (IsKeyPressed(KEY_F3)) input.buttons |= INPUT_BUTTON_DEBUG;
+
+    return input;
 }
 
-void ResetCamera(Camera2D *camera, struct Player *player)
+#if !defined(PLATFORM_WEB)
+// Save the snapshot ring when the game crashes, then crash as it would have
+// NOTE: Not async-signal-safe (stdio), it is a best effort dump of a process about to die
+void SaveCrashSnapshots(int signalId)
 {
-    camera->target = player->position;
-    camera->offset = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
-    camera->rotation = 0.0f;
-    camera->zoom = 1.0f;
+    signal(signalId, SIG_DFL);
+    SaveSnapshotRing("crash_snapshots.sfsr", &snapshotRing);
+    raise(signalId);
 }
+#endif
 
-void ResetConstellations(void)
+// Get ticks played by the current game, the last tick captured in the snapshot ring
+int GetGameTick(void)
 {
-    for (int i = 0; i < numberOfConstellations; i += 1)
-    {
-        struct Constellation *constellation = &constellations[i];
-        for (int j = 0; j < constellation->count; j += 1)
-        {
-            if (constellation->bridges[j].state == BRIDGE_ON)
-            {
-                constellation->bridges[j].state = BRIDGE_OFF_DEFAULT;
-            }
-        }
-    }
+    return snapshotRing.snapshots[snapshotRing.lastId].tick;
 }
 
-void ResetGameState(struct GameState *gameState)
+// Get input frame of the benchmark scripted input track
+// NOTE: Walks the 8 directions in turn, boosting, grabbing stars and restarting periodically
+struct InputFrame GetBenchInputFrame(int frame)
 {
-    gameState->state = GAMESTATE_START;
-    gameState->clockSeconds = 0.0f;
-    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
-    {
-        gameState->stages[i] = (struct GameStateStage){ -1, 0, 0.0f };
-    }
-    gameState->stageId = 0;
+    const unsigned int directions[8] = {
+        INPUT_BUTTON_RIGHT, INPUT_BUTTON_RIGHT | INPUT_BUTTON_DOWN,
+        INPUT_BUTTON_DOWN, INPUT_BUTTON_DOWN | INPUT_BUTTON_LEFT,
+        INPUT_BUTTON_LEFT, INPUT_BUTTON_LEFT | INPUT_BUTTON_UP,
+        INPUT_BUTTON_UP, INPUT_BUTTON_UP | INPUT_BUTTON_RIGHT
+    };
+
+    struct InputFrame input = { directions[(frame/90)%8] };
+    if (frame%120 == 60) input.buttons |= INPUT_BUTTON_BOOST;
+    if (frame%20 == 0) input.buttons |= INPUT_BUTTON_GRAB;
+    if (frame%600 == 0) input.buttons |= INPUT_BUTTON_RESTART;
+
+    return input;
 }
 
-int GetRandomNewConstellationId(struct GameState *gameState)
+// Store the time of a phase of the current frame, for the profiler and the benchmark, next phase starts now
+// NOTE: Times are CPU times, including draw calls submission (batches are flushed on texture mode end)
+void EndBenchPhase(enum BenchPhase phase)
 {
-    bool cond = false;
-    int randId = -1;
-    do
-    {
-        randId = GetRandomValue(0, numberOfConstellations - 1);
-        cond = false;
-        for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
-        {
-            if (randId == gameState->stages[i].constellationId)
-            {
-                cond = true;
-                break;
-            }
-        }
-    } while (cond);
-    if (debugMode)
-    {
-        LOG("RANDOM CONSTELLATION: %i\n", randId);
-    }
-    return randId;
+    const double time = GetTime();
+    profilerPhaseSeconds[profilerFrameId][phase] = time - phaseStartTime;
+    if (benchFramesCount > 0) benchPhaseSeconds[BENCH_PHASES_COUNT*benchFrameId + phase] = time - phaseStartTime;
+    phaseStartTime = time;
 }
 
-void MovePlayer(struct Player *player, float deltaTime)
+int CompareDoubles(const void *a, const void *b)
 {
-    player->position.x += player->direction.x*player->speed*deltaTime;
-    player->position.y += player->direction.y*player->speed*deltaTime;
+    const double x = *(const double *)a;
+    const double y = *(const double *)b;
+    return (x > y) - (x < y);
+}
 
-    // The positions of the first and the last stars
-    // are used to determine the "walls" of the screen.
-    const Vector2 firstStar = GetStarPosition(0, 0);
-    const Vector2 lastStar = GetStarPosition(STAR_COUNT_X - 1, STAR_COUNT_Y - 1);
+// Print min, median, p99 and max time of every benchmark phase, as JSON (milliseconds)
+void PrintBenchReport(void)
+{
+    const char *phaseNames[BENCH_PHASES_COUNT] = { "update", "main_render", "minimap", "composite", "present" };
 
-    if (player->position.x < firstStar.x)
-    {
-        player->position.x = firstStar.x;
-    } else if (player->position.x > lastStar.x)
+    const int framesCount = benchFrameId;
+    double *seconds = (double *)malloc((framesCount + 1)*sizeof(double));
+    if (seconds == NULL) return;
+    seconds[0] = 0.0;
+
+    printf("{\"frames\": %i, \"unit\": \"ms\", \"phases\": {", framesCount);
+    for (int phase = 0; phase < BENCH_PHASES_COUNT; phase += 1)
     {
-        player->position.x = lastStar.x;
+        for (int i = 0; i < framesCount; i += 1) seconds[i] = benchPhaseSeconds[BENCH_PHASES_COUNT*i + phase];
+        qsort(seconds, framesCount, sizeof(double), CompareDoubles);
+
+        // Nearest rank percentile
+        const int p99Id = (framesCount > 0)? (99*framesCount + 99)/100 - 1 : 0;
+        const int maxId = (framesCount > 0)? framesCount - 1 : 0;
+        printf("%s\"%s\": {\"min\": %.4f, \"median\": %.4f, \"p99\": %.4f, \"max\": %.4f}",
+               (phase > 0)? ", " : "", phaseNames[phase],
+               1000.0*seconds[0], 1000.0*seconds[framesCount/2], 1000.0*seconds[p99Id], 1000.0*seconds[maxId]);
     }
+    printf("}}\n");
 
-    if (player->position.y < firstStar.y)
-    {
-        player->position.y = firstStar.y;
-    } else if (player->position.y > lastStar.y)
+    free(seconds);
+}
+
+// Add the draw work queued in the render batch to the frame stats
+// NOTE: Must be called right before every batch flush (raylib flushes on texture mode, 2D mode and drawing end),
+// flushes done by rlgl itself when the batch is full are not seen, CheckRenderBatchLimit() flushes ahead of them
+void CountRenderBatch(void)
+{
+    unsigned int textureId = 0;         // Textures are unbound after every batch flush
+    int vertices = 0;
+    for (int i = 0; i < renderBatch.drawCounter; i += 1)
     {
-        player->position.y = lastStar.y;
+        const rlDrawCall *draw = &renderBatch.draws[i];
+        if (draw->vertexCount == 0) continue;
+
+        renderStats.drawCalls += 1;
+        if (draw->textureId != textureId) renderStats.textureBinds += 1;
+        textureId = draw->textureId;
+        vertices += draw->vertexCount;
     }
+
+    if (vertices > 0) renderStats.batches += 1;
+    renderStats.vertices += vertices;
 }
 
-void UpdatePlayer(struct Player *player, float deltaTime)
+// Draw phase times (mean and max of the last frames), last frame draw work and the frame-time graph
+void DrawProfilerOverlay(int posX, int posY)
 {
-    player->movementDurationSeconds += deltaTime;
+    const char *phaseNames[BENCH_PHASES_COUNT] = { "UPDATE", "MAIN RENDER", "MINIMAP", "COMPOSITE", "PRESENT" };
+    const Color phaseColors[BENCH_PHASES_COUNT] = { SKYBLUE, LIME, ORANGE, PINK, GRAY };
+    const int lineHeight = 10;
+    const int graphPosY = posY + lineHeight*(BENCH_PHASES_COUNT + 2) + 5;
 
-    switch (player->state)
+    DrawRectangle(posX, posY, PROFILER_FRAMES_COUNT + 10, graphPosY + PROFILER_GRAPH_HEIGHT_PIXELS + 5 - posY, Fade(BLACK, 0.6f));
+
+    for (int phase = 0; phase < BENCH_PHASES_COUNT; phase += 1)
     {
-        case PLAYER_STUNNED:
+        double sumSeconds = 0.0;
+        double maxSeconds = 0.0;
+        for (int i = 0; i < PROFILER_FRAMES_COUNT; i += 1)
         {
-            if (player->movementDurationSeconds >= PLAYER_STUN_COOLDOWN_SECONDS)
-            {
-                player->movementDurationSeconds = 0.0f;
-                player->state = PLAYER_IDLE;
-            }
-        } break;
-        case PLAYER_IDLE:
-        {
-            player->direction.x = 0;
-            player->direction.y = 0;
+            // NOTE: Current frame is not complete yet
+            if (i == profilerFrameId) continue;
 
-            if (IsKeyDown(KEY_LEFT)) player->direction.x -= 1;
-            if (IsKeyDown(KEY_RIGHT)) player->direction.x += 1;
-            if (IsKeyDown(KEY_UP)) player->direction.y -= 1;
-            if (IsKeyDown(KEY_DOWN)) player->direction.y += 1;
+            const double seconds = profilerPhaseSeconds[i][phase];
+            sumSeconds += seconds;
+            if (seconds > maxSeconds) maxSeconds = seconds;
+        }
 
-            if (player->direction.x < 0)
-            {
-                player->isFacingRight = false;
-            } else if (player->direction.x > 0)
-            {
-                player->isFacingRight = true;
-            }
+        DrawText(TextFormat("%s %.2f MS (MAX %.2f)", phaseNames[phase], 1000.0*sumSeconds/(PROFILER_FRAMES_COUNT - 1), 1000.0*maxSeconds),
+                 posX + 5, posY + lineHeight*phase, 10, phaseColors[phase]);
+    }
 
-            if (IsKeyDown(KEY_LEFT_SHIFT))
-            {
-                player->speed += PLAYER_BOOST;
-                player->movementDurationSeconds = 0.0f;
-                player->state = PLAYER_JUMPING;
-            }
+    DrawText(TextFormat("DRAWS %i BATCHES %i VERTS %i", prevRenderStats.drawCalls, prevRenderStats.batches, prevRenderStats.vertices),
+             posX + 5, posY + lineHeight*BENCH_PHASES_COUNT, 10, LIME);
+    DrawText(TextFormat("BINDS %i SPRITES %i", prevRenderStats.textureBinds, prevRenderStats.sprites),
+             posX + 5, posY + lineHeight*(BENCH_PHASES_COUNT + 1), 10, LIME);
 
-            MovePlayer(player, deltaTime);
-        } break;
-        case PLAYER_JUMPING:
+    // Frame-time graph, oldest frame on the left, phases stacked from the bottom
+    const float pixelsPerSecond = PROFILER_GRAPH_HEIGHT_PIXELS/PROFILER_GRAPH_MAX_SECONDS;
+    const float graphBottom = (float)(graphPosY + PROFILER_GRAPH_HEIGHT_PIXELS);
+    for (int i = 1; i < PROFILER_FRAMES_COUNT; i += 1)
+    {
+        const int frameId = (profilerFrameId + i)%PROFILER_FRAMES_COUNT;
+        float height = 0.0f;
+        for (int phase = 0; (phase < BENCH_PHASES_COUNT) && (height < PROFILER_GRAPH_HEIGHT_PIXELS); phase += 1)
         {
-            // Note that the direction cannot change while jumping.
-            // This is a way to nerf the jump mechanic.
+            float phaseHeight = (float)profilerPhaseSeconds[frameId][phase]*pixelsPerSecond;
+            if (height + phaseHeight > PROFILER_GRAPH_HEIGHT_PIXELS) phaseHeight = PROFILER_GRAPH_HEIGHT_PIXELS - height;
 
-            if (player->movementDurationSeconds >= PLAYER_JUMP_COOLDOWN_SECONDS)
-            {
-                player->speed -= PLAYER_BOOST;
-                player->movementDurationSeconds = 0.0f;
-                player->state = PLAYER_IDLE;
-            }
-
-            MovePlayer(player, deltaTime);
-        } break;
+            DrawRectangleRec((Rectangle){ (float)(posX + 5 + i), graphBottom - height - phaseHeight, 1.0f, phaseHeight }, phaseColors[phase]);
+            height += phaseHeight;
+        }
     }
+
+    // Fixed tick time reference line
+    const float tickPosY = graphBottom - GAME_TICK_SECONDS*pixelsPerSecond;
+    DrawLineEx((Vector2){ (float)(posX + 5), tickPosY }, (Vector2){ (float)(posX + 5 + PROFILER_FRAMES_COUNT), tickPosY }, 1.0f, WHITE);
 }
 
-// TODO: Study this...
-void UpdateCameraCenterSmoothFollow(Camera2D *camera, struct Player *player, float delta)
+void DrawSprite(int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position, Color tint)
 {
-    static float minSpeed = 30;
-    static float minEffectLength = 10;
-    static float fractionSpeed = 0.8f;
+    CheckRenderBatchLimit(4);
+    renderStats.sprites += 1;
 
-    camera->offset = (Vector2){ SCREEN_WIDTH_PIXELS/2.0f, SCREEN_HEIGHT_PIXELS/2.0f };
-    Vector2 diff = Vector2Subtract(player->position, camera->target);
-    float length = Vector2Length(diff);
+    Rectangle source = { spriteOffsetX, spriteOffsetY, spriteWidth, spriteHeight };
+    Rectangle dest = { position.x, position.y, spriteWidth, spriteHeight };
+
+    source.x += frameNumber*spriteWidth;
 
-    if (length > minEffectLength)
+    DrawTexturePro(spritesheet, source, dest, (Vector2){ spriteWidth/2.0f, spriteHeight/2.0f }, 0.0f, tint);
+}
+
+void DrawStar(int x, int y, int frameNumber)
+{
+    const Vector2 position = GetStarPosition(x, y);
+
+    DrawSprite(SPRITESHEET_STAR_OFFSET_X_PIXELS, SPRITESHEET_STAR_OFFSET_Y_PIXELS,
+               STAR_SPRITE_WIDTH_PIXELS, STAR_SPRITE_HEIGHT_PIXELS,
+               frameNumber,
+               position,
+               WHITE);
+
+    if (debugMode)
     {
-        float speed = fmaxf(fractionSpeed*length, minSpeed);
-        camera->target = Vector2Add(camera->target, Vector2Scale(diff, speed*delta/length));
+        const Rectangle rec = GetStarRec(position);
+        DrawRectangleLinesEx(rec, 1.0f, RED);
     }
 }
 
-void InteractPlayerAndStars(struct GameState *gameState, struct Player *player, int constellationId)
+// Get the font rasterized at a size, so text is drawn 1:1 (next bigger size scaled down if not in FONT_SIZES)
+Font GetFont(int fontSize)
 {
-    if ((player->state == PLAYER_STUNNED) || !IsKeyPressed(KEY_SPACE))
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
     {
-           return;
+        if (fontSizes[i] >= fontSize) return fonts[i];
     }
+    return fonts[FONT_SIZES_COUNT - 1];
+}
 
-    const Rectangle playerRec = GetPlayerRec(player->position);
-
-    int closestStarX = lrintf(player->position.x/(float)STAR_SPACING_PIXELS);
-    int closestStarY = lrintf(player->position.y/(float)STAR_SPACING_PIXELS);
+// Get world rectangle shown by a camera, grown by the culling margin
+// NOTE: Camera rotation is not used by the game
+Rectangle GetCameraViewRec(Camera2D camera)
+{
+    Rectangle view = { 0 };
+    view.x = camera.target.x - camera.offset.x/camera.zoom - VIEW_CULL_MARGIN_PIXELS;
+    view.y = camera.target.y - camera.offset.y/camera.zoom - VIEW_CULL_MARGIN_PIXELS;
+    view.width = SCREEN_WIDTH_PIXELS/camera.zoom + 2*VIEW_CULL_MARGIN_PIXELS;
+    view.height = SCREEN_HEIGHT_PIXELS/camera.zoom + 2*VIEW_CULL_MARGIN_PIXELS;
+    return view;
+}
 
-    const Vector2 closestStarPos = GetStarPosition(closestStarX, closestStarY);
-    const Rectangle closestStarRec = GetStarRec(closestStarPos);
+// Draw grid lines every spacingPixels, only the ones crossing the view
+void DrawDebugGrid(int spacingPixels, Rectangle view)
+{
+    const int firstX = (int)ceilf(view.x/spacingPixels);
+    const int lastX = (int)floorf((view.x + view.width)/spacingPixels);
+    const int firstY = (int)ceilf(view.y/spacingPixels);
+    const int lastY = (int)floorf((view.y + view.height)/spacingPixels);
 
-    if (!CheckCollisionRecs(playerRec, closestStarRec))
+    for (int x = firstX; x <= lastX; x += 1)
     {
-        return;
+        DrawLineV((Vector2){ (float)(x*spacingPixels), view.y }, (Vector2){ (float)(x*spacingPixels), view.y + view.height }, LIGHTGRAY);
     }
+    for (int y = firstY; y <= lastY; y += 1)
+    {
+        DrawLineV((Vector2){ view.x, (float)(y*spacingPixels) }, (Vector2){ view.x + view.width, (float)(y*spacingPixels) }, LIGHTGRAY);
+    }
+}
 
-    if (player->isGrabbingStar)
+// Render a tile of OFF stars into the star field layer, only if the debug overlay changed
+// NOTE: The star field never changes during a stage, drawing the stars in view becomes a single textured quad
+void UpdateStarFieldRender(void)
+{
+    if ((starFieldRender.id != 0) && (starFieldDebugMode == debugMode)) return;
+
+    if (starFieldRender.id == 0)
     {
-        if ((player->grabbedStarX == closestStarX) && (player->grabbedStarY == closestStarY))
+        // Layer covers the star sprites centered at the first and the last star positions of the tile
+        starFieldRender = LoadRenderTexture((STAR_FIELD_TILE_STARS - 1)*STAR_SPACING_PIXELS + STAR_SPRITE_WIDTH_PIXELS,
+                                            (STAR_FIELD_TILE_STARS - 1)*STAR_SPACING_PIXELS + STAR_SPRITE_HEIGHT_PIXELS);
+    }
+    starFieldDebugMode = debugMode;
+
+    BeginTextureMode(starFieldRender);
+        ClearBackground(BLANK);
+
+        rlPushMatrix();
+        rlTranslatef(STAR_SPRITE_WIDTH_PIXELS/2.0f, STAR_SPRITE_HEIGHT_PIXELS/2.0f, 0);
+        for (int y = 0; y < STAR_FIELD_TILE_STARS; y += 1)
         {
-            // Do not allow to "drop" a grabbed star onto itself
-            return;
+            for (int x = 0; x < STAR_FIELD_TILE_STARS; x += 1)
+            {
+                DrawStar(x, y, STAR_SPRITE_OFF);
+            }
         }
+        rlPopMatrix();
+    CountRenderBatch();
+    EndTextureMode();
+}
 
-        const int constellationBridgeId = GetConstellationBridgeIndex(constellationId,
-                                                                      player->grabbedStarX, player->grabbedStarY,
-                                                                      closestStarX, closestStarY);
-        if ((constellationBridgeId == -1) || (constellations[constellationId].bridges[constellationBridgeId].state) != BRIDGE_OFF_DEFAULT)
-        {
-            player->movementDurationSeconds = 0.0f;
-            player->state = PLAYER_STUNNED;
-        } else
+// Draw the stars in view, clamped to the star field, as sub-rectangles of the star field layer
+// NOTE: Cost depends on the view size only, one quad per tile (usually a single one)
+void DrawStars(Rectangle view)
+{
+    const struct ConstellationPack *pack = GetConstellationPack();
+    const int firstX = (view.x > 0.0f)? (int)ceilf(view.x/STAR_SPACING_PIXELS) : 0;
+    const int firstY = (view.y > 0.0f)? (int)ceilf(view.y/STAR_SPACING_PIXELS) : 0;
+    int lastX = (int)floorf((view.x + view.width)/STAR_SPACING_PIXELS);
+    int lastY = (int)floorf((view.y + view.height)/STAR_SPACING_PIXELS);
+    if (lastX > pack->starCountX - 1) lastX = pack->starCountX - 1;
+    if (lastY > pack->starCountY - 1) lastY = pack->starCountY - 1;
+
+    const float textureHeight = (float)starFieldRender.texture.height;
+    for (int tileY = firstY; tileY <= lastY; tileY += STAR_FIELD_TILE_STARS)
+    {
+        for (int tileX = firstX; tileX <= lastX; tileX += STAR_FIELD_TILE_STARS)
         {
-            constellations[constellationId].bridges[constellationBridgeId].state = BRIDGE_ON;
-            gameState->stages[gameState->stageId].score += 1;
+            const int countX = (lastX - tileX + 1 < STAR_FIELD_TILE_STARS)? lastX - tileX + 1 : STAR_FIELD_TILE_STARS;
+            const int countY = (lastY - tileY + 1 < STAR_FIELD_TILE_STARS)? lastY - tileY + 1 : STAR_FIELD_TILE_STARS;
+            const float width = (float)((countX - 1)*STAR_SPACING_PIXELS + STAR_SPRITE_WIDTH_PIXELS);
+            const float height = (float)((countY - 1)*STAR_SPACING_PIXELS + STAR_SPRITE_HEIGHT_PIXELS);
+            const Vector2 position = GetStarPosition(tileX, tileY);
+
+            // NOTE: Render texture is flipped vertically, the top rows drawn are the last ones and height must be negative
+            DrawTextureRec(starFieldRender.texture,
+                           (Rectangle){ 0, textureHeight - height, width, -height },
+                           (Vector2){ position.x - STAR_SPRITE_WIDTH_PIXELS/2.0f, position.y - STAR_SPRITE_HEIGHT_PIXELS/2.0f },
+                           WHITE);
         }
-        player->grabbedStarX = -1;
-        player->grabbedStarY = -1;
-        player->isGrabbingStar = false;
-    } else
-    {
-        player->grabbedStarX = closestStarX;
-        player->grabbedStarY = closestStarY;
-        player->isGrabbingStar = true;
     }
 }
 
-int GetConstellationRequiredScore(int constellationId)
+// Patch the lit bridges geometry to the bridges lit in the game, only if they changed
+void UpdateBridgeGeometry(const struct GameInstance *game)
 {
-    struct Constellation *constellation = &constellations[constellationId];
-    int requiredScore = constellation->count - constellation->startingScore;
-    return requiredScore;
-}
+    const int constellationId = game->gameState.stages[game->gameState.stageId].constellationId;
+    if (bridgeGeometryValid &&
+        (bridgeGeometryConstellationId == constellationId) &&
+        (bridgeGeometryVersion == game->bridgesVersion))
+    {
+        return;
+    }
 
-Vector2 GetStarPosition(int x, int y)
-{
-    Vector2 position = { x*STAR_SPACING_PIXELS, y*STAR_SPACING_PIXELS };
-    return position;
-}
+    // Bridges only turn off on stage reset, geometry is rebuilt from the default lit bridges then
+    bool rebuild = !bridgeGeometryValid || (bridgeGeometryConstellationId != constellationId);
+    for (int i = 0; (i < GAME_LIT_BRIDGES_WORDS) && !rebuild; i += 1)
+    {
+        if (bridgeGeometryLitBridges[i] & ~game->litBridges[i]) rebuild = true;
+    }
 
-Rectangle GetStarRec(Vector2 position)
-{
-    Rectangle starRec = { 0 };
-    starRec.x = position.x - (float)STAR_REC_WIDTH_PIXELS/2.0f;
-    starRec.y = position.y - (float)STAR_REC_HEIGHT_PIXELS/2.0f;
-    starRec.width = (float)STAR_REC_WIDTH_PIXELS;
-    starRec.height = (float)STAR_REC_HEIGHT_PIXELS;
-    return starRec;
-}
+    bridgeGeometryValid = true;
+    bridgeGeometryConstellationId = constellationId;
+    bridgeGeometryVersion = game->bridgesVersion;
 
-Rectangle GetPlayerRec(Vector2 position)
-{
-    Rectangle playerRec = { 0 };
-    playerRec.x = position.x - (float)PLAYER_REC_WIDTH_PIXELS/2.0f;
-    playerRec.y = position.y - (float)PLAYER_REC_HEIGHT_PIXELS/2.0f;
-    playerRec.width = (float)PLAYER_REC_WIDTH_PIXELS;
-    playerRec.height = (float)PLAYER_REC_HEIGHT_PIXELS;
-    return playerRec;
-}
+    struct ConstellationView constellation = { 0 };
+    const bool hasConstellation = GetGameConstellation(game, &constellation);
 
-int GetConstellationBridgeIndex(int constellationId, int x1, int y1, int x2, int y2)
-{
-    struct Constellation *constellation = &constellations[constellationId];
-    for (int i = 0; i < constellation->count; i += 1)
+    if (bridgeGridConstellationId != constellationId)
     {
-        const struct ConstellationBridge bridge = constellation->bridges[i];
-        if (
-            ((x1 == bridge.x1) && (y1 == bridge.y1) && (x2 == bridge.x2) && (y2 == bridge.y2))
-            ||
-            ((x2 == bridge.x1) && (y2 == bridge.y1) && (x1 == bridge.x2) && (y1 == bridge.y2))
-        )
+        UnloadBridgeGrid(&bridgeGrid);
+        bridgeGridConstellationId = constellationId;
+
+        // NOTE: Grid takes decoded bridges, packed bridges are only kept while building it
+        struct ConstellationBridge *bridges = hasConstellation? (struct ConstellationBridge *)malloc(constellation.bridgesCount*sizeof(struct ConstellationBridge)) : NULL;
+        if (bridges != NULL)
         {
-            return i;
+            for (int i = 0; i < constellation.bridgesCount; i += 1) bridges[i] = GetConstellationViewBridge(&constellation, i);
+            if (!LoadBridgeGrid(&bridgeGrid, bridges, constellation.bridgesCount)) LOG("BRIDGE GRID: Failed to build grid\n");
+            free(bridges);
         }
     }
-    return -1;
-}
 
-void DrawSprite(int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position)
-{
-    Rectangle source = { spriteOffsetX, spriteOffsetY, spriteWidth, spriteHeight };
-    Rectangle dest = { position.x, position.y, spriteWidth, spriteHeight };
+    if (rebuild)
+    {
+        bridgeGeometryCount = 0;
+        litStarsCount = 0;
+        memset(bridgeGeometryLitBridges, 0, sizeof(bridgeGeometryLitBridges));
+        memset(bridgeGeometryBridges, 0, sizeof(bridgeGeometryBridges));
+        memset(bridgeGeometryIds, 0xff, sizeof(bridgeGeometryIds));
 
-    source.x += frameNumber*spriteWidth;
+        for (int i = 0; hasConstellation && (i < constellation.bridgesCount); i += 1)
+        {
+            if (GetConstellationViewBridgeState(&constellation, i) == BRIDGE_ON_DEFAULT) AddBridgeGeometry(&constellation, i);
+        }
+    }
 
-    DrawTexturePro(spritesheet, source, dest, (Vector2){ spriteWidth/2.0f, spriteHeight/2.0f }, 0.0f, WHITE);
+    for (int i = 0; hasConstellation && (i < GAME_LIT_BRIDGES_WORDS); i += 1)
+    {
+        const unsigned int newBridges = game->litBridges[i] & ~bridgeGeometryLitBridges[i];
+        for (int bit = 0; (bit < 32) && (newBridges >> bit); bit += 1)
+        {
+            if (newBridges & (1u << bit)) AddBridgeGeometry(&constellation, 32*i + bit);
+        }
+        bridgeGeometryLitBridges[i] |= newBridges;
+    }
 }
 
-void DrawStar(int x, int y, int frameNumber)
+// Append a lit bridge line quad, and its stars if not lit yet
+// NOTE: A star is lit already if another bridge touching it is in the geometry, no per star state is kept
+void AddBridgeGeometry(const struct ConstellationView *constellation, int bridgeId)
 {
-    const Vector2 position = GetStarPosition(x, y);
+    const struct ConstellationBridge bridge = GetConstellationViewBridge(constellation, bridgeId);
+    const Vector2 star1Pos = GetStarPosition(bridge.x1, bridge.y1);
+    const Vector2 star2Pos = GetStarPosition(bridge.x2, bridge.y2);
+
+    // Same corners as raylib DrawLineEx()
+    const Vector2 normal = Vector2Scale(Vector2Normalize((Vector2){ star1Pos.y - star2Pos.y, star2Pos.x - star1Pos.x }),
+                                        CONSTELLATION_BRIDGE_LINE_THICKNESS/2.0f);
+    bridgeLines[2*bridgeGeometryCount] = star1Pos;
+    bridgeLines[2*bridgeGeometryCount + 1] = star2Pos;
+    bridgeQuads[4*bridgeGeometryCount] = Vector2Subtract(star1Pos, normal);
+    bridgeQuads[4*bridgeGeometryCount + 1] = Vector2Add(star1Pos, normal);
+    bridgeQuads[4*bridgeGeometryCount + 2] = Vector2Add(star2Pos, normal);
+    bridgeQuads[4*bridgeGeometryCount + 3] = Vector2Subtract(star2Pos, normal);
+    bridgeGeometryStarIds[2*bridgeGeometryCount] = -1;
+    bridgeGeometryStarIds[2*bridgeGeometryCount + 1] = -1;
+    bridgeGeometryIds[bridgeId] = bridgeGeometryCount;
+
+    const int starsX[2] = { bridge.x1, bridge.x2 };
+    const int starsY[2] = { bridge.y1, bridge.y2 };
+    const Vector2 positions[2] = { star1Pos, star2Pos };
+    for (int i = 0; i < 2; i += 1)
+    {
+        if ((i == 1) && (starsX[1] == starsX[0]) && (starsY[1] == starsY[0])) break;
 
-    DrawSprite(SPRITESHEET_STAR_OFFSET_X_PIXELS, SPRITESHEET_STAR_OFFSET_Y_PIXELS,
-               STAR_SPRITE_WIDTH_PIXELS, STAR_SPRITE_HEIGHT_PIXELS,
-               frameNumber,
-               position);
+        const int *bridgeIds = NULL;
+        const int count = GetStarBridges(&constellation->index, starsX[i], starsY[i], &bridgeIds);
 
-    if (debugMode)
-    {
-        const Rectangle rec = GetStarRec(position);
-        DrawRectangleLinesEx(rec, 1.0f, RED);
+        bool isLit = false;
+        for (int k = 0; (k < count) && !isLit; k += 1) isLit = (bridgeGeometryBridges[bridgeIds[k]/32] & (1u << (bridgeIds[k]%32))) != 0;
+
+        if (!isLit)
+        {
+            bridgeGeometryStarIds[2*bridgeGeometryCount + i] = litStarsCount;
+            litStarPositions[litStarsCount++] = positions[i];
+        }
     }
+    bridgeGeometryBridges[bridgeId/32] |= (1u << (bridgeId%32));
+    bridgeGeometryCount += 1;
 }
 
-void DrawDebugGrid(int spacingPixels)
+// Flush the render batch if it can not take a draw call of verticesCount more vertices, so rlgl never flushes on its own
+// NOTE: Flushes done here are counted by the profiler, leaves room for a debug shape drawn with another texture
+void CheckRenderBatchLimit(int verticesCount)
 {
-    rlPushMatrix();
-    rlTranslatef(0, 25*spacingPixels, 0);
-    rlRotatef(90, 1, 0, 0);
-    DrawGrid(100, spacingPixels);
-    rlPopMatrix();
-}
+    int usedVertices = 0;
+    for (int i = 0; i < renderBatch.drawCounter; i += 1) usedVertices += renderBatch.draws[i].vertexCount + renderBatch.draws[i].vertexAlignment;
 
-void DrawStars(void)
-{
-    for (int y = 0; y < STAR_COUNT_Y; y += 1)
+    if ((renderBatch.drawCounter >= RL_DEFAULT_BATCH_DRAWCALLS - 2) ||
+        (usedVertices + verticesCount + 4 >= 4*renderBatch.vertexBuffer[renderBatch.currentBuffer].elementCount))
     {
-        for (int x = 0; x < STAR_COUNT_X; x += 1)
-        {
-            DrawStar(x, y, STAR_SPRITE_OFF);
-        }
+        CountRenderBatch();
+        rlDrawRenderBatchActive();
     }
 }
 
-void DrawBridges(int constellationId)
+// Draw lit bridges in view from their geometry: every line, then every lit star once, in a single batch
+void DrawBridges(const struct GameInstance *game, Rectangle view)
 {
-    struct Constellation *constellation = &constellations[constellationId];
-    for (int i = 0; i < constellation->count; i += 1)
+    UpdateBridgeGeometry(game);
+
+    // NOTE: View already includes the line thickness and the star sprites margin.
+    // A lit star in view is an end of a bridge crossing the view, only the stars of those bridges are tested
+    const int queryCount = GetBridgesInRec(&bridgeGrid, view.x/STAR_SPACING_PIXELS, view.y/STAR_SPACING_PIXELS,
+                                           view.width/STAR_SPACING_PIXELS, view.height/STAR_SPACING_PIXELS, bridgeGridIds, GAME_MAX_BRIDGES_COUNT);
+    int visibleBridgesCount = 0;
+    int visibleLitStarsCount = 0;
+    for (int i = 0; i < queryCount; i += 1)
     {
-        const struct ConstellationBridge bridge = constellation->bridges[i];
-        if ((bridge.state == BRIDGE_ON) || (bridge.state == BRIDGE_ON_DEFAULT))
+        const int geometryId = bridgeGeometryIds[bridgeGridIds[i]];
+        if (geometryId == -1) continue;
+
+        visibleBridgeIds[visibleBridgesCount++] = geometryId;
+        for (int k = 0; k < 2; k += 1)
         {
-            const Vector2 star1Pos = GetStarPosition(bridge.x1, bridge.y1);
-            const Vector2 star2Pos = GetStarPosition(bridge.x2, bridge.y2);
+            const int starId = bridgeGeometryStarIds[2*geometryId + k];
+            if ((starId != -1) && CheckCollisionPointRec(litStarPositions[starId], view)) visibleLitStarIds[visibleLitStarsCount++] = starId;
+        }
+    }
+    if ((visibleBridgesCount == 0) && (visibleLitStarsCount == 0)) return;
 
-            // TODO: Bridge sprite?
-            DrawLineEx(star1Pos, star2Pos, CONSTELLATION_BRIDGE_LINE_THICKNESS, palette[0]);
+    CheckRenderBatchLimit(4*(visibleBridgesCount + visibleLitStarsCount));
 
-            if (debugMode)
+    const Color lineColor = palette[0];
+    rlSetTexture(rlGetTextureIdDefault());
+    rlBegin(RL_QUADS);
+        rlColor4ub(lineColor.r, lineColor.g, lineColor.b, lineColor.a);
+        for (int i = 0; i < visibleBridgesCount; i += 1)
+        {
+            const Vector2 *quad = &bridgeQuads[4*visibleBridgeIds[i]];
+            for (int k = 0; k < 4; k += 1)
             {
-                DrawLineEx(star1Pos, star2Pos, 1.0f, RED);
+                rlTexCoord2f(0.0f, 0.0f);
+                rlVertex2f(quad[k].x, quad[k].y);
             }
         }
+    rlEnd();
+
+    // Same quads as DrawSprite() of the ON star frame
+    const float texLeft = (float)(SPRITESHEET_STAR_OFFSET_X_PIXELS + STAR_SPRITE_ON*STAR_SPRITE_WIDTH_PIXELS)/spritesheet.width;
+    const float texRight = texLeft + (float)STAR_SPRITE_WIDTH_PIXELS/spritesheet.width;
+    const float texTop = (float)SPRITESHEET_STAR_OFFSET_Y_PIXELS/spritesheet.height;
+    const float texBottom = texTop + (float)STAR_SPRITE_HEIGHT_PIXELS/spritesheet.height;
+    rlSetTexture(spritesheet.id);
+    rlBegin(RL_QUADS);
+        rlColor4ub(255, 255, 255, 255);
+        for (int i = 0; i < visibleLitStarsCount; i += 1)
+        {
+            const Vector2 position = litStarPositions[visibleLitStarIds[i]];
+            const float left = position.x - STAR_SPRITE_WIDTH_PIXELS/2.0f;
+            const float top = position.y - STAR_SPRITE_HEIGHT_PIXELS/2.0f;
+
+            rlTexCoord2f(texLeft, texTop);
+            rlVertex2f(left, top);
+            rlTexCoord2f(texLeft, texBottom);
+            rlVertex2f(left, top + STAR_SPRITE_HEIGHT_PIXELS);
+            rlTexCoord2f(texRight, texBottom);
+            rlVertex2f(left + STAR_SPRITE_WIDTH_PIXELS, top + STAR_SPRITE_HEIGHT_PIXELS);
+            rlTexCoord2f(texRight, texTop);
+            rlVertex2f(left + STAR_SPRITE_WIDTH_PIXELS, top);
+        }
+    rlEnd();
+    rlSetTexture(0);
+
+    if (debugMode)
+    {
+        for (int i = 0; i < visibleBridgesCount; i += 1) DrawLineEx(bridgeLines[2*visibleBridgeIds[i]], bridgeLines[2*visibleBridgeIds[i] + 1], 1.0f, RED);
+        for (int i = 0; i < visibleLitStarsCount; i += 1) DrawRectangleLinesEx(GetStarRec(litStarPositions[visibleLitStarIds[i]]), 1.0f, RED);
     }
+}
 
-    for (int i = 0; i < constellation->count; i += 1)
+// Draw bridges under the frog (debug mode), lit or not, from the bridge grid of the constellation
+void DrawHoveredBridges(const struct GameInstance *game, Vector2 position)
+{
+    UpdateBridgeGeometry(game);
+
+    struct ConstellationView constellation = { 0 };
+    if (!GetGameConstellation(game, &constellation)) return;
+
+    const int count = GetBridgesNearPoint(&bridgeGrid, position.x/STAR_SPACING_PIXELS, position.y/STAR_SPACING_PIXELS,
+                                          HOVER_DISTANCE_STARS, bridgeGridIds, GAME_MAX_BRIDGES_COUNT);
+    for (int i = 0; i < count; i += 1)
     {
-        const struct ConstellationBridge bridge = constellation->bridges[i];
-        if ((bridge.state == BRIDGE_ON) || (bridge.state == BRIDGE_ON_DEFAULT))
-        {
-            // NOTE: Stars might be drawn on top of themselves more than once
-            // TODO: Does this cause significant performance issues?
-            DrawStar(bridge.x1, bridge.y1, STAR_SPRITE_ON);
-            DrawStar(bridge.x2, bridge.y2, STAR_SPRITE_ON);
-        }
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(&constellation, bridgeGridIds[i]);
+        DrawLineEx(GetStarPosition(bridge.x1, bridge.y1), GetStarPosition(bridge.x2, bridge.y2), 1.0f, PURPLE);
     }
 }
 
-void DrawPlayer(struct Player *player, float deltaTime)
+void DrawPlayer(const struct Player *player, Vector2 position, Color tint)
 {
     if (player->isGrabbingStar)
     {
         // Draw dragged bridge
         const Vector2 grabbedStarPos = GetStarPosition(player->grabbedStarX, player->grabbedStarY);
         DrawLineEx(grabbedStarPos,
-                   Vector2Add(player->position, (Vector2){ 0, 10 }),
+                   Vector2Add(position, (Vector2){ 0, 10 }),
                    CONSTELLATION_BRIDGE_LINE_THICKNESS,
-                   palette[0]);
+                   Fade(palette[0], tint.a/255.0f));
 
         if (debugMode)
         {
-            DrawLineEx(grabbedStarPos, player->position, 1.0f, PURPLE);
+            DrawLineEx(grabbedStarPos, position, 1.0f, PURPLE);
         }
 
         // Draw star at beginning of path
         DrawStar(player->grabbedStarX, player->grabbedStarY, 1);
     }
 
-    player->flappingDurationSeconds += deltaTime;
-    if (player->flappingDurationSeconds >= PLAYER_FLAPPING_DURATION_SECONDS)
-    {
-        player->flappingDurationSeconds = 0.0f;
-        player->flappingUp = !player->flappingUp;
-    }
-
     int spriteOffsetX = SPRITESHEET_FROG_OFFSET_X_PIXELS;
     switch (player->state)
     {
@@ -1261,11 +1444,12 @@ void DrawPlayer(struct Player *player, float deltaTime)
     DrawSprite(spriteOffsetX, spriteOffsetY,
                PLAYER_SPRITE_WIDTH_PIXELS, PLAYER_SPRITE_HEIGHT_PIXELS,
                0,
-               player->position);
+               position,
+               tint);
 
     if (debugMode)
     {
-        Rectangle playerRec = GetPlayerRec(player->position);
+        Rectangle playerRec = GetPlayerRec(position);
         // TODO:
         Color color;
         switch (player->state)
@@ -1287,6 +1471,84 @@ void DrawPlayer(struct Player *player, float deltaTime)
     }
 }
 
+// Draw the frogs inside the camera view, every frog a spritesheet quad of the same draw call
+// NOTE: Sprites are looked up by the frog sprite id, resolved on update; positions are not interpolated
+void DrawFrogSwarm(Camera2D camera)
+{
+    swarmDrawnCount = 0;
+    if (swarm.count == 0) return;
+
+    const float halfWidth = PLAYER_SPRITE_WIDTH_PIXELS/2.0f;
+    const float halfHeight = PLAYER_SPRITE_HEIGHT_PIXELS/2.0f;
+    const float viewLeft = camera.target.x - camera.offset.x/camera.zoom - halfWidth;
+    const float viewTop = camera.target.y - camera.offset.y/camera.zoom - halfHeight;
+    const float viewRight = viewLeft + SCREEN_WIDTH_PIXELS/camera.zoom + 2.0f*halfWidth;
+    const float viewBottom = viewTop + SCREEN_HEIGHT_PIXELS/camera.zoom + 2.0f*halfHeight;
+
+    // Frogs are submitted in chunks, the batch is flushed between chunks if full
+    const int chunkFrogsCount = 1024;
+    for (int chunk = 0; chunk < swarm.count; chunk += chunkFrogsCount)
+    {
+        const int chunkEnd = (chunk + chunkFrogsCount < swarm.count)? chunk + chunkFrogsCount : swarm.count;
+        CheckRenderBatchLimit(4*(chunkEnd - chunk));
+
+        rlSetTexture(spritesheet.id);
+        rlBegin(RL_QUADS);
+            rlColor4ub(255, 255, 255, 255);
+            for (int i = chunk; i < chunkEnd; i += 1)
+            {
+                const float x = swarm.positionsX[i];
+                const float y = swarm.positionsY[i];
+                if ((x < viewLeft) || (x > viewRight) || (y < viewTop) || (y > viewBottom)) continue;
+
+                const Rectangle tex = frogSpriteTexcoords[swarm.spriteIds[i]];
+                rlTexCoord2f(tex.x, tex.y);
+                rlVertex2f(x - halfWidth, y - halfHeight);
+                rlTexCoord2f(tex.x, tex.y + tex.height);
+                rlVertex2f(x - halfWidth, y + halfHeight);
+                rlTexCoord2f(tex.x + tex.width, tex.y + tex.height);
+                rlVertex2f(x + halfWidth, y + halfHeight);
+                rlTexCoord2f(tex.x + tex.width, tex.y);
+                rlVertex2f(x + halfWidth, y - halfHeight);
+                swarmDrawnCount += 1;
+            }
+        rlEnd();
+        rlSetTexture(0);
+    }
+}
+
+// Draw the versus state over the main render: waiting for the opponent, opponent gone, race result
+void DrawVersusStatus(void)
+{
+    const struct GameState *gameState = &game.gameState;
+    const struct GameState *opponentState = &netplay.remote.gameState;
+
+    const char *text = NULL;
+    if (netplay.state == NETPLAY_CONNECTING) text = "WAITING RIVAL";
+    else if (netplay.state == NETPLAY_DISCONNECTED) text = "RIVAL LEFT";
+    else if (gameState->state == GAMESTATE_RESULT)
+    {
+        if (opponentState->state != GAMESTATE_RESULT) text = "RIVAL RACING";
+        else
+        {
+            // Fastest three stages win
+            float seconds = 0.0f;
+            float opponentSeconds = 0.0f;
+            for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+            {
+                seconds += gameState->stages[i].timerSeconds;
+                opponentSeconds += opponentState->stages[i].timerSeconds;
+            }
+
+            if (seconds < opponentSeconds) text = "YOU WIN";
+            else if (seconds > opponentSeconds) text = "YOU LOSE";
+            else text = "DRAW";
+        }
+    }
+
+    if (text != NULL) DrawTextEx(GetFont(20), text, (Vector2){ 40, 170 }, 20, 1.0f, palette[0]);
+}
+
 void DrawMinimapStar(int x, int y)
 {
     int posX = x*MINIMAP_STAR_SPACING_PIXELS + MINIMAP_STAR_SPACING_PIXELS;
@@ -1294,21 +1556,87 @@ void DrawMinimapStar(int x, int y)
     DrawCircle(posX, posY, 1.0f, palette[1]);
 }
 
-Vector2 GetMinimapStarPosition(int x, int y)
+// NOTE: Stars are placed by the minimap layout, fractional stars are allowed
+Vector2 GetMinimapStarPosition(float x, float y)
 {
     Vector2 pos = { 0 };
-    pos.x = (x + 1)*MINIMAP_STAR_SPACING_PIXELS;
-    pos.y = (y + 1)*MINIMAP_STAR_SPACING_PIXELS;
+    pos.x = minimapOffset.x + (x - minimapStars.x + 1)*minimapSpacing;
+    pos.y = minimapOffset.y + (y - minimapStars.y + 1)*minimapSpacing;
     return pos;
 }
 
+// Patch the minimap pyramid to the bridges lit in the game, rebuilt on constellation change or reset
+void UpdateMinimapPyramid(const struct GameInstance *game, int constellationId)
+{
+    struct ConstellationView constellation = { 0 };
+    if (!GetGameConstellation(game, &constellation)) return;
+
+    // Bridges only turn off on stage reset, pyramid is rebuilt then
+    bool rebuild = (minimapPyramidConstellationId != constellationId);
+    for (int i = 0; (i < GAME_LIT_BRIDGES_WORDS) && !rebuild; i += 1)
+    {
+        if (minimapPyramidLitBridges[i] & ~game->litBridges[i]) rebuild = true;
+    }
+
+    if (rebuild)
+    {
+        UnloadMinimapPyramid(&minimapPyramid);
+        minimapPyramidConstellationId = constellationId;
+        memcpy(minimapPyramidLitBridges, game->litBridges, sizeof(minimapPyramidLitBridges));
+
+        struct ConstellationBridge *bridges = (struct ConstellationBridge *)malloc(constellation.bridgesCount*sizeof(struct ConstellationBridge));
+        if (bridges != NULL)
+        {
+            for (int i = 0; i < constellation.bridgesCount; i += 1)
+            {
+                bridges[i] = GetConstellationViewBridge(&constellation, i);
+                bridges[i].state = GetGameBridgeState(game, &constellation, i);
+            }
+            if (!LoadMinimapPyramid(&minimapPyramid, bridges, constellation.bridgesCount)) LOG("MINIMAP: Failed to build pyramid\n");
+            free(bridges);
+        }
+
+        UpdateMinimapLayout();
+        return;
+    }
+
+    // Newly lit bridges update one tile per pyramid level
+    for (int i = 0; i < GAME_LIT_BRIDGES_WORDS; i += 1)
+    {
+        const unsigned int newBridges = game->litBridges[i] & ~minimapPyramidLitBridges[i];
+        for (int bit = 0; (bit < 32) && (newBridges >> bit); bit += 1)
+        {
+            if (newBridges & (1u << bit)) SetMinimapPyramidBridgeLit(&minimapPyramid, GetConstellationViewBridge(&constellation, 32*i + bit), true);
+        }
+        minimapPyramidLitBridges[i] |= newBridges;
+    }
+}
+
+// Fit the stars shown in the minimap: the pack star field at full spacing, or the constellation scaled down
+void UpdateMinimapLayout(void)
+{
+    const struct ConstellationPack *pack = GetConstellationPack();
+    minimapStars = (Rectangle){ 0, 0, (float)pack->starCountX, (float)pack->starCountY };
+    if ((((pack->starCountX + 1)*MINIMAP_STAR_SPACING_PIXELS > MINIMAP_WIDTH_PIXELS) ||
+         ((pack->starCountY + 1)*MINIMAP_STAR_SPACING_PIXELS > MINIMAP_HEIGHT_PIXELS)) && (minimapPyramid.levelsCount > 0))
+    {
+        minimapStars = (Rectangle){ (float)minimapPyramid.originX, (float)minimapPyramid.originY,
+                                    (float)minimapPyramid.starCountX, (float)minimapPyramid.starCountY };
+    }
+
+    minimapSpacing = fminf(MINIMAP_STAR_SPACING_PIXELS, fminf(MINIMAP_WIDTH_PIXELS/(minimapStars.width + 1), MINIMAP_HEIGHT_PIXELS/(minimapStars.height + 1)));
+    minimapOffset.x = (MINIMAP_WIDTH_PIXELS - (minimapStars.width + 1)*minimapSpacing)/2.0f;
+    minimapOffset.y = (MINIMAP_HEIGHT_PIXELS - (minimapStars.height + 1)*minimapSpacing)/2.0f;
+    minimapTilesShown = (minimapSpacing < MINIMAP_STAR_SPACING_PIXELS);
+}
+
 void DrawMinimapFrame(void)
 {
     ClearBackground(palette[0]);
 
     if (debugMode)
     {
-        DrawDebugGrid(5);
+        DrawDebugGrid(5, (Rectangle){ 0, 0, MINIMAP_WIDTH_PIXELS, MINIMAP_HEIGHT_PIXELS });
     }
 
     DrawRectangle(MINIMAP_BORDER_PIXELS,
@@ -1318,12 +1646,21 @@ void DrawMinimapFrame(void)
                   palette[4]);
 }
 
-void DrawMinimapConstellation(int constellationId)
+void DrawMinimapConstellation(const struct GameInstance *game)
 {
-    struct Constellation *constellation = &constellations[constellationId];
-    for (int i = 0; i < constellation->count; i += 1)
+    struct ConstellationView constellation = { 0 };
+    if (!GetGameConstellation(game, &constellation)) return;
+
+    if (minimapTilesShown)
     {
-        struct ConstellationBridge bridge = constellation->bridges[i];
+        DrawMinimapTiles();
+        return;
+    }
+
+    for (int i = 0; i < constellation.bridgesCount; i += 1)
+    {
+        struct ConstellationBridge bridge = GetConstellationViewBridge(&constellation, i);
+        bridge.state = GetGameBridgeState(game, &constellation, i);
         if (bridge.state == BRIDGE_DISABLED)
         {
             continue;
@@ -1339,8 +1676,89 @@ void DrawMinimapConstellation(int constellationId)
     }
 }
 
-void DrawStagePanel(struct GameState *gameState)
+// Draw the finest minimap pyramid level with tiles of MINIMAP_TILE_MIN_PIXELS at least, so the tiles drawn
+// are bounded by the minimap pixels. The share of lit bridges sets the tile color, bridge density its opacity
+void DrawMinimapTiles(void)
 {
+    int level = 0;
+    while ((level < minimapPyramid.levelsCount - 1) && (GetMinimapPyramidTileStars(&minimapPyramid, level)*minimapSpacing < MINIMAP_TILE_MIN_PIXELS)) level += 1;
+
+    int tileCountX = 0;
+    int tileCountY = 0;
+    const struct MinimapTile *tiles = GetMinimapPyramidLevel(&minimapPyramid, level, &tileCountX, &tileCountY);
+    if (tiles == NULL) return;
+
+    const int tileStars = GetMinimapPyramidTileStars(&minimapPyramid, level);
+    const int maxBridgesCount = minimapPyramid.levelMaxBridgesCount[level];
+    const Color unlitColor = palette[3];
+    const Color litColor = palette[1];
+    for (int y = 0; y < tileCountY; y += 1)
+    {
+        for (int x = 0; x < tileCountX; x += 1)
+        {
+            const struct MinimapTile *tile = &tiles[y*tileCountX + x];
+            if (tile->bridgesCount == 0) continue;
+
+            const float litShare = (float)tile->litBridgesCount/tile->bridgesCount;
+            Color color = { 0 };
+            color.r = (unsigned char)(unlitColor.r + litShare*(litColor.r - unlitColor.r));
+            color.g = (unsigned char)(unlitColor.g + litShare*(litColor.g - unlitColor.g));
+            color.b = (unsigned char)(unlitColor.b + litShare*(litColor.b - unlitColor.b));
+            color.a = (unsigned char)(255*(0.4f + 0.6f*tile->bridgesCount/maxBridgesCount));
+
+            // Tile covers its stars and half a spacing around them, last tiles are cut to the constellation
+            const int firstX = x*tileStars;
+            const int firstY = y*tileStars;
+            const int starsX = (firstX + tileStars <= minimapPyramid.starCountX)? tileStars : minimapPyramid.starCountX - firstX;
+            const int starsY = (firstY + tileStars <= minimapPyramid.starCountY)? tileStars : minimapPyramid.starCountY - firstY;
+            const Vector2 position = GetMinimapStarPosition(minimapPyramid.originX + firstX - 0.5f, minimapPyramid.originY + firstY - 0.5f);
+            DrawRectangleV(position, (Vector2){ starsX*minimapSpacing, starsY*minimapSpacing }, color);
+        }
+    }
+}
+
+// Draw the camera view over the minimap, position and scale of the minimap on screen
+void DrawMinimapViewport(Camera2D camera, Vector2 position, float scale)
+{
+    const float viewX = (camera.target.x - camera.offset.x/camera.zoom)/STAR_SPACING_PIXELS;
+    const float viewY = (camera.target.y - camera.offset.y/camera.zoom)/STAR_SPACING_PIXELS;
+    const Vector2 topLeft = GetMinimapStarPosition(viewX, viewY);
+    const Vector2 bottomRight = GetMinimapStarPosition(viewX + SCREEN_WIDTH_PIXELS/camera.zoom/STAR_SPACING_PIXELS,
+                                                       viewY + SCREEN_HEIGHT_PIXELS/camera.zoom/STAR_SPACING_PIXELS);
+
+    // Clipped to the minimap border
+    const float left = fmaxf(topLeft.x, MINIMAP_BORDER_PIXELS);
+    const float top = fmaxf(topLeft.y, MINIMAP_BORDER_PIXELS);
+    const float right = fminf(bottomRight.x, MINIMAP_WIDTH_PIXELS - MINIMAP_BORDER_PIXELS);
+    const float bottom = fminf(bottomRight.y, MINIMAP_HEIGHT_PIXELS - MINIMAP_BORDER_PIXELS);
+    if ((left >= right) || (top >= bottom)) return;
+
+    DrawRectangleLinesEx((Rectangle){ position.x + left*scale, position.y + top*scale, (right - left)*scale, (bottom - top)*scale }, scale, palette[2]);
+}
+
+// Redraw the stage panel layer, only if the text it shows changed
+// NOTE: Text is drawn over the opaque panels, the transparent background does not alter its blending
+void UpdateStagePanelRender(const struct GameInstance *game)
+{
+    const struct GameState *gameState = &game->gameState;
+    const struct GameStateStage *stage = &gameState->stages[gameState->stageId];
+
+    struct StagePanelKey key = { 0 };
+    key.stageId = gameState->stageId;
+    key.seconds = (gameState->state == GAMESTATE_GAMEPLAY) ? (int)(gameState->clockSeconds) : 0;
+    key.score = (stage->constellationId == -1) ? 0 : stage->score;
+    key.requiredScore = (stage->constellationId == -1) ? -1 : stage->requiredScore;
+
+    if (stagePanelValid &&
+        (stagePanelKey.stageId == key.stageId) && (stagePanelKey.seconds == key.seconds) &&
+        (stagePanelKey.score == key.score) && (stagePanelKey.requiredScore == key.requiredScore))
+    {
+        return;
+    }
+
+    stagePanelValid = true;
+    stagePanelKey = key;
+
     const int segments = 60;
     const float roundness = 0.5f;
 
@@ -1353,36 +1771,273 @@ void DrawStagePanel(struct GameState *gameState)
     Rectangle rec = { 0 };
     Vector2 textPos = { 0 };
 
-    struct GameStateStage *stage = &gameState->stages[gameState->stageId];
+    BeginTextureMode(stagePanelRender);
+        ClearBackground(BLANK);
 
-    // Clock panel
-    rec = (Rectangle){ 4, recPosY, 76, recHeight };
-    DrawRectangleRounded(rec, roundness, segments, palette[3]);
+        // Panels are laid out in screen coordinates
+        rlPushMatrix();
+        rlTranslatef(0, -(float)(SCREEN_HEIGHT_PIXELS - STAGE_PANEL_HEIGHT_PIXELS), 0);
 
-    int seconds = (gameState->state == GAMESTATE_GAMEPLAY) ? (int)(gameState->clockSeconds) : 0.0f;
-    int minutes = seconds/60;
-    seconds -= minutes*60;
+        // Clock panel
+        rec = (Rectangle){ 4, recPosY, 76, recHeight };
+        DrawRectangleRounded(rec, roundness, segments, palette[3]);
 
-    textPos = (Vector2) { 7, fontPosY };
-    DrawTextEx(font, TextFormat("TIME: %02i:%02i", minutes, seconds), textPos, fontSize - 2, roundness, palette[0]);
+        const int minutes = key.seconds/60;
+        const int seconds = key.seconds - minutes*60;
 
-    // Stage panel
-    rec = (Rectangle){ SCREEN_WIDTH_PIXELS/2 - 42, recPosY, 77, recHeight };
-    DrawRectangleRounded(rec, roundness, segments, palette[3]);
+        textPos = (Vector2) { 7, fontPosY };
+        DrawTextEx(GetFont(fontSize - 2), TextFormat("TIME: %02i:%02i", minutes, seconds), textPos, fontSize - 2, roundness, palette[0]);
 
-    textPos = (Vector2) { SCREEN_WIDTH_PIXELS/2 - 36, fontPosY };
-    DrawTextEx(font, TextFormat("STAGE: %i", gameState->stageId + 1), textPos, fontSize, 1.0f, palette[0]);
+        // Stage panel
+        rec = (Rectangle){ SCREEN_WIDTH_PIXELS/2 - 42, recPosY, 77, recHeight };
+        DrawRectangleRounded(rec, roundness, segments, palette[3]);
 
-    // Score panel
-    rec = (Rectangle){ SCREEN_WIDTH_PIXELS - 87, recPosY, 86, recHeight };
-    DrawRectangleRounded(rec, roundness, segments, palette[3]);
+        textPos = (Vector2) { SCREEN_WIDTH_PIXELS/2 - 36, fontPosY };
+        DrawTextEx(GetFont(fontSize), TextFormat("STAGE: %i", key.stageId + 1), textPos, fontSize, 1.0f, palette[0]);
 
-    textPos = (Vector2) { SCREEN_WIDTH_PIXELS - 85, fontPosY };
-    if (stage->constellationId == -1)
+        // Score panel
+        rec = (Rectangle){ SCREEN_WIDTH_PIXELS - 87, recPosY, 86, recHeight };
+        DrawRectangleRounded(rec, roundness, segments, palette[3]);
+
+        textPos = (Vector2) { SCREEN_WIDTH_PIXELS - 85, fontPosY };
+        if (key.requiredScore == -1)
+        {
+            DrawTextEx(GetFont(fontSize - 2), TextFormat("SCORE: %02i-??", 0), textPos, fontSize - 2, 1.0f, palette[0]);
+        } else
+        {
+            DrawTextEx(GetFont(fontSize - 2), TextFormat("SCORE: %02i-%02i", key.score, key.requiredScore), textPos, fontSize - 2, 1.0f, palette[0]);
+        }
+
+        rlPopMatrix();
+    CountRenderBatch();
+    EndTextureMode();
+}
+
+void DrawStagePanel(void)
+{
+    // NOTE: Render texture is flipped vertically, source rectangle height must be negative
+    DrawTextureRec(stagePanelRender.texture,
+                   (Rectangle){ 0, 0, (float)stagePanelRender.texture.width, -(float)stagePanelRender.texture.height },
+                   (Vector2){ 0, SCREEN_HEIGHT_PIXELS - STAGE_PANEL_HEIGHT_PIXELS },
+                   WHITE);
+}
+
+// Redraw the results lines layer, only if a line was added or its times changed
+void UpdateResultLinesRender(const struct GameInstance *game)
+{
+    const struct GameState *gameState = &game->gameState;
+
+    // A new stage line is shown every second
+    struct ResultLinesKey key = { 0 };
+    if (gameState->clockSeconds >= 1.0f)
     {
-        DrawTextEx(font, TextFormat("SCORE: %02i-??", 0), textPos, fontSize - 2, 1.0f, palette[0]);
-    } else
+        const int stageId = (int)(gameState->clockSeconds - 1.0f);
+        key.linesCount = ((stageId < GAMESTATE_STAGES_COUNT - 1) ? stageId : GAMESTATE_STAGES_COUNT - 1) + 1;
+    }
+    for (int i = 0; i < key.linesCount; i += 1)
+    {
+        key.seconds[i] = (int)(gameState->stages[i].timerSeconds);
+        const struct ParTime parTime = GetStageParTime(gameState, i);
+        key.parTicks[i] = parTime.ticks;
+        key.isParOptimal[i] = parTime.isOptimal;
+    }
+
+    if (resultLinesValid && (memcmp(&resultLinesKey, &key, sizeof(struct ResultLinesKey)) == 0)) return;
+
+    resultLinesValid = true;
+    resultLinesKey = key;
+
+    // NOTE: Layer is cleared with the results screen background, text blends as if drawn on screen
+    BeginTextureMode(resultLinesRender);
+        ClearBackground(palette[5]);
+
+        // Lines are laid out in screen coordinates
+        rlPushMatrix();
+        rlTranslatef(0, -(float)RESULT_LINES_POS_Y_PIXELS, 0);
+
+        for (int i = 0; i < key.linesCount; i += 1)
+        {
+            int seconds = key.seconds[i];
+            int minutes = seconds/60;
+            seconds -= minutes*60;
+            DrawTextEx(GetFont(20),
+                    TextFormat("STAGE %i: %02i:%02i", i + 1, minutes, seconds),
+                    (Vector2){ 20, RESULT_LINES_POS_Y_PIXELS + 30*i},
+                    20,
+                    1.0f,
+                    palette[0]);
+
+            // NOTE: Routes not proven the fastest (solver out of budget) are marked
+            const char *parText = NULL;
+            if (key.parTicks[i] == PAR_TICKS_SOLVING) parText = "PAR --:--";
+            else if (key.parTicks[i] >= 0)
+            {
+                int parSeconds = (int)(key.parTicks[i]*GAME_TICK_SECONDS + 0.999f);
+                const int parMinutes = parSeconds/60;
+                parSeconds -= parMinutes*60;
+                parText = TextFormat(key.isParOptimal[i]? "PAR %02i:%02i" : "PAR %02i:%02i (UNPROVEN)", parMinutes, parSeconds);
+            }
+
+            if (parText != NULL)
+            {
+                DrawTextEx(GetFont(10),
+                        parText,
+                        (Vector2){ 40, RESULT_LINES_POS_Y_PIXELS + 30*i + 18},
+                        10,
+                        1.0f,
+                        palette[0]);
+            }
+        }
+
+        rlPopMatrix();
+    CountRenderBatch();
+    EndTextureMode();
+}
+
+void DrawResultLines(void)
+{
+    // NOTE: Render texture is flipped vertically, source rectangle height must be negative
+    DrawTextureRec(resultLinesRender.texture,
+                   (Rectangle){ 0, 0, (float)resultLinesRender.texture.width, -(float)resultLinesRender.texture.height },
+                   (Vector2){ 0, RESULT_LINES_POS_Y_PIXELS },
+                   WHITE);
+}
+
+// Redraw the minimap render texture, only if the constellation shown or its bridges changed
+void UpdateMinimapRender(const struct GameInstance *game)
+{
+    const struct GameState *gameState = &game->gameState;
+
+    // Minimap is not displayed on results screen
+    if (gameState->state == GAMESTATE_RESULT) return;
+
+    // Constellation is only displayed once the stage gameplay starts
+    int constellationId = -1;
+    if ((gameState->state == GAMESTATE_GAMEPLAY) || (gameState->state == GAMESTATE_CLEAR))
+    {
+        constellationId = gameState->stages[gameState->stageId].constellationId;
+    }
+
+    if (minimapValid &&
+        (minimapConstellationId == constellationId) &&
+        (minimapBridgesVersion == game->bridgesVersion) &&
+        (minimapDebugMode == debugMode))
+    {
+        minimapSkippedCount += 1;
+        return;
+    }
+
+    minimapValid = true;
+    minimapConstellationId = constellationId;
+    minimapBridgesVersion = game->bridgesVersion;
+    minimapDebugMode = debugMode;
+    minimapRedrawCount += 1;
+
+    if (constellationId != -1) UpdateMinimapPyramid(game, constellationId);
+
+    BeginTextureMode(minimapRender);
+        DrawMinimapFrame();
+        if (constellationId != -1) DrawMinimapConstellation(game);
+    CountRenderBatch();
+    EndTextureMode();
+}
+
+// Get the key of everything the main render shows, following the drawing conditions of UpdateDrawFrame()
+struct MainRenderKey GetMainRenderKey(const struct GameInstance *game, Vector2 playerPosition, Camera2D camera)
+{
+    const struct GameState *gameState = &game->gameState;
+    const struct Player *player = &game->player;
+
+    struct MainRenderKey key = { 0 };
+    key.state = gameState->state;
+    key.stageId = gameState->stageId;
+    key.constellationId = gameState->stages[gameState->stageId].constellationId;
+    key.bridgesVersion = (int)game->bridgesVersion;
+    key.debugMode = debugMode;
+    key.camera = camera;
+
+    switch (gameState->state)
+    {
+        case GAMESTATE_START:
+        {
+            if ((gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 4.0f)) key.textPhase = 4 - (int)gameState->clockSeconds;
+            key.stagePanel = stagePanelKey;
+        } break;
+        case GAMESTATE_GAMEPLAY:
+        {
+            key.textPhase = (gameState->clockSeconds >= 0.0f) && (gameState->clockSeconds <= 1.5f);
+            key.stagePanel = stagePanelKey;
+        } break;
+        case GAMESTATE_CLEAR:
+        {
+            key.textPhase = (gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 5.0f);
+            key.stagePanel = stagePanelKey;
+        } break;
+        case GAMESTATE_RESULT:
+        {
+            key.textPhase = (gameState->clockSeconds >= 5.0f) && (gameState->clockSeconds - (int)(gameState->clockSeconds) >= 0.5);
+            key.resultLines = resultLinesKey;
+        } break;
+    }
+
+    // Player is not drawn on results screen
+    if (gameState->state != GAMESTATE_RESULT)
     {
-        DrawTextEx(font, TextFormat("SCORE: %02i-%02i", stage->score, GetConstellationRequiredScore(stage->constellationId)), textPos, fontSize - 2, 1.0f, palette[0]);
+        key.playerState = player->state;
+        key.playerGrabbedStarX = player->isGrabbingStar ? player->grabbedStarX : -1;
+        key.playerGrabbedStarY = player->isGrabbingStar ? player->grabbedStarY : -1;
+        key.playerFlappingUp = player->flappingUp;
+        key.playerFacingRight = player->isFacingRight;
+        key.playerPosition = playerPosition;
     }
+
+    return key;
+}
+
+void RunStageParJob(void *data)
+{
+    struct StageParJob *job = (struct StageParJob *)data;
+    job->parTime = SolveParTime(&job->view, job->startPosition.x, job->startPosition.y, SOLVER_GAME_NODES_BUDGET);
+}
+
+// Collect the par time jobs done and start the ones of the stage constellations chosen since
+// NOTE: Without threads support the job runs here, when the constellation is chosen, not on results screen
+// NOTE: Routes start from the frog position on the first frame the constellation is known, the countdown is over
+void UpdateStageParTimes(const struct GameInstance *game)
+{
+    const struct GameState *gameState = &game->gameState;
+    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+    {
+        if (isStageParSolving[i])
+        {
+            if (!IsBackgroundJobDone(&stageParBackgroundJobs[i])) continue;
+
+            isStageParSolving[i] = false;
+            stageParConstellationIds[i] = stageParJobs[i].constellationId;
+            stageParTimes[i] = stageParJobs[i].parTime;
+        }
+
+        const int constellationId = gameState->stages[i].constellationId;
+        if ((constellationId == -1) || (stageParConstellationIds[i] == constellationId)) continue;
+
+        struct ConstellationView view = { 0 };
+        if (!GetPackConstellation(GetConstellationPack(), constellationId, &view))
+        {
+            stageParConstellationIds[i] = constellationId;
+            stageParTimes[i] = (struct ParTime){ -1, 0, false };
+            continue;
+        }
+
+        stageParJobs[i] = (struct StageParJob){ view, constellationId, game->player.position, { -1, 0, false } };
+        isStageParSolving[i] = true;
+        StartBackgroundJob(&stageParBackgroundJobs[i], RunStageParJob, &stageParJobs[i]);
+    }
+}
+
+// Get the par time of a stage, PAR_TICKS_SOLVING ticks while its job runs
+struct ParTime GetStageParTime(const struct GameState *gameState, int stageId)
+{
+    if (stageParConstellationIds[stageId] != gameState->stages[stageId].constellationId) return (struct ParTime){ PAR_TICKS_SOLVING, 0, false };
+
+    return stageParTimes[stageId];
 }
@@ -0,0 +1,349 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Input recording
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "recording.h"
+
+#include <stdio.h>                          // Required for: FILE, fopen(), fread(), fwrite(), fclose()
+#include <stdlib.h>                         // Required for: malloc(), realloc(), free()
+#include <string.h>                         // Required for: memcpy(), memcmp()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define VARINT_MAX_SIZE 5                   // Bytes of the longest 32 bit varint
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Growing byte buffer, used to encode recordings
+struct ByteBuffer {
+    unsigned char *data;
+    int size;
+    int capacity;
+};
+
+// Bounded reader, used to decode recordings
+struct ByteReader {
+    const unsigned char *data;
+    int size;
+    int position;
+    bool isValid;                           // Cleared on any read past the end or malformed varint
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static bool ReserveBytes(unsigned char **data, int *capacity, int size);
+static bool WriteVarint(struct ByteBuffer *buffer, unsigned int value);
+static bool WriteBytes(struct ByteBuffer *buffer, const void *data, int size);
+static unsigned int ReadVarint(struct ByteReader *reader);
+static bool EncodeRun(unsigned char **data, int *size, int *capacity, unsigned int buttons, int ticks);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+void InitInputRecording(struct InputRecording *recording, unsigned int seed)
+{
+    *recording = (struct InputRecording){ 0 };
+    recording->seed = seed;
+    recording->constellationsCount = GetConstellationsCount();
+}
+
+void UnloadInputRecording(struct InputRecording *recording)
+{
+    free(recording->runs);
+    *recording = (struct InputRecording){ 0 };
+}
+
+bool RecordInputFrame(struct InputRecording *recording, const struct InputFrame *input)
+{
+    if ((recording->runTicks > 0) && (recording->runButtons != input->buttons))
+    {
+        if (!EncodeRun(&recording->runs, &recording->runsSize, &recording->runsCapacity, recording->runButtons, recording->runTicks)) return false;
+        recording->runTicks = 0;
+    }
+
+    recording->runButtons = input->buttons;
+    recording->runTicks += 1;
+    recording->ticksCount += 1;
+
+    return true;
+}
+
+// Drop the ticks recorded after ticksCount, as if they were never played
+// NOTE: Used when the game is restored to an earlier tick (rewind), so the recording still replays to the same results
+bool TruncateInputRecording(struct InputRecording *recording, int ticksCount)
+{
+    if ((ticksCount < 0) || (ticksCount > recording->ticksCount)) return false;
+
+    // Cut inside the current run, not encoded yet
+    const int encodedTicks = recording->ticksCount - recording->runTicks;
+    if (ticksCount >= encodedTicks)
+    {
+        recording->runTicks = ticksCount - encodedTicks;
+        recording->ticksCount = ticksCount;
+        return true;
+    }
+
+    // Cut inside an encoded run: runs after it are dropped, it becomes the current run
+    struct ByteReader reader = { recording->runs, recording->runsSize, 0, true };
+    int runStartTick = 0;
+    while (reader.isValid && (reader.position < reader.size))
+    {
+        const int runPosition = reader.position;
+        const unsigned int buttons = ReadVarint(&reader);
+        const int ticks = (int)ReadVarint(&reader);
+        if (!reader.isValid) break;
+
+        if (runStartTick + ticks >= ticksCount)
+        {
+            recording->runsSize = runPosition;
+            recording->runButtons = buttons;
+            recording->runTicks = ticksCount - runStartTick;
+            recording->ticksCount = ticksCount;
+            return true;
+        }
+        runStartTick += ticks;
+    }
+
+    return false;
+}
+
+bool SaveInputRecording(const char *fileName, const struct InputRecording *recording, const struct GameInstance *game)
+{
+    // Runs encoded so far plus the current run
+    struct ByteBuffer runs = { 0 };
+    bool success = WriteBytes(&runs, recording->runs, recording->runsSize);
+    if (success && (recording->runTicks > 0)) success = EncodeRun(&runs.data, &runs.size, &runs.capacity, recording->runButtons, recording->runTicks);
+
+    struct ByteBuffer buffer = { 0 };
+    if (success)
+    {
+        const unsigned char version = INPUT_RECORDING_VERSION;
+        success = WriteBytes(&buffer, "SFIR", 4) && WriteBytes(&buffer, &version, 1) &&
+                  WriteVarint(&buffer, recording->seed) &&
+                  WriteVarint(&buffer, (unsigned int)recording->constellationsCount) &&
+                  WriteVarint(&buffer, (unsigned int)recording->ticksCount) &&
+                  WriteVarint(&buffer, (unsigned int)runs.size) &&
+                  WriteBytes(&buffer, runs.data, runs.size);
+
+        const struct GameState *gameState = &game->gameState;
+        success = success && WriteVarint(&buffer, (unsigned int)gameState->state) && WriteVarint(&buffer, (unsigned int)gameState->stageId);
+        for (int i = 0; success && (i < GAMESTATE_STAGES_COUNT); i += 1)
+        {
+            const struct GameStateStage *stage = &gameState->stages[i];
+
+            unsigned int timerBits = 0;
+            memcpy(&timerBits, &stage->timerSeconds, sizeof(timerBits));
+            const unsigned char timerBytes[4] = {
+                (unsigned char)timerBits, (unsigned char)(timerBits >> 8),
+                (unsigned char)(timerBits >> 16), (unsigned char)(timerBits >> 24)
+            };
+
+            success = WriteVarint(&buffer, (unsigned int)(stage->constellationId + 1)) &&
+                      WriteVarint(&buffer, (unsigned int)stage->score) &&
+                      WriteVarint(&buffer, (unsigned int)stage->requiredScore) &&
+                      WriteBytes(&buffer, timerBytes, 4);
+        }
+    }
+
+    if (success)
+    {
+        success = false;
+        FILE *file = fopen(fileName, "wb");
+        if (file != NULL)
+        {
+            success = (fwrite(buffer.data, 1, buffer.size, file) == (size_t)buffer.size);
+            success = (fclose(file) == 0) && success;
+        }
+    }
+
+    free(buffer.data);
+    free(runs.data);
+
+    return success;
+}
+
+bool LoadInputRecording(struct InputRecording *recording, const char *fileName)
+{
+    *recording = (struct InputRecording){ 0 };
+
+    FILE *file = fopen(fileName, "rb");
+    if (file == NULL) return false;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    unsigned char *data = (size > 0)? (unsigned char *)malloc(size) : NULL;
+    const bool read = (data != NULL) && (fread(data, 1, size, file) == (size_t)size);
+    fclose(file);
+
+    struct ByteReader reader = { data, read? (int)size : 0, 0, read };
+    if ((reader.size < 5) || (memcmp(data, "SFIR", 4) != 0) || (data[4] != INPUT_RECORDING_VERSION)) reader.isValid = false;
+    reader.position = 5;
+
+    recording->seed = ReadVarint(&reader);
+    recording->constellationsCount = (int)ReadVarint(&reader);
+    recording->ticksCount = (int)ReadVarint(&reader);
+    recording->runsSize = (int)ReadVarint(&reader);
+
+    if (reader.isValid && (recording->runsSize >= 0) && (recording->runsSize <= reader.size - reader.position))
+    {
+        recording->runs = (unsigned char *)malloc(recording->runsSize + 1);
+        if (recording->runs != NULL) memcpy(recording->runs, data + reader.position, recording->runsSize);
+        recording->runsCapacity = recording->runsSize + 1;
+        reader.position += recording->runsSize;
+        reader.isValid = (recording->runs != NULL);
+    } else
+    {
+        reader.isValid = false;
+    }
+
+    struct GameState *gameState = &recording->gameState;
+    gameState->state = (enum GameStateState)ReadVarint(&reader);
+    gameState->stageId = (int)ReadVarint(&reader);
+    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+    {
+        struct GameStateStage *stage = &gameState->stages[i];
+        stage->constellationId = (int)ReadVarint(&reader) - 1;
+        stage->score = (int)ReadVarint(&reader);
+        stage->requiredScore = (int)ReadVarint(&reader);
+
+        unsigned int timerBits = 0;
+        if (reader.isValid && (reader.position + 4 <= reader.size))
+        {
+            const unsigned char *timerBytes = data + reader.position;
+            timerBits = (unsigned int)timerBytes[0] | ((unsigned int)timerBytes[1] << 8) | ((unsigned int)timerBytes[2] << 16) | ((unsigned int)timerBytes[3] << 24);
+            reader.position += 4;
+        } else
+        {
+            reader.isValid = false;
+        }
+        memcpy(&stage->timerSeconds, &timerBits, sizeof(timerBits));
+    }
+
+    free(data);
+
+    if (!reader.isValid) UnloadInputRecording(recording);
+
+    return reader.isValid;
+}
+
+bool ReplayInputRecording(const struct InputRecording *recording, struct GameInstance *game)
+{
+    // NOTE: Recording must be replayed with the same constellations pack
+    if (recording->constellationsCount != GetConstellationsCount()) return false;
+
+    InitGameInstance(game, recording->seed);
+
+    struct ByteReader reader = { recording->runs, recording->runsSize, 0, true };
+    int ticksCount = 0;
+    while (reader.isValid && (reader.position < reader.size))
+    {
+        const struct InputFrame input = { ReadVarint(&reader) };
+        const int ticks = (int)ReadVarint(&reader);
+        if (!reader.isValid || (ticks <= 0) || (ticks > recording->ticksCount - ticksCount)) return false;
+
+        for (int i = 0; i < ticks; i += 1) GameStep(game, &input, GAME_TICK_SECONDS);
+        ticksCount += ticks;
+    }
+
+    return reader.isValid && (ticksCount == recording->ticksCount);
+}
+
+bool CheckReplayResults(const struct InputRecording *recording, const struct GameInstance *game)
+{
+    const struct GameState *expected = &recording->gameState;
+    const struct GameState *actual = &game->gameState;
+
+    if ((expected->state != actual->state) || (expected->stageId != actual->stageId)) return false;
+
+    for (int i = 0; i < GAMESTATE_STAGES_COUNT; i += 1)
+    {
+        const struct GameStateStage *expectedStage = &expected->stages[i];
+        const struct GameStateStage *actualStage = &actual->stages[i];
+
+        // NOTE: Timers are compared bit exact, the simulation is deterministic
+        if ((expectedStage->constellationId != actualStage->constellationId) ||
+            (expectedStage->score != actualStage->score) ||
+            (expectedStage->requiredScore != actualStage->requiredScore) ||
+            (memcmp(&expectedStage->timerSeconds, &actualStage->timerSeconds, sizeof(float)) != 0)) return false;
+    }
+
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Grow a buffer capacity to hold at least size bytes
+bool ReserveBytes(unsigned char **data, int *capacity, int size)
+{
+    if (size <= *capacity) return true;
+
+    int newCapacity = (*capacity > 0)? *capacity : 256;
+    while (newCapacity < size) newCapacity *= 2;
+
+    unsigned char *newData = (unsigned char *)realloc(*data, newCapacity);
+    if (newData == NULL) return false;
+
+    *data = newData;
+    *capacity = newCapacity;
+    return true;
+}
+
+bool WriteVarint(struct ByteBuffer *buffer, unsigned int value)
+{
+    if (!ReserveBytes(&buffer->data, &buffer->capacity, buffer->size + VARINT_MAX_SIZE)) return false;
+
+    while (value >= 0x80)
+    {
+        buffer->data[buffer->size++] = (unsigned char)(value | 0x80);
+        value >>= 7;
+    }
+    buffer->data[buffer->size++] = (unsigned char)value;
+    return true;
+}
+
+bool WriteBytes(struct ByteBuffer *buffer, const void *data, int size)
+{
+    if (size == 0) return true;
+    if (!ReserveBytes(&buffer->data, &buffer->capacity, buffer->size + size)) return false;
+
+    memcpy(buffer->data + buffer->size, data, size);
+    buffer->size += size;
+    return true;
+}
+
+unsigned int ReadVarint(struct ByteReader *reader)
+{
+    unsigned int value = 0;
+    for (int shift = 0; reader->isValid && (shift < 7*VARINT_MAX_SIZE); shift += 7)
+    {
+        if (reader->position >= reader->size) break;
+
+        const unsigned char byte = reader->data[reader->position++];
+        value |= (unsigned int)(byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0) return value;
+    }
+    reader->isValid = false;
+    return 0;
+}
+
+// Append a (buttons, ticks) run to an encoded runs buffer
+bool EncodeRun(unsigned char **data, int *size, int *capacity, unsigned int buttons, int ticks)
+{
+    struct ByteBuffer buffer = { *data, *size, *capacity };
+    const bool success = WriteVarint(&buffer, buttons) && WriteVarint(&buffer, (unsigned int)ticks);
+
+    *data = buffer.data;
+    *size = buffer.size;
+    *capacity = buffer.capacity;
+    return success;
+}
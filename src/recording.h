@@ -0,0 +1,68 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Input recording
+*
+*   Records the input frame of every simulation tick plus the game random seed, so a session
+*   can be replayed headless (no window, no frame rate cap) and its results verified.
+*
+*   Recording file (version 1), every number is an unsigned LEB128 varint unless noted:
+*
+*       char[4]     magic "SFIR"
+*       u8          version
+*       seed, constellations count, ticks count, runs size in bytes
+*       runs        (buttons, ticks) pairs, consecutive ticks with the same buttons are one run
+*       results     state, stage id, then for every stage: constellation id + 1, score,
+*                   required score, u32 little-endian timer float bits
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef RECORDING_H
+#define RECORDING_H
+
+#include "game.h"                           // Required for: struct GameInstance, struct InputFrame
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define INPUT_RECORDING_VERSION 1
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct InputRecording {
+    unsigned int seed;                  // Game random seed
+    int constellationsCount;            // Constellations count of the pack played
+    int ticksCount;                     // Recorded ticks, including the current run
+    unsigned char *runs;                // Encoded runs
+    int runsSize;
+    int runsCapacity;
+    unsigned int runButtons;            // Buttons of the current run (not encoded yet)
+    int runTicks;                       // Ticks of the current run
+    struct GameState gameState;         // Recorded results, valid on loaded recordings
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void InitInputRecording(struct InputRecording *recording, unsigned int seed);              // Start an empty recording for a game seed
+void UnloadInputRecording(struct InputRecording *recording);                                // Free recording memory
+bool RecordInputFrame(struct InputRecording *recording, const struct InputFrame *input);   // Record the input of one tick, false on allocation failure
+bool TruncateInputRecording(struct InputRecording *recording, int ticksCount);              // Drop the ticks recorded after ticksCount (game restored to that tick)
+bool SaveInputRecording(const char *fileName, const struct InputRecording *recording, const struct GameInstance *game);  // Save recording with the game results
+bool LoadInputRecording(struct InputRecording *recording, const char *fileName);           // Load recording and its results
+bool ReplayInputRecording(const struct InputRecording *recording, struct GameInstance *game);    // Run all the recorded ticks on a new game, false if data is invalid
+bool CheckReplayResults(const struct InputRecording *recording, const struct GameInstance *game);   // Check game results are the recorded ones
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // RECORDING_H
@@ -0,0 +1,74 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Rendering constants
+*
+*   Layout, spritesheet and palette constants shared by the raylib frontend (raylib_game.c)
+*   and the software renderer frontend (soft_render.c), so both draw the same frames.
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef RENDER_H
+#define RENDER_H
+
+#include "raylib.h"                         // Required for: Color
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define MINIMAP_WIDTH_PIXELS 60
+#define MINIMAP_HEIGHT_PIXELS 80
+#define MINIMAP_BORDER_PIXELS 2
+#define MINIMAP_STAR_SPACING_PIXELS 5
+
+#define SPRITESHEET_FROG_OFFSET_X_PIXELS 0
+#define SPRITESHEET_FROG_OFFSET_Y_PIXELS 0
+#define SPRITESHEET_STAR_OFFSET_X_PIXELS 384
+#define SPRITESHEET_STAR_OFFSET_Y_PIXELS 0
+
+#define STAR_SPRITE_WIDTH_PIXELS 32
+#define STAR_SPRITE_HEIGHT_PIXELS 32
+
+#define PLAYER_SPRITE_WIDTH_PIXELS 64
+#define PLAYER_SPRITE_HEIGHT_PIXELS 64
+
+#define CONSTELLATION_BRIDGE_LINE_THICKNESS 3.5f
+
+// Font sizes drawn by the frontends, every size has its own atlas so text is drawn 1:1
+// NOTE: Atlases are generated as raylib LoadFontEx() does, or baked at build time (see asset_baker.c)
+#define FONT_FILE_NAME "resources/Autriche-4n84.ttf"
+#define FONT_SIZES_COUNT 5
+#define FONT_SIZES { 8, 10, 20, 40, 60 }
+#define FONT_GLYPH_COUNT 95                 // Same as raylib LoadFontEx(): ASCII 32..126
+#define FONT_GLYPH_PADDING 4                // Same as raylib LoadFontEx(): FONT_TTF_DEFAULT_CHARS_PADDING
+
+#define SPRITESHEET_FILE_NAME "resources/spritesheet2.png"
+
+// https://lospec.com/palette-list/oil-6
+#define PALETTE_COLOR_0 CLITERAL(Color){ 0xfb, 0xf5, 0xef, 0xff }
+#define PALETTE_COLOR_1 CLITERAL(Color){ 0xf2, 0xd3, 0xab, 0xff }
+#define PALETTE_COLOR_2 CLITERAL(Color){ 0xc6, 0x9f, 0xa5, 0xff }
+#define PALETTE_COLOR_3 CLITERAL(Color){ 0x8b, 0x6d, 0x9c, 0xff }
+#define PALETTE_COLOR_4 CLITERAL(Color){ 0x49, 0x4d, 0x7e, 0xff }
+#define PALETTE_COLOR_5 CLITERAL(Color){ 0x27, 0x27, 0x44, 0xff }
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+enum PlayerSpriteFrames {
+    PLAYER_SPRITE_IDLE_WITHOUT_STAR = 0,
+    PLAYER_SPRITE_IDLE_WITH_STAR,
+    PLAYER_SPRITE_JUMPING_WITHOUT_STAR,
+    PLAYER_SPRITE_JUMPING_WITH_STAR,
+    PLAYER_SPRITE_STUNNED,
+    PLAYER_SPRITE_FRAMES,
+};
+
+enum StarSpriteFrames {
+    STAR_SPRITE_OFF = 0,
+    STAR_SPRITE_ON,
+    STAR_SPRITE_FRAMES
+};
+
+#endif // RENDER_H
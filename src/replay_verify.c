@@ -0,0 +1,99 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Replay verifier
+*
+*   Replays input recordings headless, as fast as the CPU allows, and checks the final stage
+*   scores and timers are the recorded ones. Used to regression test gameplay changes against
+*   archived sessions.
+*
+*   Build and run (headless, raylib library not required):
+*       make replay_verify && ./replay_verify [-p constellations.sfcp] session_*.sfr
+*
+*   NOTE: Recordings must be replayed with the constellations pack they were recorded with,
+*   default is resources/constellations.sfcp (built-in constellations if not available)
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "game.h"
+#include "recording.h"
+
+#include <stdio.h>                          // Required for: printf()
+#include <string.h>                         // Required for: strcmp()
+#include <time.h>                           // Required for: clock()
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    const char *packFileName = "resources/constellations.sfcp";
+    int firstFile = 1;
+    if ((argc > 2) && (strcmp(argv[1], "-p") == 0))
+    {
+        packFileName = argv[2];
+        firstFile = 3;
+    }
+
+    if (firstFile >= argc)
+    {
+        printf("Usage: %s [-p constellations.sfcp] recording.sfr...\n", argv[0]);
+        return 1;
+    }
+
+    if (!LoadConstellations(packFileName))
+    {
+        printf("Failed to load constellations\n");
+        return 1;
+    }
+
+    static struct GameInstance game = { 0 };
+    int passedCount = 0;
+    int failedCount = 0;
+    long long ticksCount = 0;
+
+    clock_t start = clock();
+    for (int i = firstFile; i < argc; i += 1)
+    {
+        struct InputRecording recording = { 0 };
+        if (!LoadInputRecording(&recording, argv[i]))
+        {
+            printf("FAIL %s: invalid recording\n", argv[i]);
+            failedCount += 1;
+            continue;
+        }
+
+        if (!ReplayInputRecording(&recording, &game))
+        {
+            printf("FAIL %s: replay error (different constellations pack?)\n", argv[i]);
+            failedCount += 1;
+        } else if (!CheckReplayResults(&recording, &game))
+        {
+            printf("FAIL %s: results mismatch\n", argv[i]);
+            for (int s = 0; s < GAMESTATE_STAGES_COUNT; s += 1)
+            {
+                const struct GameStateStage *expected = &recording.gameState.stages[s];
+                const struct GameStateStage *actual = &game.gameState.stages[s];
+                printf("    stage %i: expected %i %i-%i %.4fs, got %i %i-%i %.4fs\n", s + 1,
+                       expected->constellationId, expected->score, expected->requiredScore, expected->timerSeconds,
+                       actual->constellationId, actual->score, actual->requiredScore, actual->timerSeconds);
+            }
+            failedCount += 1;
+        } else
+        {
+            passedCount += 1;
+        }
+
+        ticksCount += recording.ticksCount;
+        UnloadInputRecording(&recording);
+    }
+    const double seconds = (double)(clock() - start)/CLOCKS_PER_SEC;
+
+    printf("%i passed, %i failed, %lld ticks in %.3fs (%.0fx real time)\n", passedCount, failedCount, ticksCount, seconds,
+           (seconds > 0.0)? ticksCount*GAME_TICK_SECONDS/seconds : 0.0);
+
+    UnloadConstellations();
+
+    return (failedCount == 0)? 0 : 1;
+}
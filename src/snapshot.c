@@ -0,0 +1,96 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Game snapshots
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "snapshot.h"
+
+#include <stdio.h>                          // Required for: FILE, fopen(), fwrite(), fclose(), remove()
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static bool WriteU32(FILE *file, unsigned int value);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+void SaveGameSnapshot(struct GameSnapshot *snapshot, const struct GameInstance *game, int tick)
+{
+    snapshot->tick = tick;
+    snapshot->game = *game;
+}
+
+// Restore a snapshot into a running game
+// NOTE: Bridges version keeps increasing, renderers caching on it never see an old version again
+void RestoreGameSnapshot(const struct GameSnapshot *snapshot, struct GameInstance *game)
+{
+    const unsigned int bridgesVersion = game->bridgesVersion;
+    *game = snapshot->game;
+    game->bridgesVersion = bridgesVersion + 1;
+}
+
+void InitSnapshotRing(struct SnapshotRing *ring, const struct GameInstance *game, int tick)
+{
+    ring->lastId = 0;
+    ring->count = 1;
+    SaveGameSnapshot(&ring->snapshots[0], game, tick);
+}
+
+void CaptureGameSnapshot(struct SnapshotRing *ring, const struct GameInstance *game)
+{
+    const int tick = ring->snapshots[ring->lastId].tick + 1;
+
+    ring->lastId = (ring->lastId + 1)%SNAPSHOT_RING_TICKS_COUNT;
+    if (ring->count < SNAPSHOT_RING_TICKS_COUNT) ring->count += 1;
+    SaveGameSnapshot(&ring->snapshots[ring->lastId], game, tick);
+}
+
+// Restore the state captured ticks ago, it becomes the last snapshot of the ring
+// NOTE: The oldest snapshot is never dropped, so the ring can be rewound again after being emptied
+int RewindGameSnapshot(struct SnapshotRing *ring, int ticks, struct GameInstance *game)
+{
+    if (ticks > ring->count - 1) ticks = ring->count - 1;
+    if (ticks < 0) ticks = 0;
+
+    ring->lastId = (ring->lastId - ticks + SNAPSHOT_RING_TICKS_COUNT)%SNAPSHOT_RING_TICKS_COUNT;
+    ring->count -= ticks;
+    RestoreGameSnapshot(&ring->snapshots[ring->lastId], game);
+
+    return ring->snapshots[ring->lastId].tick;
+}
+
+bool SaveSnapshotRing(const char *fileName, const struct SnapshotRing *ring)
+{
+    FILE *file = fopen(fileName, "wb");
+    if (file == NULL) return false;
+
+    bool success = (fwrite("SFSR", 1, 4, file) == 4) &&
+                   WriteU32(file, SNAPSHOT_RING_VERSION) &&
+                   WriteU32(file, (unsigned int)sizeof(struct GameSnapshot)) &&
+                   WriteU32(file, (unsigned int)ring->count);
+
+    const int firstId = (ring->lastId - ring->count + 1 + SNAPSHOT_RING_TICKS_COUNT)%SNAPSHOT_RING_TICKS_COUNT;
+    for (int i = 0; success && (i < ring->count); i += 1)
+    {
+        const struct GameSnapshot *snapshot = &ring->snapshots[(firstId + i)%SNAPSHOT_RING_TICKS_COUNT];
+        success = (fwrite(snapshot, sizeof(struct GameSnapshot), 1, file) == 1);
+    }
+
+    success = (fclose(file) == 0) && success;
+    if (!success) remove(fileName);
+
+    return success;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+bool WriteU32(FILE *file, unsigned int value)
+{
+    const unsigned char bytes[4] = { (unsigned char)value, (unsigned char)(value >> 8), (unsigned char)(value >> 16), (unsigned char)(value >> 24) };
+    return (fwrite(bytes, 1, 4, file) == 4);
+}
@@ -0,0 +1,69 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Game snapshots
+*
+*   A snapshot is the complete state of a game: a GameInstance (game state, player, camera and
+*   the bridges lit in the stage constellation) copied as a flat blob, it has no pointers inside.
+*   Constellations are not copied, they are read-only pack data referenced by id.
+*
+*   Snapshots of the last SNAPSHOT_RING_TICKS_COUNT ticks are kept in a fixed-size ring, captured
+*   after every tick: the game can be rewound to any of them, instantly. Capture is a single copy
+*   into the ring, no allocations, so it can always be on (practice rewind, crash forensics).
+*
+*   Snapshot ring file (version 1), every number is a u32 little-endian:
+*
+*       char[4]     magic "SFSR"
+*       u32         version, snapshot size in bytes, snapshots count
+*       snapshots   struct GameSnapshot copied as is, oldest first
+*
+*   NOTE: Ring files are bound to the build that saved them (struct layout), check snapshot size
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include "game.h"                           // Required for: struct GameInstance
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SNAPSHOT_RING_VERSION 1
+#define SNAPSHOT_RING_TICKS_COUNT 600       // Ticks kept by a ring, 10 seconds at GAME_TICK_SECONDS
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct GameSnapshot {
+    int tick;                           // Ticks played when captured (0 before the first tick)
+    struct GameInstance game;
+};
+
+struct SnapshotRing {
+    struct GameSnapshot snapshots[SNAPSHOT_RING_TICKS_COUNT];
+    int lastId;                         // Slot of the last snapshot captured
+    int count;                          // Snapshots in the ring, up to SNAPSHOT_RING_TICKS_COUNT
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+void SaveGameSnapshot(struct GameSnapshot *snapshot, const struct GameInstance *game, int tick);     // Copy game state into a snapshot
+void RestoreGameSnapshot(const struct GameSnapshot *snapshot, struct GameInstance *game);           // Copy snapshot into game state
+void InitSnapshotRing(struct SnapshotRing *ring, const struct GameInstance *game, int tick);        // Start a ring with the state at a tick (0 before the first tick)
+void CaptureGameSnapshot(struct SnapshotRing *ring, const struct GameInstance *game);               // Capture the state after one more tick
+int RewindGameSnapshot(struct SnapshotRing *ring, int ticks, struct GameInstance *game);            // Restore the state ticks ago (at most the oldest kept), drop newer ones, returns restored tick
+bool SaveSnapshotRing(const char *fileName, const struct SnapshotRing *ring);                      // Save ring snapshots, oldest first
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SNAPSHOT_H
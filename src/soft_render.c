@@ -0,0 +1,629 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Software renderer frontend
+*
+*   Plays a scripted session (same input track as raylib_game --bench) and draws every frame
+*   with the CPU software renderer (softrender.h) into a 256x256 RGBA buffer, mirroring the
+*   raylib frontend draw code. No window or OpenGL context is created, so it runs on machines
+*   without a GPU or display: used for rendering throughput and golden image checks.
+*
+*   Build and run:
+*       make soft_render && ./soft_render [frames] [--save frame.png] [--golden frame.png]
+*
+*       --save      Export the last frame as PNG
+*       --golden    Compare the last frame against a PNG, fail on any different pixel
+*
+*   NOTE: raylib is only used for CPU side asset loading (images, font atlas) and TextFormat(),
+*   debug mode overlays are not drawn
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "raylib.h"
+
+#include "game.h"                           // Game simulation: GameInstance, GameStep()
+#include "render.h"                         // Rendering constants: sprites, minimap, palette
+#include "softrender.h"                     // Software renderer: SoftCanvas, SoftDraw*()
+
+#if defined(SUPPORT_BAKED_ASSETS)
+    #include "baked_assets.h"               // Baked assets: spritesheet pixels, font atlases (generated by asset_baker)
+#endif
+
+#include <math.h>                           // Required for: floorf()
+#include <stdio.h>                          // Required for: printf()
+#include <stdlib.h>                         // Required for: atoi()
+#include <string.h>                         // Required for: strcmp(), memcpy()
+#include <time.h>                           // Required for: clock()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SOFT_RENDER_DEFAULT_FRAMES 10000
+#define SOFT_RENDER_SEED 1                  // Same seed as raylib_game benchmark mode
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static struct SoftCanvas screen = { 0 };
+static struct SoftCanvas spritesheet = { 0 };
+static struct SoftCanvas fontAtlases[FONT_SIZES_COUNT] = { 0 };
+static Font fonts[FONT_SIZES_COUNT] = { 0 };        // One font per size drawn, same as raylib frontend
+
+// Background layer: background color and all the OFF stars, covering every screen the camera can show
+static struct SoftCanvas backgroundLayer = { 0 };
+static Vector2 backgroundLayerOrigin = { 0 };       // World position of the layer top left pixel
+
+// Minimap is retained: redrawn only when the constellation shown or its bridges change
+static struct SoftCanvas minimap = { 0 };
+static bool minimapValid = false;
+static int minimapConstellationId = -1;
+static unsigned int minimapBridgesVersion = 0;
+
+static Vector2 cameraOffset = { 0 };                // World to screen translation of the frame being drawn
+
+static const Color palette[6] = {
+    PALETTE_COLOR_0,
+    PALETTE_COLOR_1,
+    PALETTE_COLOR_2,
+    PALETTE_COLOR_3,
+    PALETTE_COLOR_4,
+    PALETTE_COLOR_5,
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static bool LoadSoftAssets(void);
+static void UnloadSoftAssets(void);
+static struct InputFrame GetScriptedInputFrame(int frame);
+static int CompareGoldenImage(const char *fileName);
+
+static void DrawFrame(const struct GameInstance *game, float alpha);
+static void DrawSprite(struct SoftCanvas *canvas, int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position);
+static void DrawStar(struct SoftCanvas *canvas, int x, int y, int frameNumber);
+static void DrawBackground(void);
+static void DrawBridges(const struct GameInstance *game);
+static void DrawPlayer(const struct Player *player, Vector2 position);
+static void DrawStagePanel(const struct GameInstance *game);
+static void DrawFontText(const char *text, Vector2 position, float fontSize, float spacing, Color color);
+static void UpdateMinimap(const struct GameInstance *game);
+static Vector2 GetScreenPosition(Vector2 position);
+static Vector2 GetMinimapStarPosition(int x, int y);
+
+//------------------------------------------------------------------------------------
+// Program main entry point
+//------------------------------------------------------------------------------------
+int main(int argc, char *argv[])
+{
+    int framesCount = SOFT_RENDER_DEFAULT_FRAMES;
+    const char *saveFileName = NULL;
+    const char *goldenFileName = NULL;
+    for (int i = 1; i < argc; i += 1)
+    {
+        if ((strcmp(argv[i], "--save") == 0) && (i + 1 < argc)) saveFileName = argv[++i];
+        else if ((strcmp(argv[i], "--golden") == 0) && (i + 1 < argc)) goldenFileName = argv[++i];
+        else if (atoi(argv[i]) > 0) framesCount = atoi(argv[i]);
+        else
+        {
+            printf("Usage: %s [frames] [--save frame.png] [--golden frame.png]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    SetTraceLogLevel(LOG_WARNING);
+
+    if (!LoadConstellations("resources/constellations.sfcp") || !LoadSoftAssets())
+    {
+        printf("Failed to load resources\n");
+        return 1;
+    }
+
+    static struct GameInstance game = { 0 };
+    InitGameInstance(&game, SOFT_RENDER_SEED);
+
+    // NOTE: Every frame runs exactly one tick, as raylib_game benchmark mode
+    double renderSeconds = 0.0;
+    for (int frame = 0; frame < framesCount; frame += 1)
+    {
+        const struct InputFrame input = GetScriptedInputFrame(frame);
+        GameStep(&game, &input, GAME_TICK_SECONDS);
+
+        const clock_t start = clock();
+        DrawFrame(&game, 0.0f);
+        renderSeconds += (double)(clock() - start)/CLOCKS_PER_SEC;
+    }
+
+    printf("%i frames rendered in %.3fs (%.0f fps, %.4f ms/frame)\n", framesCount, renderSeconds,
+           (renderSeconds > 0.0)? framesCount/renderSeconds : 0.0, 1000.0*renderSeconds/framesCount);
+
+    int result = 0;
+    const Image frameImage = { screen.pixels, screen.width, screen.height, 1, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8 };
+    if ((saveFileName != NULL) && !ExportImage(frameImage, saveFileName))
+    {
+        printf("Failed to save %s\n", saveFileName);
+        result = 1;
+    }
+
+    if (goldenFileName != NULL)
+    {
+        const int differentCount = CompareGoldenImage(goldenFileName);
+        if (differentCount == 0)
+        {
+            printf("Golden image %s: match\n", goldenFileName);
+        } else
+        {
+            if (differentCount < 0) printf("Golden image %s: invalid image\n", goldenFileName);
+            else printf("Golden image %s: %i pixels differ\n", goldenFileName, differentCount);
+            result = 1;
+        }
+    }
+
+    UnloadSoftAssets();
+    UnloadConstellations();
+
+    return result;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Load canvases, spritesheet and font atlases as RGBA8 images
+// NOTE: Fonts are loaded as raylib LoadFontEx() does, so glyph metrics are the same
+bool LoadSoftAssets(void)
+{
+    bool success = true;
+
+#if defined(SUPPORT_BAKED_ASSETS)
+    success = LoadSoftCanvasFromPixels(&spritesheet, bakedSpritesheetData, BAKED_SPRITESHEET_WIDTH, BAKED_SPRITESHEET_HEIGHT);
+
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
+    {
+        const struct BakedFont *baked = &bakedFonts[i];
+        fonts[i].baseSize = baked->size;
+        fonts[i].glyphCount = FONT_GLYPH_COUNT;
+        fonts[i].glyphPadding = FONT_GLYPH_PADDING;
+        fonts[i].recs = baked->recs;
+        fonts[i].glyphs = baked->glyphs;
+
+        Image atlas = ImageCopy((Image){ (void *)baked->atlasData, baked->atlasWidth, baked->atlasHeight, 1, baked->atlasFormat });
+        ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        success = success && (atlas.data != NULL) && LoadSoftCanvasFromPixels(&fontAtlases[i], atlas.data, atlas.width, atlas.height);
+        UnloadImage(atlas);
+    }
+#else
+    Image image = LoadImage(SPRITESHEET_FILE_NAME);
+    if (image.data == NULL) return false;
+    ImageFormat(&image, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+    success = LoadSoftCanvasFromPixels(&spritesheet, image.data, image.width, image.height);
+    UnloadImage(image);
+
+    int fileSize = 0;
+    unsigned char *fileData = LoadFileData(FONT_FILE_NAME, &fileSize);
+    if (fileData == NULL) return false;
+
+    const int sizes[FONT_SIZES_COUNT] = FONT_SIZES;
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
+    {
+        fonts[i].baseSize = sizes[i];
+        fonts[i].glyphCount = FONT_GLYPH_COUNT;
+        fonts[i].glyphPadding = FONT_GLYPH_PADDING;
+        fonts[i].glyphs = LoadFontData(fileData, fileSize, sizes[i], NULL, FONT_GLYPH_COUNT, FONT_DEFAULT);
+        if (fonts[i].glyphs == NULL)
+        {
+            success = false;
+            continue;
+        }
+
+        Image atlas = GenImageFontAtlas(fonts[i].glyphs, &fonts[i].recs, FONT_GLYPH_COUNT, sizes[i], FONT_GLYPH_PADDING, 0);
+        ImageFormat(&atlas, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+        success = success && (atlas.data != NULL) && LoadSoftCanvasFromPixels(&fontAtlases[i], atlas.data, atlas.width, atlas.height);
+        UnloadImage(atlas);
+    }
+    UnloadFileData(fileData);
+#endif
+
+    success = success && LoadSoftCanvas(&screen, SCREEN_WIDTH_PIXELS, SCREEN_HEIGHT_PIXELS);
+    success = success && LoadSoftCanvas(&minimap, MINIMAP_WIDTH_PIXELS, MINIMAP_HEIGHT_PIXELS);
+
+    // Camera target follows the player, it stays between the first and the last star positions
+    const Vector2 firstStar = GetStarPosition(0, 0);
+    const Vector2 lastStar = GetLastStarPosition();
+    backgroundLayerOrigin = (Vector2){ firstStar.x - SCREEN_WIDTH_PIXELS/2.0f, firstStar.y - SCREEN_HEIGHT_PIXELS/2.0f };
+    success = success && LoadSoftCanvas(&backgroundLayer, (int)(lastStar.x - firstStar.x) + SCREEN_WIDTH_PIXELS,
+                                        (int)(lastStar.y - firstStar.y) + SCREEN_HEIGHT_PIXELS);
+    if (success)
+    {
+        SoftClearBackground(&backgroundLayer, palette[5]);
+
+        cameraOffset = (Vector2){ -backgroundLayerOrigin.x, -backgroundLayerOrigin.y };
+        const struct ConstellationPack *pack = GetConstellationPack();
+        for (int y = 0; y < pack->starCountY; y += 1)
+        {
+            for (int x = 0; x < pack->starCountX; x += 1)
+            {
+                DrawStar(&backgroundLayer, x, y, STAR_SPRITE_OFF);
+            }
+        }
+    }
+
+    return success;
+}
+
+void UnloadSoftAssets(void)
+{
+    UnloadSoftCanvas(&backgroundLayer);
+    UnloadSoftCanvas(&minimap);
+    UnloadSoftCanvas(&screen);
+    UnloadSoftCanvas(&spritesheet);
+    for (int i = 0; i < FONT_SIZES_COUNT; i += 1)
+    {
+        UnloadSoftCanvas(&fontAtlases[i]);
+#if !defined(SUPPORT_BAKED_ASSETS)
+        UnloadFontData(fonts[i].glyphs, fonts[i].glyphCount);
+        MemFree(fonts[i].recs);
+#endif
+    }
+}
+
+// Get input frame of the scripted input track
+// NOTE: Same track as raylib_game GetBenchInputFrame(), so both frontends draw the same session
+struct InputFrame GetScriptedInputFrame(int frame)
+{
+    const unsigned int directions[8] = {
+        INPUT_BUTTON_RIGHT, INPUT_BUTTON_RIGHT | INPUT_BUTTON_DOWN,
+        INPUT_BUTTON_DOWN, INPUT_BUTTON_DOWN | INPUT_BUTTON_LEFT,
+        INPUT_BUTTON_LEFT, INPUT_BUTTON_LEFT | INPUT_BUTTON_UP,
+        INPUT_BUTTON_UP, INPUT_BUTTON_UP | INPUT_BUTTON_RIGHT
+    };
+
+    struct InputFrame input = { directions[(frame/90)%8] };
+    if (frame%120 == 60) input.buttons |= INPUT_BUTTON_BOOST;
+    if (frame%20 == 0) input.buttons |= INPUT_BUTTON_GRAB;
+    if (frame%600 == 0) input.buttons |= INPUT_BUTTON_RESTART;
+
+    return input;
+}
+
+// Count the pixels of the last frame different from a golden image, -1 if the image is not valid
+int CompareGoldenImage(const char *fileName)
+{
+    Image golden = LoadImage(fileName);
+    if (golden.data == NULL) return -1;
+    ImageFormat(&golden, PIXELFORMAT_UNCOMPRESSED_R8G8B8A8);
+
+    int differentCount = -1;
+    if ((golden.width == screen.width) && (golden.height == screen.height))
+    {
+        const unsigned char *goldenPixels = (const unsigned char *)golden.data;
+        differentCount = 0;
+        for (int i = 0; i < screen.width*screen.height; i += 1)
+        {
+            // NOTE: Canvas pixels are RGBA8 bytes in memory on little-endian hosts
+            unsigned int pixel = 0;
+            memcpy(&pixel, &goldenPixels[4*i], 4);
+            if (pixel != screen.pixels[i]) differentCount += 1;
+        }
+    }
+
+    UnloadImage(golden);
+    return differentCount;
+}
+
+// Draw one frame into the screen canvas, same layers and order as raylib_game UpdateDrawFrame()
+void DrawFrame(const struct GameInstance *game, float alpha)
+{
+    const Vector2 playerPosition = GetInterpolatedPlayerPosition(game, alpha);
+
+    // Camera has no rotation or zoom, world to screen is a translation
+    const Camera2D camera = game->camera;
+    const Vector2 cameraTarget = GetInterpolatedCameraTarget(game, alpha);
+    cameraOffset = (Vector2){ camera.offset.x - cameraTarget.x, camera.offset.y - cameraTarget.y };
+
+    const struct GameState *gameState = &game->gameState;
+
+    switch (gameState->state)
+    {
+        case GAMESTATE_START:
+        {
+            DrawBackground();
+            DrawPlayer(&game->player, playerPosition);
+        } break;
+        case GAMESTATE_GAMEPLAY:
+        case GAMESTATE_CLEAR:
+        {
+            DrawBackground();
+            DrawBridges(game);
+            DrawPlayer(&game->player, playerPosition);
+        } break;
+        case GAMESTATE_RESULT:
+        {
+            // Only the background color is drawn
+            SoftClearBackground(&screen, palette[5]);
+        } break;
+    }
+
+    switch (gameState->state)
+    {
+        case GAMESTATE_START:
+        {
+            if ((gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 4.0f))
+            {
+                const int seconds = (int)gameState->clockSeconds;
+                DrawFontText(TextFormat("%i", 4 - seconds), (Vector2){ 100, 160 }, 60, 1.0f, palette[0]);
+            }
+            DrawStagePanel(game);
+        } break;
+        case GAMESTATE_GAMEPLAY:
+        {
+            if ((gameState->clockSeconds >= 0.0f) && (gameState->clockSeconds <= 1.5f))
+            {
+                DrawFontText("START", (Vector2){ 40, 170 }, 40, 1.0f, palette[0]);
+            }
+            DrawStagePanel(game);
+        } break;
+        case GAMESTATE_CLEAR:
+        {
+            if ((gameState->clockSeconds >= 1.0f) && (gameState->clockSeconds <= 5.0f))
+            {
+                DrawFontText("CLEAR", (Vector2){ 40, 170 }, 40, 1.0f, palette[0]);
+            }
+            DrawStagePanel(game);
+        } break;
+        case GAMESTATE_RESULT:
+        {
+            if (gameState->clockSeconds >= 1.0f)
+            {
+                const int stageId = (int)(gameState->clockSeconds - 1.0f);
+                const int max = (stageId < GAMESTATE_STAGES_COUNT - 1)? stageId : GAMESTATE_STAGES_COUNT - 1;
+                for (int i = 0; i <= max; i += 1)
+                {
+                    int seconds = (int)(gameState->stages[i].timerSeconds);
+                    const int minutes = seconds/60;
+                    seconds -= minutes*60;
+                    DrawFontText(TextFormat("STAGE %i: %02i:%02i", i + 1, minutes, seconds), (Vector2){ 20, 40 + 30*i }, 20, 1.0f, palette[0]);
+                }
+            }
+
+            if ((gameState->clockSeconds >= 5.0f) && (gameState->clockSeconds - (int)(gameState->clockSeconds) >= 0.5f))
+            {
+                DrawFontText("  PRESS (R)  ", (Vector2){ 40, 210 }, 20, 1.0f, palette[0]);
+                DrawFontText("TO PLAY AGAIN", (Vector2){ 15, 230 }, 20, 1.0f, palette[0]);
+            }
+        } break;
+    }
+
+    if (gameState->state != GAMESTATE_RESULT)
+    {
+        UpdateMinimap(game);
+        SoftDrawTextureRec(&screen, &minimap, (Rectangle){ 0, 0, MINIMAP_WIDTH_PIXELS, MINIMAP_HEIGHT_PIXELS },
+                           (Vector2){ SCREEN_WIDTH_PIXELS - MINIMAP_WIDTH_PIXELS - 5, 5 });
+    }
+}
+
+// Draw a spritesheet frame centered at a world position
+void DrawSprite(struct SoftCanvas *canvas, int spriteOffsetX, int spriteOffsetY, int spriteWidth, int spriteHeight, int frameNumber, Vector2 position)
+{
+    const Rectangle source = { spriteOffsetX + frameNumber*spriteWidth, spriteOffsetY, spriteWidth, spriteHeight };
+    const Vector2 screenPosition = GetScreenPosition(position);
+
+    SoftDrawTextureRec(canvas, &spritesheet, source, (Vector2){ screenPosition.x - spriteWidth/2.0f, screenPosition.y - spriteHeight/2.0f });
+}
+
+void DrawStar(struct SoftCanvas *canvas, int x, int y, int frameNumber)
+{
+    DrawSprite(canvas, SPRITESHEET_STAR_OFFSET_X_PIXELS, SPRITESHEET_STAR_OFFSET_Y_PIXELS,
+               STAR_SPRITE_WIDTH_PIXELS, STAR_SPRITE_HEIGHT_PIXELS,
+               frameNumber,
+               GetStarPosition(x, y));
+}
+
+// Copy the visible part of the background layer, it is opaque so rows are copied as they are
+void DrawBackground(void)
+{
+    const int layerX = (int)floorf(-cameraOffset.x - backgroundLayerOrigin.x + 0.5f);
+    const int layerY = (int)floorf(-cameraOffset.y - backgroundLayerOrigin.y + 0.5f);
+
+    const int x0 = (layerX < 0)? -layerX : 0;
+    const int y0 = (layerY < 0)? -layerY : 0;
+    int x1 = backgroundLayer.width - layerX;
+    int y1 = backgroundLayer.height - layerY;
+    if (x1 > screen.width) x1 = screen.width;
+    if (y1 > screen.height) y1 = screen.height;
+
+    // Camera smooth follow might show a few pixels past the layer
+    if ((x0 > 0) || (y0 > 0) || (x1 < screen.width) || (y1 < screen.height)) SoftClearBackground(&screen, palette[5]);
+    if ((x1 <= x0) || (y1 <= y0)) return;
+
+    for (int y = y0; y < y1; y += 1)
+    {
+        memcpy(&screen.pixels[y*screen.width + x0],
+               &backgroundLayer.pixels[(layerY + y)*backgroundLayer.width + layerX + x0],
+               (size_t)(x1 - x0)*sizeof(unsigned int));
+    }
+}
+
+void DrawBridges(const struct GameInstance *game)
+{
+    struct ConstellationView constellation = { 0 };
+    if (!GetGameConstellation(game, &constellation)) return;
+
+    for (int i = 0; i < constellation.bridgesCount; i += 1)
+    {
+        const enum BridgeState state = GetGameBridgeState(game, &constellation, i);
+        if ((state == BRIDGE_ON) || (state == BRIDGE_ON_DEFAULT))
+        {
+            const struct ConstellationBridge bridge = GetConstellationViewBridge(&constellation, i);
+            SoftDrawLineEx(&screen,
+                           GetScreenPosition(GetStarPosition(bridge.x1, bridge.y1)),
+                           GetScreenPosition(GetStarPosition(bridge.x2, bridge.y2)),
+                           CONSTELLATION_BRIDGE_LINE_THICKNESS, palette[0]);
+        }
+    }
+
+    // NOTE: Every lit star is drawn once, as raylib_game DrawBridges(): by the first lit bridge touching it
+    for (int i = 0; i < constellation.bridgesCount; i += 1)
+    {
+        const enum BridgeState state = GetGameBridgeState(game, &constellation, i);
+        if ((state == BRIDGE_ON) || (state == BRIDGE_ON_DEFAULT))
+        {
+            const struct ConstellationBridge bridge = GetConstellationViewBridge(&constellation, i);
+            const int starsX[2] = { bridge.x1, bridge.x2 };
+            const int starsY[2] = { bridge.y1, bridge.y2 };
+            for (int j = 0; j < 2; j += 1)
+            {
+                if ((j == 1) && (starsX[1] == starsX[0]) && (starsY[1] == starsY[0])) break;
+
+                const int *bridgeIds = NULL;
+                const int count = GetStarBridges(&constellation.index, starsX[j], starsY[j], &bridgeIds);
+
+                bool isDrawn = false;
+                for (int k = 0; (k < count) && !isDrawn; k += 1)
+                {
+                    const enum BridgeState otherState = GetGameBridgeState(game, &constellation, bridgeIds[k]);
+                    isDrawn = (bridgeIds[k] < i) && ((otherState == BRIDGE_ON) || (otherState == BRIDGE_ON_DEFAULT));
+                }
+
+                if (!isDrawn) DrawStar(&screen, starsX[j], starsY[j], STAR_SPRITE_ON);
+            }
+        }
+    }
+}
+
+// NOTE: Sprite selection must match raylib_game DrawPlayer()
+void DrawPlayer(const struct Player *player, Vector2 position)
+{
+    if (player->isGrabbingStar)
+    {
+        // Draw dragged bridge
+        const Vector2 grabbedStarPos = GetStarPosition(player->grabbedStarX, player->grabbedStarY);
+        SoftDrawLineEx(&screen,
+                       GetScreenPosition(grabbedStarPos),
+                       GetScreenPosition((Vector2){ position.x, position.y + 10 }),
+                       CONSTELLATION_BRIDGE_LINE_THICKNESS, palette[0]);
+
+        // Draw star at beginning of path
+        DrawStar(&screen, player->grabbedStarX, player->grabbedStarY, STAR_SPRITE_ON);
+    }
+
+    int spriteOffsetX = SPRITESHEET_FROG_OFFSET_X_PIXELS;
+    if (player->state == PLAYER_STUNNED)
+    {
+        spriteOffsetX += 4*PLAYER_SPRITE_WIDTH_PIXELS;
+    } else if (player->isGrabbingStar)
+    {
+        spriteOffsetX += 2*PLAYER_SPRITE_WIDTH_PIXELS;
+    }
+
+    if (player->flappingUp)
+    {
+        spriteOffsetX += PLAYER_SPRITE_WIDTH_PIXELS;
+    }
+
+    int spriteOffsetY = SPRITESHEET_FROG_OFFSET_Y_PIXELS;
+    if (player->isFacingRight)
+    {
+        spriteOffsetY += PLAYER_SPRITE_HEIGHT_PIXELS;
+    }
+
+    DrawSprite(&screen, spriteOffsetX, spriteOffsetY, PLAYER_SPRITE_WIDTH_PIXELS, PLAYER_SPRITE_HEIGHT_PIXELS, 0, position);
+}
+
+// NOTE: Layout must match raylib_game DrawStagePanel()
+void DrawStagePanel(const struct GameInstance *game)
+{
+    const float roundness = 0.5f;
+
+    const int fontSize = 10;
+    const int fontPosY = SCREEN_HEIGHT_PIXELS - 16;
+
+    const int recPosY = SCREEN_HEIGHT_PIXELS - 20;
+    const int recHeight = 16;
+
+    const struct GameState *gameState = &game->gameState;
+    const struct GameStateStage *stage = &gameState->stages[gameState->stageId];
+
+    // Clock panel
+    SoftDrawRectangleRounded(&screen, (Rectangle){ 4, recPosY, 76, recHeight }, roundness, palette[3]);
+
+    int seconds = (gameState->state == GAMESTATE_GAMEPLAY)? (int)(gameState->clockSeconds) : 0;
+    const int minutes = seconds/60;
+    seconds -= minutes*60;
+    DrawFontText(TextFormat("TIME: %02i:%02i", minutes, seconds), (Vector2){ 7, fontPosY }, fontSize - 2, roundness, palette[0]);
+
+    // Stage panel
+    SoftDrawRectangleRounded(&screen, (Rectangle){ SCREEN_WIDTH_PIXELS/2 - 42, recPosY, 77, recHeight }, roundness, palette[3]);
+    DrawFontText(TextFormat("STAGE: %i", gameState->stageId + 1), (Vector2){ SCREEN_WIDTH_PIXELS/2 - 36, fontPosY }, fontSize, 1.0f, palette[0]);
+
+    // Score panel
+    SoftDrawRectangleRounded(&screen, (Rectangle){ SCREEN_WIDTH_PIXELS - 87, recPosY, 86, recHeight }, roundness, palette[3]);
+    if (stage->constellationId == -1)
+    {
+        DrawFontText(TextFormat("SCORE: %02i-??", 0), (Vector2){ SCREEN_WIDTH_PIXELS - 85, fontPosY }, fontSize - 2, 1.0f, palette[0]);
+    } else
+    {
+        DrawFontText(TextFormat("SCORE: %02i-%02i", stage->score, stage->requiredScore), (Vector2){ SCREEN_WIDTH_PIXELS - 85, fontPosY }, fontSize - 2, 1.0f, palette[0]);
+    }
+}
+
+// Draw text with the font rasterized at its size, same font choice as raylib frontend GetFont()
+void DrawFontText(const char *text, Vector2 position, float fontSize, float spacing, Color color)
+{
+    int i = 0;
+    while ((i < FONT_SIZES_COUNT - 1) && (fonts[i].baseSize < fontSize)) i += 1;
+
+    SoftDrawTextEx(&screen, fonts[i], &fontAtlases[i], text, position, fontSize, spacing, color);
+}
+
+// Redraw the minimap canvas, only if the constellation shown or its bridges changed
+void UpdateMinimap(const struct GameInstance *game)
+{
+    const struct GameState *gameState = &game->gameState;
+
+    // Constellation is only displayed once the stage gameplay starts
+    int constellationId = -1;
+    if ((gameState->state == GAMESTATE_GAMEPLAY) || (gameState->state == GAMESTATE_CLEAR))
+    {
+        constellationId = gameState->stages[gameState->stageId].constellationId;
+    }
+
+    if (minimapValid && (minimapConstellationId == constellationId) && (minimapBridgesVersion == game->bridgesVersion)) return;
+
+    minimapValid = true;
+    minimapConstellationId = constellationId;
+    minimapBridgesVersion = game->bridgesVersion;
+
+    SoftClearBackground(&minimap, palette[0]);
+    SoftDrawRectangleRec(&minimap,
+                         (Rectangle){ MINIMAP_BORDER_PIXELS, MINIMAP_BORDER_PIXELS,
+                                      MINIMAP_WIDTH_PIXELS - 2*MINIMAP_BORDER_PIXELS, MINIMAP_HEIGHT_PIXELS - 2*MINIMAP_BORDER_PIXELS },
+                         palette[4]);
+
+    struct ConstellationView constellation = { 0 };
+    if ((constellationId == -1) || !GetGameConstellation(game, &constellation)) return;
+
+    for (int i = 0; i < constellation.bridgesCount; i += 1)
+    {
+        const enum BridgeState state = GetGameBridgeState(game, &constellation, i);
+        if (state == BRIDGE_DISABLED) continue;
+
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(&constellation, i);
+        const Vector2 star1Pos = GetMinimapStarPosition(bridge.x1, bridge.y1);
+        const Vector2 star2Pos = GetMinimapStarPosition(bridge.x2, bridge.y2);
+
+        SoftDrawLineEx(&minimap, star1Pos, star2Pos, 1.0f, ((state == BRIDGE_ON) || (state == BRIDGE_ON_DEFAULT))? palette[1] : palette[3]);
+
+        SoftDrawCircleV(&minimap, star1Pos, 1.0f, palette[1]);
+        SoftDrawCircleV(&minimap, star2Pos, 1.0f, palette[1]);
+    }
+}
+
+Vector2 GetScreenPosition(Vector2 position)
+{
+    return (Vector2){ position.x + cameraOffset.x, position.y + cameraOffset.y };
+}
+
+Vector2 GetMinimapStarPosition(int x, int y)
+{
+    return (Vector2){ (x + 1)*MINIMAP_STAR_SPACING_PIXELS, (y + 1)*MINIMAP_STAR_SPACING_PIXELS };
+}
@@ -0,0 +1,400 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Software renderer
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "softrender.h"
+
+#include <math.h>                           // Required for: sqrtf(), ceilf(), floorf(), fminf(), fmaxf()
+#include <stdlib.h>                         // Required for: calloc(), malloc(), free()
+#include <string.h>                         // Required for: memcpy()
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+    #define SOFTRENDER_SSE2
+    #include <emmintrin.h>                  // Required for: SSE2 intrinsics
+#endif
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int GetPixelFromColor(Color color);
+static unsigned int BlendPixel(unsigned int dst, unsigned int src);
+static unsigned int TintPixel(unsigned int pixel, unsigned int tint);
+static void FillSpan(unsigned int *dst, int count, unsigned int pixel);
+static void BlendSpan(unsigned int *dst, int count, unsigned int pixel);
+static void BlitSpan(unsigned int *dst, const unsigned int *src, int count);
+static void DrawRowSpan(struct SoftCanvas *canvas, int y, float x0, float x1, unsigned int pixel);
+static void DrawConvexPolygon(struct SoftCanvas *canvas, const Vector2 *points, int pointsCount, unsigned int pixel);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool LoadSoftCanvas(struct SoftCanvas *canvas, int width, int height)
+{
+    canvas->width = width;
+    canvas->height = height;
+    canvas->pixels = (unsigned int *)calloc((size_t)width*height, sizeof(unsigned int));
+    return (canvas->pixels != NULL);
+}
+
+bool LoadSoftCanvasFromPixels(struct SoftCanvas *canvas, const void *pixels, int width, int height)
+{
+    if (!LoadSoftCanvas(canvas, width, height)) return false;
+    memcpy(canvas->pixels, pixels, (size_t)width*height*sizeof(unsigned int));
+    return true;
+}
+
+void UnloadSoftCanvas(struct SoftCanvas *canvas)
+{
+    free(canvas->pixels);
+    *canvas = (struct SoftCanvas){ 0 };
+}
+
+void SoftClearBackground(struct SoftCanvas *canvas, Color color)
+{
+    FillSpan(canvas->pixels, canvas->width*canvas->height, GetPixelFromColor(color));
+}
+
+void SoftDrawRectangleRec(struct SoftCanvas *canvas, Rectangle rec, Color color)
+{
+    const unsigned int pixel = GetPixelFromColor(color);
+
+    const int y0 = (int)fmaxf(ceilf(rec.y - 0.5f), 0.0f);
+    const int y1 = (int)fminf(ceilf(rec.y + rec.height - 0.5f), (float)canvas->height);
+    for (int y = y0; y < y1; y += 1) DrawRowSpan(canvas, y, rec.x, rec.x + rec.width, pixel);
+}
+
+void SoftDrawRectangleRounded(struct SoftCanvas *canvas, Rectangle rec, float roundness, Color color)
+{
+    const unsigned int pixel = GetPixelFromColor(color);
+    const float radius = ((rec.width > rec.height)? rec.height : rec.width)*roundness/2.0f;
+
+    const int y0 = (int)fmaxf(ceilf(rec.y - 0.5f), 0.0f);
+    const int y1 = (int)fminf(ceilf(rec.y + rec.height - 0.5f), (float)canvas->height);
+    for (int y = y0; y < y1; y += 1)
+    {
+        // Distance from the row center into the corners band
+        const float rowY = (float)y + 0.5f;
+        const float dy = fmaxf(rec.y + radius - rowY, rowY - (rec.y + rec.height - radius));
+
+        float inset = 0.0f;
+        if (dy > 0.0f) inset = radius - sqrtf(fmaxf(radius*radius - dy*dy, 0.0f));
+
+        DrawRowSpan(canvas, y, rec.x + inset, rec.x + rec.width - inset, pixel);
+    }
+}
+
+void SoftDrawRectangleLinesEx(struct SoftCanvas *canvas, Rectangle rec, float lineThick, Color color)
+{
+    SoftDrawRectangleRec(canvas, (Rectangle){ rec.x, rec.y, rec.width, lineThick }, color);
+    SoftDrawRectangleRec(canvas, (Rectangle){ rec.x, rec.y + rec.height - lineThick, rec.width, lineThick }, color);
+    SoftDrawRectangleRec(canvas, (Rectangle){ rec.x, rec.y + lineThick, lineThick, rec.height - 2*lineThick }, color);
+    SoftDrawRectangleRec(canvas, (Rectangle){ rec.x + rec.width - lineThick, rec.y + lineThick, lineThick, rec.height - 2*lineThick }, color);
+}
+
+void SoftDrawCircleV(struct SoftCanvas *canvas, Vector2 center, float radius, Color color)
+{
+    const unsigned int pixel = GetPixelFromColor(color);
+
+    const int y0 = (int)fmaxf(ceilf(center.y - radius - 0.5f), 0.0f);
+    const int y1 = (int)fminf(ceilf(center.y + radius - 0.5f), (float)canvas->height);
+    for (int y = y0; y < y1; y += 1)
+    {
+        const float dy = (float)y + 0.5f - center.y;
+        const float halfWidth = sqrtf(fmaxf(radius*radius - dy*dy, 0.0f));
+        DrawRowSpan(canvas, y, center.x - halfWidth, center.x + halfWidth, pixel);
+    }
+}
+
+void SoftDrawLineEx(struct SoftCanvas *canvas, Vector2 startPos, Vector2 endPos, float thick, Color color)
+{
+    const float dx = endPos.x - startPos.x;
+    const float dy = endPos.y - startPos.y;
+    const float length = sqrtf(dx*dx + dy*dy);
+    if ((length <= 0.0f) || (thick <= 0.0f)) return;
+
+    // Line is a quad, same as raylib DrawLineEx()
+    const float nx = -dy*thick/(2.0f*length);
+    const float ny = dx*thick/(2.0f*length);
+    const Vector2 points[4] = {
+        { startPos.x + nx, startPos.y + ny },
+        { endPos.x + nx, endPos.y + ny },
+        { endPos.x - nx, endPos.y - ny },
+        { startPos.x - nx, startPos.y - ny }
+    };
+    DrawConvexPolygon(canvas, points, 4, GetPixelFromColor(color));
+}
+
+void SoftDrawTextureRec(struct SoftCanvas *canvas, const struct SoftCanvas *texture, Rectangle source, Vector2 position)
+{
+    int srcX = (int)source.x;
+    int srcY = (int)source.y;
+    int width = (int)source.width;
+    int height = (int)source.height;
+    int dstX = (int)floorf(position.x + 0.5f);
+    int dstY = (int)floorf(position.y + 0.5f);
+
+    // Clip against canvas and texture
+    if (dstX < 0) { srcX -= dstX; width += dstX; dstX = 0; }
+    if (dstY < 0) { srcY -= dstY; height += dstY; dstY = 0; }
+    if (srcX < 0) { dstX -= srcX; width += srcX; srcX = 0; }
+    if (srcY < 0) { dstY -= srcY; height += srcY; srcY = 0; }
+    if (dstX + width > canvas->width) width = canvas->width - dstX;
+    if (dstY + height > canvas->height) height = canvas->height - dstY;
+    if (srcX + width > texture->width) width = texture->width - srcX;
+    if (srcY + height > texture->height) height = texture->height - srcY;
+    if ((width <= 0) || (height <= 0)) return;
+
+    for (int y = 0; y < height; y += 1)
+    {
+        BlitSpan(&canvas->pixels[(dstY + y)*canvas->width + dstX], &texture->pixels[(srcY + y)*texture->width + srcX], width);
+    }
+}
+
+void SoftDrawTexturePro(struct SoftCanvas *canvas, const struct SoftCanvas *texture, Rectangle source, Rectangle dest, Color tint)
+{
+    if ((dest.width <= 0.0f) || (dest.height <= 0.0f)) return;
+
+    const unsigned int tintPixel = GetPixelFromColor(tint);
+    const bool isTinted = (tintPixel != 0xffffffff);
+
+    const int x0 = (int)fmaxf(ceilf(dest.x - 0.5f), 0.0f);
+    const int x1 = (int)fminf(ceilf(dest.x + dest.width - 0.5f), (float)canvas->width);
+    const int y0 = (int)fmaxf(ceilf(dest.y - 0.5f), 0.0f);
+    const int y1 = (int)fminf(ceilf(dest.y + dest.height - 0.5f), (float)canvas->height);
+
+    const float scaleX = source.width/dest.width;
+    const float scaleY = source.height/dest.height;
+
+    for (int y = y0; y < y1; y += 1)
+    {
+        // Nearest texel to the pixel center
+        const int srcY = (int)(source.y + ((float)y + 0.5f - dest.y)*scaleY);
+        if ((srcY < 0) || (srcY >= texture->height)) continue;
+
+        const unsigned int *srcRow = &texture->pixels[srcY*texture->width];
+        unsigned int *dstRow = &canvas->pixels[y*canvas->width];
+
+        // Source column stepped in 16.16 fixed point
+        int srcX = (int)((source.x + ((float)x0 + 0.5f - dest.x)*scaleX)*65536.0f);
+        const int srcStepX = (int)(scaleX*65536.0f);
+        for (int x = x0; x < x1; x += 1, srcX += srcStepX)
+        {
+            if ((srcX < 0) || ((srcX >> 16) >= texture->width)) continue;
+
+            // NOTE: Font atlases are mostly fully transparent texels
+            const unsigned int texel = srcRow[srcX >> 16];
+            if ((texel >> 24) == 0) continue;
+
+            dstRow[x] = BlendPixel(dstRow[x], isTinted? TintPixel(texel, tintPixel) : texel);
+        }
+    }
+}
+
+void SoftDrawTextEx(struct SoftCanvas *canvas, Font font, const struct SoftCanvas *atlas, const char *text, Vector2 position, float fontSize, float spacing, Color tint)
+{
+    if ((font.baseSize <= 0) || (font.glyphs == NULL) || (font.recs == NULL)) return;
+
+    const float scaleFactor = fontSize/(float)font.baseSize;
+    float textOffsetX = 0.0f;
+
+    for (int i = 0; text[i] != '\0'; i += 1)
+    {
+        // NOTE: Only single byte codepoints are used by the game texts
+        const int codepoint = (unsigned char)text[i];
+
+        int index = 0;
+        for (int g = 0; g < font.glyphCount; g += 1)
+        {
+            if (font.glyphs[g].value == codepoint)
+            {
+                index = g;
+                break;
+            }
+        }
+
+        if ((codepoint != ' ') && (codepoint != '\t'))
+        {
+            const float padding = (float)font.glyphPadding;
+            const Rectangle source = {
+                font.recs[index].x - padding, font.recs[index].y - padding,
+                font.recs[index].width + 2.0f*padding, font.recs[index].height + 2.0f*padding
+            };
+            const Rectangle dest = {
+                position.x + textOffsetX + font.glyphs[index].offsetX*scaleFactor - padding*scaleFactor,
+                position.y + font.glyphs[index].offsetY*scaleFactor - padding*scaleFactor,
+                source.width*scaleFactor, source.height*scaleFactor
+            };
+            SoftDrawTexturePro(canvas, atlas, source, dest, tint);
+        }
+
+        if (font.glyphs[index].advanceX == 0) textOffsetX += font.recs[index].width*scaleFactor + spacing;
+        else textOffsetX += (float)font.glyphs[index].advanceX*scaleFactor + spacing;
+    }
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+unsigned int GetPixelFromColor(Color color)
+{
+    return (unsigned int)color.r | ((unsigned int)color.g << 8) | ((unsigned int)color.b << 16) | ((unsigned int)color.a << 24);
+}
+
+// Blend a pixel over another, BLEND_ALPHA: src*srcAlpha + dst*(1 - srcAlpha), on all channels
+unsigned int BlendPixel(unsigned int dst, unsigned int src)
+{
+    const unsigned int alpha = src >> 24;
+    if (alpha == 255) return src;
+    if (alpha == 0) return dst;
+
+    const unsigned int inverseAlpha = 255 - alpha;
+
+    // Two channels per multiply: red/blue and green/alpha
+    unsigned int rb = (src & 0x00ff00ff)*alpha + (dst & 0x00ff00ff)*inverseAlpha + 0x00800080;
+    rb = ((rb + ((rb >> 8) & 0x00ff00ff)) >> 8) & 0x00ff00ff;
+
+    unsigned int ga = ((src >> 8) & 0x00ff00ff)*alpha + ((dst >> 8) & 0x00ff00ff)*inverseAlpha + 0x00800080;
+    ga = (ga + ((ga >> 8) & 0x00ff00ff)) & 0xff00ff00;
+
+    return rb | ga;
+}
+
+// Modulate every channel of a pixel by the tint channel: x*t/255
+unsigned int TintPixel(unsigned int pixel, unsigned int tint)
+{
+    unsigned int result = 0;
+    for (int c = 0; c < 32; c += 8)
+    {
+        const unsigned int product = ((pixel >> c) & 0xff)*((tint >> c) & 0xff) + 128;
+        result |= (((product + (product >> 8)) >> 8) & 0xff) << c;
+    }
+    return result;
+}
+
+void FillSpan(unsigned int *dst, int count, unsigned int pixel)
+{
+    int i = 0;
+#if defined(SOFTRENDER_SSE2)
+    const __m128i pixels = _mm_set1_epi32((int)pixel);
+    for (; i + 16 <= count; i += 16)
+    {
+        _mm_storeu_si128((__m128i *)&dst[i], pixels);
+        _mm_storeu_si128((__m128i *)&dst[i + 4], pixels);
+        _mm_storeu_si128((__m128i *)&dst[i + 8], pixels);
+        _mm_storeu_si128((__m128i *)&dst[i + 12], pixels);
+    }
+    for (; i + 4 <= count; i += 4) _mm_storeu_si128((__m128i *)&dst[i], pixels);
+#endif
+    for (; i < count; i += 1) dst[i] = pixel;
+}
+
+// Blend a constant color over a span
+void BlendSpan(unsigned int *dst, int count, unsigned int pixel)
+{
+    const unsigned int alpha = pixel >> 24;
+    if (alpha == 255)
+    {
+        FillSpan(dst, count, pixel);
+        return;
+    }
+    if (alpha == 0) return;
+
+    int i = 0;
+#if defined(SOFTRENDER_SSE2)
+    // 16 bit lanes: (dst*(255 - alpha) + src*alpha + 128)*257 >> 16, same rounding as BlendPixel()
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i inverseAlpha = _mm_set1_epi16((short)(255 - alpha));
+    const __m128i srcTerm = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(_mm_set1_epi32((int)pixel), zero), _mm_set1_epi16((short)alpha)), _mm_set1_epi16(128));
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+        __m128i lo = _mm_add_epi16(_mm_mullo_epi16(_mm_unpacklo_epi8(d, zero), inverseAlpha), srcTerm);
+        __m128i hi = _mm_add_epi16(_mm_mullo_epi16(_mm_unpackhi_epi8(d, zero), inverseAlpha), srcTerm);
+        lo = _mm_srli_epi16(_mm_add_epi16(lo, _mm_srli_epi16(lo, 8)), 8);
+        hi = _mm_srli_epi16(_mm_add_epi16(hi, _mm_srli_epi16(hi, 8)), 8);
+        _mm_storeu_si128((__m128i *)&dst[i], _mm_packus_epi16(lo, hi));
+    }
+#endif
+    for (; i < count; i += 1) dst[i] = BlendPixel(dst[i], pixel);
+}
+
+// Blit a span of texels over a span of pixels
+// NOTE: Sprites are pixel art, most texels are fully opaque or fully transparent
+void BlitSpan(unsigned int *dst, const unsigned int *src, int count)
+{
+    int i = 0;
+#if defined(SOFTRENDER_SSE2)
+    const __m128i alphaMask = _mm_set1_epi32((int)0xff000000);
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128i s = _mm_loadu_si128((const __m128i *)&src[i]);
+        const __m128i alpha = _mm_and_si128(s, alphaMask);
+        const __m128i opaque = _mm_cmpeq_epi32(alpha, alphaMask);
+        const __m128i transparent = _mm_cmpeq_epi32(alpha, zero);
+
+        if (_mm_movemask_epi8(_mm_or_si128(opaque, transparent)) == 0xffff)
+        {
+            if (_mm_movemask_epi8(transparent) == 0xffff) continue;
+
+            const __m128i d = _mm_loadu_si128((const __m128i *)&dst[i]);
+            _mm_storeu_si128((__m128i *)&dst[i], _mm_or_si128(_mm_and_si128(opaque, s), _mm_andnot_si128(opaque, d)));
+        } else
+        {
+            for (int k = i; k < i + 4; k += 1) dst[k] = BlendPixel(dst[k], src[k]);
+        }
+    }
+#endif
+    for (; i < count; i += 1) dst[i] = BlendPixel(dst[i], src[i]);
+}
+
+// Draw the pixels of a row whose centers are in [x0, x1)
+void DrawRowSpan(struct SoftCanvas *canvas, int y, float x0, float x1, unsigned int pixel)
+{
+    if ((y < 0) || (y >= canvas->height)) return;
+
+    const int start = (int)fmaxf(ceilf(x0 - 0.5f), 0.0f);
+    const int end = (int)fminf(ceilf(x1 - 0.5f), (float)canvas->width);
+    if (end <= start) return;
+
+    BlendSpan(&canvas->pixels[y*canvas->width + start], end - start, pixel);
+}
+
+// Scanline fill a convex polygon, sampling pixel centers
+void DrawConvexPolygon(struct SoftCanvas *canvas, const Vector2 *points, int pointsCount, unsigned int pixel)
+{
+    float minY = points[0].y;
+    float maxY = points[0].y;
+    for (int i = 1; i < pointsCount; i += 1)
+    {
+        minY = fminf(minY, points[i].y);
+        maxY = fmaxf(maxY, points[i].y);
+    }
+
+    const int y0 = (int)fmaxf(ceilf(minY - 0.5f), 0.0f);
+    const int y1 = (int)fminf(ceilf(maxY - 0.5f), (float)canvas->height);
+    for (int y = y0; y < y1; y += 1)
+    {
+        const float rowY = (float)y + 0.5f;
+
+        // Intersect the row center with every edge crossing it
+        float x0 = 1e30f;
+        float x1 = -1e30f;
+        for (int i = 0; i < pointsCount; i += 1)
+        {
+            const Vector2 a = points[i];
+            const Vector2 b = points[(i + 1)%pointsCount];
+            if ((rowY < fminf(a.y, b.y)) || (rowY > fmaxf(a.y, b.y)) || (a.y == b.y)) continue;
+
+            const float x = a.x + (rowY - a.y)*(b.x - a.x)/(b.y - a.y);
+            x0 = fminf(x0, x);
+            x1 = fmaxf(x1, x);
+        }
+
+        if (x0 < x1) DrawRowSpan(canvas, y, x0, x1, pixel);
+    }
+}
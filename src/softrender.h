@@ -0,0 +1,58 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Software renderer
+*
+*   CPU rasterizer for the small set of primitives the game draws: filled rectangles
+*   (optionally rounded), circles, thick lines, sprite blits and bitmap font text.
+*   Drawing is done into RGBA8 canvases (same pixel layout as raylib PIXELFORMAT_UNCOMPRESSED_R8G8B8A8),
+*   no OpenGL context is required. Span fill, span blend and sprite blit kernels use SSE2 when available.
+*
+*   Coverage follows pixel centers (no antialiasing), blending is the raylib BLEND_ALPHA equation.
+*
+*   NOTE: This module only uses raylib types, raylib library is not required
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef SOFTRENDER_H
+#define SOFTRENDER_H
+
+#include "raylib.h"                         // Required for: Color, Vector2, Rectangle, Font
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// RGBA8 pixels buffer, used both as render target and as texture
+struct SoftCanvas {
+    int width;
+    int height;
+    unsigned int *pixels;               // width*height pixels, row major
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool LoadSoftCanvas(struct SoftCanvas *canvas, int width, int height);                     // Allocate canvas, pixels are cleared to BLANK
+bool LoadSoftCanvasFromPixels(struct SoftCanvas *canvas, const void *pixels, int width, int height);  // Allocate canvas with a copy of RGBA8 pixels
+void UnloadSoftCanvas(struct SoftCanvas *canvas);
+
+void SoftClearBackground(struct SoftCanvas *canvas, Color color);
+void SoftDrawRectangleRec(struct SoftCanvas *canvas, Rectangle rec, Color color);
+void SoftDrawRectangleRounded(struct SoftCanvas *canvas, Rectangle rec, float roundness, Color color);   // Same corner radius as raylib DrawRectangleRounded()
+void SoftDrawRectangleLinesEx(struct SoftCanvas *canvas, Rectangle rec, float lineThick, Color color);
+void SoftDrawCircleV(struct SoftCanvas *canvas, Vector2 center, float radius, Color color);
+void SoftDrawLineEx(struct SoftCanvas *canvas, Vector2 startPos, Vector2 endPos, float thick, Color color);
+void SoftDrawTextureRec(struct SoftCanvas *canvas, const struct SoftCanvas *texture, Rectangle source, Vector2 position);    // Blit texture region, no scaling or tint
+void SoftDrawTexturePro(struct SoftCanvas *canvas, const struct SoftCanvas *texture, Rectangle source, Rectangle dest, Color tint);  // Blit texture region scaled (nearest) and tinted
+void SoftDrawTextEx(struct SoftCanvas *canvas, Font font, const struct SoftCanvas *atlas, const char *text, Vector2 position, float fontSize, float spacing, Color tint);  // Same layout as raylib DrawTextEx(), atlas is the font texture image
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SOFTRENDER_H
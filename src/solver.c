@@ -0,0 +1,596 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Par time solver
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "solver.h"
+
+#include "game.h"                           // Required for: PLAYER_SPEED, PLAYER_BOOST, GAME_TICK_SECONDS, star and player sizes
+#include "jobs.h"                           // Required for: RunJobs(), GetCpuCoresCount()
+
+#include <stdlib.h>                         // Required for: malloc(), calloc(), free()
+#include <math.h>                           // Required for: fabsf()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SOLVER_MAX_THREADS JOBS_MAX_THREADS
+#define SOLVER_MEMO_CAPACITY (1 << 16)      // Transposition table entries, power of two
+#define SOLVER_INFINITE_TICKS 0x3fffffff
+#define SOLVER_SUBSET_INFINITE_TICKS 0xffff  // Subset routes ticks are 16 bit, far above SOLVER_MAX_DP_BRIDGES longest legs
+
+#define SOLVER_MAX_STEPS (2*SOLVER_MAX_SEARCH_BRIDGES)     // A step is a bridge lit in one direction: 2*bridge + direction
+#define SOLVER_START_STEP SOLVER_MAX_STEPS                 // Route start, before the first grab
+#define SOLVER_MAX_STARS (CONSTELLATION_MAX_STAR_COUNT*CONSTELLATION_MAX_STAR_COUNT)
+
+#define SOLVER_SPAWN_X (SCREEN_WIDTH_PIXELS/2.0f)          // Frog spawn position, same as ResetPlayer()
+#define SOLVER_SPAWN_Y (SCREEN_HEIGHT_PIXELS/2.0f)
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct SolverMemoEntry {
+    unsigned long long remaining;       // Bridges not lit yet
+    int lastStep;                       // Step the frog just did (where it stands)
+    int ticks;                          // Fewest ticks seen to reach this state
+};
+
+// Solver workspace, one per thread
+struct Solver {
+    int travelTicks[CONSTELLATION_MAX_STAR_COUNT];      // Leg ticks by Chebyshev star distance
+
+    int bridgesCount;
+    int stepStartStars[SOLVER_MAX_STEPS];               // Star grabbed by a step (x | y << 4)
+    int stepEndStars[SOLVER_MAX_STEPS];                 // Star dropped on by a step
+    int bridgeTicks[SOLVER_MAX_SEARCH_BRIDGES];         // Ticks from grab to drop of a bridge
+    int legTicks[SOLVER_MAX_STEPS + 1][SOLVER_MAX_STEPS];   // Ticks from a step drop to the grab of another step
+    int jumpTicks;                      // Fewest ticks of a leg between two different stars
+
+    // Remaining bridges graph, used by the lower bound (stars are x | y << 4)
+    int starStamps[SOLVER_MAX_STARS];   // Star is in the graph if its stamp is the current one
+    int starStamp;
+    int starParents[SOLVER_MAX_STARS];  // Union-find forest of the graph components
+    int starDegrees[SOLVER_MAX_STARS];
+    int componentOddStars[SOLVER_MAX_STARS];    // Odd degree stars of a component, at its root star
+
+    long long nodesCount;
+    long long nodesBudget;
+    int bestTicks;
+    struct SolverMemoEntry *memo;
+    unsigned short *subsetTicks;        // Dynamic programming table: [subset][step]
+};
+
+// Work of a solver thread: every threadsCount-th constellation from firstId
+struct SolverJob {
+    const struct ConstellationPack *pack;
+    struct ParTime *parTimes;
+    int firstId;
+    int threadsCount;
+    int nodesBudget;
+};
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static struct Solver *LoadSolver(void);
+static void UnloadSolver(struct Solver *solver);
+static struct ParTime SolveWithSolver(struct Solver *solver, const struct ConstellationView *view, float startX, float startY, int nodesBudget);
+static int GetTravelTicks(float distancePixels);
+static int GetLegTicks(const struct Solver *solver, int star1, int star2);
+static int GetStartLegTicks(float startX, float startY, int star);
+static int SolveGreedyRoute(const struct Solver *solver);
+static int SolveViewGreedyRoute(const struct Solver *solver, const struct ConstellationView *view, int bridgesCount, float startX, float startY);
+static int SolveSubsets(struct Solver *solver);
+static int GetMinGrabLegsTicks(struct Solver *solver, unsigned long long remaining, int lastStep);
+static int GetMinJumpsCount(struct Solver *solver, unsigned long long remaining, int lastStep);
+static int FindStarComponent(struct Solver *solver, int star);
+static void SearchRoutes(struct Solver *solver, unsigned long long remaining, int lastStep, int ticks, int bridgesTicks);
+static void RunSolverJob(void *data);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+struct ParTime SolveParTime(const struct ConstellationView *view, float startX, float startY, int nodesBudget)
+{
+    struct ParTime parTime = { -1, 0, false };
+
+    struct Solver *solver = LoadSolver();
+    if (solver == NULL) return parTime;
+
+    parTime = SolveWithSolver(solver, view, startX, startY, nodesBudget);
+    UnloadSolver(solver);
+
+    return parTime;
+}
+
+bool SolveParTimes(const struct ConstellationPack *pack, struct ParTime *parTimes, int threadsCount, int nodesBudget)
+{
+    if (threadsCount <= 0) threadsCount = GetCpuCoresCount();
+    if (threadsCount > SOLVER_MAX_THREADS) threadsCount = SOLVER_MAX_THREADS;
+    if (threadsCount > pack->constellationsCount) threadsCount = (pack->constellationsCount > 0)? pack->constellationsCount : 1;
+
+    for (int i = 0; i < pack->constellationsCount; i += 1) parTimes[i] = (struct ParTime){ -1, 0, false };
+
+    // NOTE: Constellations are interleaved between threads, neighbour records have similar sizes
+    struct SolverJob jobs[SOLVER_MAX_THREADS] = { 0 };
+    for (int t = 0; t < threadsCount; t += 1) jobs[t] = (struct SolverJob){ pack, parTimes, t, threadsCount, nodesBudget };
+
+    RunJobs(RunSolverJob, jobs, sizeof(struct SolverJob), threadsCount);
+
+    for (int i = 0; i < pack->constellationsCount; i += 1)
+    {
+        if (parTimes[i].ticks < 0) return false;
+    }
+    return true;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+struct Solver *LoadSolver(void)
+{
+    struct Solver *solver = (struct Solver *)calloc(1, sizeof(struct Solver));
+    if (solver == NULL) return NULL;
+
+    solver->memo = (struct SolverMemoEntry *)malloc(SOLVER_MEMO_CAPACITY*sizeof(struct SolverMemoEntry));
+    solver->subsetTicks = (unsigned short *)malloc(((size_t)1 << SOLVER_MAX_DP_BRIDGES)*2*SOLVER_MAX_DP_BRIDGES*sizeof(unsigned short));
+    if ((solver->memo == NULL) || (solver->subsetTicks == NULL))
+    {
+        UnloadSolver(solver);
+        return NULL;
+    }
+
+    for (int d = 0; d < CONSTELLATION_MAX_STAR_COUNT; d += 1) solver->travelTicks[d] = GetTravelTicks((float)(d*STAR_SPACING_PIXELS));
+
+    return solver;
+}
+
+void UnloadSolver(struct Solver *solver)
+{
+    free(solver->memo);
+    free(solver->subsetTicks);
+    free(solver);
+}
+
+struct ParTime SolveWithSolver(struct Solver *solver, const struct ConstellationView *view, float startX, float startY, int nodesBudget)
+{
+    struct ParTime parTime = { -1, 0, false };
+
+    // Bridges to light, larger constellations only get the first SOLVER_MAX_SEARCH_BRIDGES in the route tables
+    int stars[2] = { 0 };
+    int bridgesCount = 0;
+    for (int i = 0; i < view->bridgesCount; i += 1)
+    {
+        if (GetConstellationViewBridgeState(view, i) != BRIDGE_OFF_DEFAULT) continue;
+
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(view, i);
+
+        // NOTE: Route tables key stars by compact coordinates, wide pack constellations are not solved
+        if ((bridge.x1 >= CONSTELLATION_MAX_STAR_COUNT) || (bridge.y1 >= CONSTELLATION_MAX_STAR_COUNT) ||
+            (bridge.x2 >= CONSTELLATION_MAX_STAR_COUNT) || (bridge.y2 >= CONSTELLATION_MAX_STAR_COUNT)) return parTime;
+
+        stars[0] = bridge.x1 | (bridge.y1 << CONSTELLATION_COORDINATE_BITS);
+        stars[1] = bridge.x2 | (bridge.y2 << CONSTELLATION_COORDINATE_BITS);
+
+        // NOTE: A star can not be dropped onto itself, the bridge can never be lit
+        if (stars[0] == stars[1]) return parTime;
+
+        if (bridgesCount < SOLVER_MAX_SEARCH_BRIDGES)
+        {
+            for (int d = 0; d < 2; d += 1)
+            {
+                solver->stepStartStars[2*bridgesCount + d] = stars[d];
+                solver->stepEndStars[2*bridgesCount + d] = stars[1 - d];
+            }
+            solver->bridgeTicks[bridgesCount] = GetLegTicks(solver, stars[0], stars[1]);
+        }
+        bridgesCount += 1;
+    }
+
+    parTime.bridgesCount = bridgesCount;
+    parTime.isOptimal = true;
+    if (bridgesCount == 0)
+    {
+        parTime.ticks = 0;
+        return parTime;
+    }
+
+    if (bridgesCount > SOLVER_MAX_SEARCH_BRIDGES)
+    {
+        // Too large to search, the greedy route is built over the view bridges
+        parTime.ticks = SolveViewGreedyRoute(solver, view, bridgesCount, startX, startY);
+        parTime.isOptimal = false;
+        return parTime;
+    }
+
+    solver->bridgesCount = bridgesCount;
+    const int stepsCount = 2*bridgesCount;
+    for (int from = 0; from < stepsCount; from += 1)
+    {
+        for (int to = 0; to < stepsCount; to += 1) solver->legTicks[from][to] = GetLegTicks(solver, solver->stepEndStars[from], solver->stepStartStars[to]);
+    }
+
+    // NOTE: The constellation is chosen when the countdown ends, the first leg is walked on the clock
+    for (int to = 0; to < stepsCount; to += 1) solver->legTicks[SOLVER_START_STEP][to] = GetStartLegTicks(startX, startY, solver->stepStartStars[to]);
+
+    if (bridgesCount <= SOLVER_MAX_DP_BRIDGES)
+    {
+        parTime.ticks = SolveSubsets(solver);
+        return parTime;
+    }
+
+    int bridgesTicks = 0;
+    for (int j = 0; j < bridgesCount; j += 1) bridgesTicks += solver->bridgeTicks[j];
+    solver->jumpTicks = GetLegTicks(solver, 0, 1);
+
+    for (int i = 0; i < SOLVER_MEMO_CAPACITY; i += 1) solver->memo[i].lastStep = -1;
+
+    solver->nodesCount = 0;
+    solver->nodesBudget = (nodesBudget > 0)? nodesBudget : SOLVER_DEFAULT_NODES_BUDGET;
+    solver->bestTicks = SolveGreedyRoute(solver);
+
+    const unsigned long long all = (bridgesCount == 64)? ~0ULL : ((1ULL << bridgesCount) - 1);
+    SearchRoutes(solver, all, SOLVER_START_STEP, 0, bridgesTicks);
+
+    parTime.ticks = solver->bestTicks;
+    parTime.isOptimal = (solver->nodesCount <= solver->nodesBudget);
+    return parTime;
+}
+
+// Get ticks to travel between two stars distancePixels apart (Chebyshev), chaining boost jumps
+// NOTE: Same tick by tick movement as UpdatePlayer(), the leg ends once the frog overlaps the star
+int GetTravelTicks(float distancePixels)
+{
+    const float reachX = (PLAYER_REC_WIDTH_PIXELS + STAR_REC_WIDTH_PIXELS)/2.0f;
+    const float reachY = (PLAYER_REC_HEIGHT_PIXELS + STAR_REC_HEIGHT_PIXELS)/2.0f;
+    const float reach = (reachX < reachY)? reachX : reachY;
+
+    float coveredPixels = 0.0f;
+    float durationSeconds = 0.0f;
+    bool isJumping = false;
+    int ticks = 0;
+    while (distancePixels - coveredPixels >= reach)
+    {
+        float speed = PLAYER_SPEED;
+        durationSeconds += GAME_TICK_SECONDS;
+        if (!isJumping)
+        {
+            speed += PLAYER_BOOST;
+            durationSeconds = 0.0f;
+            isJumping = true;
+        } else if (durationSeconds >= PLAYER_JUMP_COOLDOWN_SECONDS)
+        {
+            durationSeconds = 0.0f;
+            isJumping = false;
+        } else
+        {
+            speed += PLAYER_BOOST;
+        }
+
+        coveredPixels += speed*GAME_TICK_SECONDS;
+        ticks += 1;
+    }
+
+    return ticks;
+}
+
+// Get ticks of a leg between two stars, including the grab or drop tick at the end
+// NOTE: Frog can arrive and act on the same tick, but two actions at one star need two ticks
+int GetLegTicks(const struct Solver *solver, int star1, int star2)
+{
+    const int mask = CONSTELLATION_MAX_STAR_COUNT - 1;
+    int dx = (star2 & mask) - (star1 & mask);
+    int dy = (star2 >> CONSTELLATION_COORDINATE_BITS) - (star1 >> CONSTELLATION_COORDINATE_BITS);
+    if (dx < 0) dx = -dx;
+    if (dy < 0) dy = -dy;
+
+    const int ticks = solver->travelTicks[(dx > dy)? dx : dy];
+    return (ticks > 0)? ticks : 1;
+}
+
+// Get ticks of the first leg, from the frog position (pixels) to the grab of a star
+// NOTE: Frog is taken as idle, as on every other leg
+int GetStartLegTicks(float startX, float startY, int star)
+{
+    const float dx = fabsf((float)((star & (CONSTELLATION_MAX_STAR_COUNT - 1))*STAR_SPACING_PIXELS) - startX);
+    const float dy = fabsf((float)((star >> CONSTELLATION_COORDINATE_BITS)*STAR_SPACING_PIXELS) - startY);
+
+    const int ticks = GetTravelTicks((dx > dy)? dx : dy);
+    return (ticks > 0)? ticks : 1;
+}
+
+// Get ticks of the route lighting the cheapest next bridge every time, initial upper bound
+int SolveGreedyRoute(const struct Solver *solver)
+{
+    unsigned long long remaining = (solver->bridgesCount == 64)? ~0ULL : ((1ULL << solver->bridgesCount) - 1);
+    int lastStep = SOLVER_START_STEP;
+    int ticks = 0;
+    while (remaining != 0)
+    {
+        int bestStep = -1;
+        int bestTicks = SOLVER_INFINITE_TICKS;
+        for (int step = 0; step < 2*solver->bridgesCount; step += 1)
+        {
+            if (!(remaining & (1ULL << (step/2)))) continue;
+
+            const int stepTicks = solver->legTicks[lastStep][step] + solver->bridgeTicks[step/2];
+            if (stepTicks < bestTicks)
+            {
+                bestTicks = stepTicks;
+                bestStep = step;
+            }
+        }
+
+        remaining &= ~(1ULL << (bestStep/2));
+        lastStep = bestStep;
+        ticks += bestTicks;
+    }
+
+    return ticks;
+}
+
+// Get ticks of the greedy route of a constellation too large for the route tables, -1 on allocation failure
+// NOTE: Same cheapest next bridge choice as SolveGreedyRoute(), O(n^2) legs over the bridges to light
+int SolveViewGreedyRoute(const struct Solver *solver, const struct ConstellationView *view, int bridgesCount, float startX, float startY)
+{
+    int *stars = (int *)malloc(2*bridgesCount*sizeof(int));
+    if (stars == NULL) return -1;
+
+    int count = 0;
+    for (int i = 0; i < view->bridgesCount; i += 1)
+    {
+        if (GetConstellationViewBridgeState(view, i) != BRIDGE_OFF_DEFAULT) continue;
+
+        const struct ConstellationBridge bridge = GetConstellationViewBridge(view, i);
+        stars[2*count] = bridge.x1 | (bridge.y1 << CONSTELLATION_COORDINATE_BITS);
+        stars[2*count + 1] = bridge.x2 | (bridge.y2 << CONSTELLATION_COORDINATE_BITS);
+        count += 1;
+    }
+
+    // Bridges left are kept first in the array, a lit bridge is swapped with the last one left
+    int lastStar = -1;
+    int ticks = 0;
+    for (int remainingCount = count; remainingCount > 0; remainingCount -= 1)
+    {
+        int bestBridge = -1;
+        int bestDirection = 0;
+        int bestTicks = SOLVER_INFINITE_TICKS;
+        for (int j = 0; j < remainingCount; j += 1)
+        {
+            const int bridgeTicks = GetLegTicks(solver, stars[2*j], stars[2*j + 1]);
+            for (int d = 0; d < 2; d += 1)
+            {
+                const int legTicks = (lastStar == -1)? GetStartLegTicks(startX, startY, stars[2*j + d]) : GetLegTicks(solver, lastStar, stars[2*j + d]);
+                if (legTicks + bridgeTicks < bestTicks)
+                {
+                    bestTicks = legTicks + bridgeTicks;
+                    bestBridge = j;
+                    bestDirection = d;
+                }
+            }
+        }
+
+        lastStar = stars[2*bestBridge + 1 - bestDirection];
+        ticks += bestTicks;
+        stars[2*bestBridge] = stars[2*(remainingCount - 1)];
+        stars[2*bestBridge + 1] = stars[2*(remainingCount - 1) + 1];
+    }
+
+    free(stars);
+    return ticks;
+}
+
+// Get ticks of the optimal route, dynamic programming over the subsets of lit bridges
+int SolveSubsets(struct Solver *solver)
+{
+    const int stepsCount = 2*solver->bridgesCount;
+    const unsigned int subsetsCount = 1u << solver->bridgesCount;
+    unsigned short *subsetTicks = solver->subsetTicks;
+
+    for (unsigned int i = 0; i < subsetsCount*stepsCount; i += 1) subsetTicks[i] = SOLVER_SUBSET_INFINITE_TICKS;
+    for (int step = 0; step < stepsCount; step += 1) subsetTicks[(1u << (step/2))*stepsCount + step] = (unsigned short)(solver->legTicks[SOLVER_START_STEP][step] + solver->bridgeTicks[step/2]);
+
+    // NOTE: Subsets only grow, so every subset is final when visited in increasing order
+    for (unsigned int subset = 1; subset < subsetsCount; subset += 1)
+    {
+        const unsigned short *ticks = &subsetTicks[subset*stepsCount];
+        for (int lastStep = 0; lastStep < stepsCount; lastStep += 1)
+        {
+            if (ticks[lastStep] == SOLVER_SUBSET_INFINITE_TICKS) continue;
+
+            const int *legTicks = solver->legTicks[lastStep];
+            for (int bridge = 0; bridge < solver->bridgesCount; bridge += 1)
+            {
+                if (subset & (1u << bridge)) continue;
+
+                unsigned short *nextTicks = &subsetTicks[(subset | (1u << bridge))*stepsCount + 2*bridge];
+                for (int d = 0; d < 2; d += 1)
+                {
+                    const int stepTicks = ticks[lastStep] + legTicks[2*bridge + d] + solver->bridgeTicks[bridge];
+                    if (stepTicks < nextTicks[d]) nextTicks[d] = (unsigned short)stepTicks;
+                }
+            }
+        }
+    }
+
+    int bestTicks = SOLVER_INFINITE_TICKS;
+    const unsigned short *ticks = &subsetTicks[(subsetsCount - 1)*stepsCount];
+    for (int step = 0; step < stepsCount; step += 1)
+    {
+        if (ticks[step] < bestTicks) bestTicks = ticks[step];
+    }
+
+    return bestTicks;
+}
+
+// Depth first branch-and-bound over the routes, cheapest next bridges first
+void SearchRoutes(struct Solver *solver, unsigned long long remaining, int lastStep, int ticks, int bridgesTicks)
+{
+    if (remaining == 0)
+    {
+        if (ticks < solver->bestTicks) solver->bestTicks = ticks;
+        return;
+    }
+
+    solver->nodesCount += 1;
+    if (solver->nodesCount > solver->nodesBudget) return;
+
+    // Remaining bridges lengths plus a lower bound of their grab legs
+    if (ticks + bridgesTicks + GetMinGrabLegsTicks(solver, remaining, lastStep) >= solver->bestTicks) return;
+
+    // Same bridges left from the same star reached before in fewer ticks
+    const unsigned int slot = (unsigned int)(((remaining ^ ((unsigned long long)lastStep << 57))*0x9e3779b97f4a7c15ULL) >> 48) & (SOLVER_MEMO_CAPACITY - 1);
+    struct SolverMemoEntry *entry = &solver->memo[slot];
+    if ((entry->lastStep == lastStep) && (entry->remaining == remaining) && (entry->ticks <= ticks)) return;
+    *entry = (struct SolverMemoEntry){ remaining, lastStep, ticks };
+
+    // Next steps sorted by their ticks (insertion sort, few steps)
+    int steps[SOLVER_MAX_STEPS];
+    int stepsTicks[SOLVER_MAX_STEPS];
+    int stepsCount = 0;
+    for (int step = 0; step < 2*solver->bridgesCount; step += 1)
+    {
+        if (!(remaining & (1ULL << (step/2)))) continue;
+
+        const int stepTicks = solver->legTicks[lastStep][step] + solver->bridgeTicks[step/2];
+        int i = stepsCount;
+        while ((i > 0) && (stepsTicks[i - 1] > stepTicks))
+        {
+            steps[i] = steps[i - 1];
+            stepsTicks[i] = stepsTicks[i - 1];
+            i -= 1;
+        }
+        steps[i] = step;
+        stepsTicks[i] = stepTicks;
+        stepsCount += 1;
+    }
+
+    for (int i = 0; i < stepsCount; i += 1)
+    {
+        const int bridge = steps[i]/2;
+        SearchRoutes(solver, remaining & ~(1ULL << bridge), steps[i], ticks + stepsTicks[i], bridgesTicks - solver->bridgeTicks[bridge]);
+    }
+}
+
+// Get a lower bound of the ticks of the grab legs lighting the remaining bridges
+// NOTE: Largest of two bounds: the cheapest grab leg of every bridge from the frog or any other remaining bridge
+// drop, and a tick per bridge plus the ticks above a tick of the fewest jumps
+int GetMinGrabLegsTicks(struct Solver *solver, unsigned long long remaining, int lastStep)
+{
+    int cheapestLegsTicks = 0;
+    int remainingCount = 0;
+    for (int j = 0; j < solver->bridgesCount; j += 1)
+    {
+        if (!(remaining & (1ULL << j))) continue;
+
+        const int *fromFrog = solver->legTicks[lastStep];
+        int minTicks = (fromFrog[2*j] < fromFrog[2*j + 1])? fromFrog[2*j] : fromFrog[2*j + 1];
+        for (int k = 0; (k < solver->bridgesCount) && (minTicks > 1); k += 1)
+        {
+            if ((k == j) || !(remaining & (1ULL << k))) continue;
+
+            for (int from = 2*k; from < 2*k + 2; from += 1)
+            {
+                const int *fromBridge = solver->legTicks[from];
+                if (fromBridge[2*j] < minTicks) minTicks = fromBridge[2*j];
+                if (fromBridge[2*j + 1] < minTicks) minTicks = fromBridge[2*j + 1];
+            }
+        }
+
+        cheapestLegsTicks += minTicks;
+        remainingCount += 1;
+    }
+
+    const int jumpsTicks = remainingCount + GetMinJumpsCount(solver, remaining, lastStep)*(solver->jumpTicks - 1);
+    return (cheapestLegsTicks > jumpsTicks)? cheapestLegsTicks : jumpsTicks;
+}
+
+// Get the fewest jumps needed to light the remaining bridges from the star the frog stands on
+// NOTE: Bridges lit one after the other without jumps form a trail, a graph component with k odd
+// degree stars needs k/2 trails at least (one if none), only a trail starting at the frog star is free
+int GetMinJumpsCount(struct Solver *solver, unsigned long long remaining, int lastStep)
+{
+    solver->starStamp += 1;
+    for (int j = 0; j < solver->bridgesCount; j += 1)
+    {
+        if (!(remaining & (1ULL << j))) continue;
+
+        const int stars[2] = { solver->stepStartStars[2*j], solver->stepEndStars[2*j] };
+        for (int k = 0; k < 2; k += 1)
+        {
+            if (solver->starStamps[stars[k]] != solver->starStamp)
+            {
+                solver->starStamps[stars[k]] = solver->starStamp;
+                solver->starParents[stars[k]] = stars[k];
+                solver->starDegrees[stars[k]] = 0;
+                solver->componentOddStars[stars[k]] = 0;
+            }
+            solver->starDegrees[stars[k]] += 1;
+        }
+
+        const int root1 = FindStarComponent(solver, stars[0]);
+        const int root2 = FindStarComponent(solver, stars[1]);
+        if (root1 != root2) solver->starParents[root1] = root2;
+    }
+
+    // Odd degree stars by component, then trails by component
+    int trailsCount = 0;
+    for (int j = 0; j < solver->bridgesCount; j += 1)
+    {
+        if (!(remaining & (1ULL << j))) continue;
+
+        const int stars[2] = { solver->stepStartStars[2*j], solver->stepEndStars[2*j] };
+        for (int k = 0; k < 2; k += 1)
+        {
+            // NOTE: Degree is cleared once counted, so every star counts once
+            if (solver->starDegrees[stars[k]] == 0) continue;
+            if (solver->starDegrees[stars[k]]%2 == 1) solver->componentOddStars[FindStarComponent(solver, stars[k])] += 1;
+            solver->starDegrees[stars[k]] = 0;
+        }
+    }
+    for (int j = 0; j < solver->bridgesCount; j += 1)
+    {
+        if (!(remaining & (1ULL << j))) continue;
+
+        const int root = FindStarComponent(solver, solver->stepStartStars[2*j]);
+        if (solver->componentOddStars[root] >= 0)
+        {
+            trailsCount += (solver->componentOddStars[root] > 2)? solver->componentOddStars[root]/2 : 1;
+            solver->componentOddStars[root] = -1;
+        }
+    }
+
+    if (lastStep == SOLVER_START_STEP) return trailsCount - 1;
+
+    const int star = solver->stepEndStars[lastStep];
+    return (solver->starStamps[star] == solver->starStamp)? trailsCount - 1 : trailsCount;
+}
+
+int FindStarComponent(struct Solver *solver, int star)
+{
+    while (solver->starParents[star] != star)
+    {
+        solver->starParents[star] = solver->starParents[solver->starParents[star]];
+        star = solver->starParents[star];
+    }
+    return star;
+}
+
+void RunSolverJob(void *data)
+{
+    struct SolverJob *job = (struct SolverJob *)data;
+
+    struct Solver *solver = LoadSolver();
+    if (solver == NULL) return;
+
+    for (int id = job->firstId; id < job->pack->constellationsCount; id += job->threadsCount)
+    {
+        struct ConstellationView view = { 0 };
+        if (GetPackConstellation(job->pack, id, &view)) job->parTimes[id] = SolveWithSolver(solver, &view, SOLVER_SPAWN_X, SOLVER_SPAWN_Y, job->nodesBudget);
+    }
+
+    UnloadSolver(solver);
+}
@@ -0,0 +1,67 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Par time solver
+*
+*   Computes the minimum time to light every BRIDGE_OFF_DEFAULT bridge of a constellation,
+*   the par time of the stage. Every bridge is one grab at a star plus one drop at the other
+*   star (any order), each action on its own tick; dropping on a wrong star stuns the frog, so
+*   it never happens on an optimal route.
+*
+*   Travel model (in simulation ticks, same physics as UpdatePlayer()):
+*     - Frog moves on 8 directions, axes independently at its speed: Chebyshev distance
+*     - Boost jumps are chained all the way (PLAYER_SPEED + PLAYER_BOOST), the direction only
+*       changes when a jump ends (PLAYER_JUMP_COOLDOWN_SECONDS)
+*     - Every leg starts idle at a star center and ends as soon as the frog is in grab reach
+*     - The route starts from the frog position when the constellation is chosen: the stage
+*       countdown ends before the constellation is known, so the first leg is walked on the clock
+*
+*   Routes are searched exactly: dynamic programming over bridge subsets for small constellations,
+*   branch-and-bound with a memoized transposition table above that (up to SOLVER_MAX_SEARCH_BRIDGES).
+*   Searches running out of budget return the best route found, larger constellations the greedy route
+*   (cheapest next bridge every time), neither proven optimal (isOptimal false): callers showing it
+*   as par time must mark it.
+*   Constellations with stars past the compact pack grid (CONSTELLATION_MAX_STAR_COUNT) are not solved.
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include "constellation.h"                  // Required for: struct ConstellationView, struct ConstellationPack
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SOLVER_MAX_DP_BRIDGES 16            // Bridges solved by dynamic programming over subsets (4MB table per thread)
+#define SOLVER_MAX_SEARCH_BRIDGES 64        // Bridges solved by branch-and-bound, greedy route above
+#define SOLVER_DEFAULT_NODES_BUDGET 4000000 // Branch-and-bound nodes expanded before giving up optimality
+#define SOLVER_GAME_NODES_BUDGET 100000     // Budget of the game, solving off the frame: a few tenths of a second at most
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+struct ParTime {
+    int ticks;                          // Par time in simulation ticks (GAME_TICK_SECONDS), -1 if not solvable
+    int bridgesCount;                   // Bridges to light
+    bool isOptimal;                     // Route is proven optimal (search finished within budget)
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+struct ParTime SolveParTime(const struct ConstellationView *view, float startX, float startY, int nodesBudget);   // Solve one constellation on the calling thread, route starting at a frog position (pixels)
+bool SolveParTimes(const struct ConstellationPack *pack, struct ParTime *parTimes, int threadsCount, int nodesBudget);  // Solve all pack constellations from the frog spawn, threadsCount 0 uses every core
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SOLVER_H
@@ -0,0 +1,231 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Frog swarm
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "swarm.h"
+
+#include "render.h"                         // Required for: SPRITESHEET_FROG_OFFSET_*, PLAYER_SPRITE_*
+
+#include <stdlib.h>                         // Required for: malloc(), free()
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SWARM_MIN_DECISION_SECONDS 0.25f    // Time a frog holds its random input
+#define SWARM_MAX_DECISION_SECONDS 2.0f
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+static unsigned int GetSwarmRandomBits(unsigned int *state);
+static void DecideFrogInput(struct FrogSwarm *swarm, int frogId);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool InitFrogSwarm(struct FrogSwarm *swarm, int count, unsigned int seed)
+{
+    *swarm = (struct FrogSwarm){ 0 };
+    if ((count < 1) || (count > SWARM_MAX_FROGS)) return false;
+
+    swarm->count = count;
+    swarm->positionsX = (float *)malloc(count*sizeof(float));
+    swarm->positionsY = (float *)malloc(count*sizeof(float));
+    swarm->directionsX = (float *)malloc(count*sizeof(float));
+    swarm->directionsY = (float *)malloc(count*sizeof(float));
+    swarm->speeds = (float *)malloc(count*sizeof(float));
+    swarm->movementSeconds = (float *)malloc(count*sizeof(float));
+    swarm->flappingSeconds = (float *)malloc(count*sizeof(float));
+    swarm->decisionSeconds = (float *)malloc(count*sizeof(float));
+    swarm->states = (unsigned char *)malloc(count);
+    swarm->flappingUp = (unsigned char *)malloc(count);
+    swarm->facingRight = (unsigned char *)malloc(count);
+    swarm->spriteIds = (unsigned char *)malloc(count);
+    swarm->randomStates = (unsigned int *)malloc(count*sizeof(unsigned int));
+
+    if ((swarm->positionsX == NULL) || (swarm->positionsY == NULL) || (swarm->directionsX == NULL) ||
+        (swarm->directionsY == NULL) || (swarm->speeds == NULL) || (swarm->movementSeconds == NULL) ||
+        (swarm->flappingSeconds == NULL) || (swarm->decisionSeconds == NULL) || (swarm->states == NULL) ||
+        (swarm->flappingUp == NULL) || (swarm->facingRight == NULL) || (swarm->spriteIds == NULL) ||
+        (swarm->randomStates == NULL))
+    {
+        UnloadFrogSwarm(swarm);
+        return false;
+    }
+
+    const Vector2 lastStar = GetLastStarPosition();
+    for (int i = 0; i < count; i += 1)
+    {
+        // NOTE: State only depends on (seed, id), mixed so neighbour frogs are not correlated
+        unsigned int state = seed ^ ((unsigned int)i*0x9e3779b9u);
+        state ^= state >> 16;
+        state *= 0x85ebca6bu;
+        state ^= state >> 13;
+        state *= 0xc2b2ae35u;
+        state ^= state >> 16;
+        if (state == 0) state = 0x9e3779b9;
+        swarm->randomStates[i] = state;
+
+        // Spawned anywhere on the star field, flap phases spread so frogs do not flap in sync
+        swarm->positionsX[i] = lastStar.x*(float)(GetSwarmRandomBits(&swarm->randomStates[i])%1024)/1023.0f;
+        swarm->positionsY[i] = lastStar.y*(float)(GetSwarmRandomBits(&swarm->randomStates[i])%1024)/1023.0f;
+        swarm->directionsX[i] = 0.0f;
+        swarm->directionsY[i] = 0.0f;
+        swarm->speeds[i] = PLAYER_SPEED;
+        swarm->movementSeconds[i] = 0.0f;
+        swarm->flappingSeconds[i] = PLAYER_FLAPPING_DURATION_SECONDS*(float)(GetSwarmRandomBits(&swarm->randomStates[i])%64)/64.0f;
+        swarm->decisionSeconds[i] = 0.0f;
+        swarm->states[i] = PLAYER_IDLE;
+        swarm->flappingUp[i] = 1;
+        swarm->facingRight[i] = 0;
+        swarm->spriteIds[i] = 1;
+    }
+
+    return true;
+}
+
+void UnloadFrogSwarm(struct FrogSwarm *swarm)
+{
+    free(swarm->positionsX);
+    free(swarm->positionsY);
+    free(swarm->directionsX);
+    free(swarm->directionsY);
+    free(swarm->speeds);
+    free(swarm->movementSeconds);
+    free(swarm->flappingSeconds);
+    free(swarm->decisionSeconds);
+    free(swarm->states);
+    free(swarm->flappingUp);
+    free(swarm->facingRight);
+    free(swarm->spriteIds);
+    free(swarm->randomStates);
+    *swarm = (struct FrogSwarm){ 0 };
+}
+
+// Advance every frog one tick, same rules as UpdatePlayer() and MovePlayer()
+// NOTE: Every pass is a loop over plain arrays, states are selected with masks instead of branches
+void UpdateFrogSwarm(struct FrogSwarm *swarm, float deltaTime)
+{
+    const int count = swarm->count;
+    float *positionsX = swarm->positionsX;
+    float *positionsY = swarm->positionsY;
+    const float *directionsX = swarm->directionsX;
+    const float *directionsY = swarm->directionsY;
+    float *speeds = swarm->speeds;
+    float *movementSeconds = swarm->movementSeconds;
+    float *flappingSeconds = swarm->flappingSeconds;
+    float *decisionSeconds = swarm->decisionSeconds;
+    unsigned char *states = swarm->states;
+    unsigned char *flappingUp = swarm->flappingUp;
+    const unsigned char *facingRight = swarm->facingRight;
+    unsigned char *spriteIds = swarm->spriteIds;
+
+    // Timers, and stun and jump cooldowns back to idle
+    for (int i = 0; i < count; i += 1)
+    {
+        const float seconds = movementSeconds[i] + deltaTime;
+        const int stunEnd = (states[i] == PLAYER_STUNNED) & (seconds >= PLAYER_STUN_COOLDOWN_SECONDS);
+        const int jumpEnd = (states[i] == PLAYER_JUMPING) & (seconds >= PLAYER_JUMP_COOLDOWN_SECONDS);
+        const int toIdle = stunEnd | jumpEnd;
+
+        speeds[i] -= (float)jumpEnd*PLAYER_BOOST;
+        movementSeconds[i] = toIdle? 0.0f : seconds;
+        states[i] = toIdle? (unsigned char)PLAYER_IDLE : states[i];
+        decisionSeconds[i] -= deltaTime;
+    }
+
+    // Random input of idle frogs, only frogs whose input expired (a small share every tick)
+    for (int i = 0; i < count; i += 1)
+    {
+        if ((decisionSeconds[i] <= 0.0f) && (states[i] == PLAYER_IDLE)) DecideFrogInput(swarm, i);
+    }
+
+    // Movement, stunned frogs stand still, walls at the first and the last stars
+    const Vector2 firstStar = GetStarPosition(0, 0);
+    const Vector2 lastStar = GetLastStarPosition();
+    for (int i = 0; i < count; i += 1)
+    {
+        const float step = (float)(states[i] != PLAYER_STUNNED)*speeds[i]*deltaTime;
+        float x = positionsX[i] + directionsX[i]*step;
+        float y = positionsY[i] + directionsY[i]*step;
+
+        // NOTE: Compare and select clamps, fminf()/fmaxf() NaN rules keep compilers from vectorizing
+        x = (x < firstStar.x)? firstStar.x : x;
+        x = (x > lastStar.x)? lastStar.x : x;
+        y = (y < firstStar.y)? firstStar.y : y;
+        y = (y > lastStar.y)? lastStar.y : y;
+        positionsX[i] = x;
+        positionsY[i] = y;
+    }
+
+    // Wing flapping and sprite selection
+    for (int i = 0; i < count; i += 1)
+    {
+        const float seconds = flappingSeconds[i] + deltaTime;
+        const int flip = (seconds >= PLAYER_FLAPPING_DURATION_SECONDS);
+
+        flappingSeconds[i] = flip? 0.0f : seconds;
+        flappingUp[i] ^= (unsigned char)flip;
+        spriteIds[i] = (unsigned char)(6*facingRight[i] + 4*(states[i] == PLAYER_STUNNED) + flappingUp[i]);
+    }
+}
+
+// Get the spritesheet source rectangle of a frog sprite
+// NOTE: Same frames as raylib_game DrawPlayer(): IDLE/JUMPING, grabbing, STUNNED, each followed by its flap frame
+Rectangle GetFrogSpriteRec(int spriteId)
+{
+    Rectangle rec = { 0 };
+    rec.x = (float)(SPRITESHEET_FROG_OFFSET_X_PIXELS + (spriteId%6)*PLAYER_SPRITE_WIDTH_PIXELS);
+    rec.y = (float)(SPRITESHEET_FROG_OFFSET_Y_PIXELS + (spriteId/6)*PLAYER_SPRITE_HEIGHT_PIXELS);
+    rec.width = (float)PLAYER_SPRITE_WIDTH_PIXELS;
+    rec.height = (float)PLAYER_SPRITE_HEIGHT_PIXELS;
+    return rec;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Get the next bits of a frog xorshift32 state (never zero)
+unsigned int GetSwarmRandomBits(unsigned int *state)
+{
+    unsigned int x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+
+    return x;
+}
+
+// Pick a new held input for an idle frog: one of the 8 directions or none, boosting sometimes,
+// stunned sometimes (as dropping a star on a wrong star)
+void DecideFrogInput(struct FrogSwarm *swarm, int frogId)
+{
+    const unsigned int bits = GetSwarmRandomBits(&swarm->randomStates[frogId]);
+    const int direction = (int)(bits%9);            // 8 is no direction
+    const float directionsX[9] = { 1.0f, 1.0f, 0.0f, -1.0f, -1.0f, -1.0f, 0.0f, 1.0f, 0.0f };
+    const float directionsY[9] = { 0.0f, 1.0f, 1.0f, 1.0f, 0.0f, -1.0f, -1.0f, -1.0f, 0.0f };
+
+    swarm->directionsX[frogId] = directionsX[direction];
+    swarm->directionsY[frogId] = directionsY[direction];
+    if (directionsX[direction] < 0.0f) swarm->facingRight[frogId] = 0;
+    else if (directionsX[direction] > 0.0f) swarm->facingRight[frogId] = 1;
+
+    swarm->decisionSeconds[frogId] = SWARM_MIN_DECISION_SECONDS +
+        (SWARM_MAX_DECISION_SECONDS - SWARM_MIN_DECISION_SECONDS)*(float)((bits >> 8)%256)/255.0f;
+
+    if ((bits >> 16)%16 == 0)
+    {
+        swarm->movementSeconds[frogId] = 0.0f;
+        swarm->states[frogId] = PLAYER_STUNNED;
+    } else if (((bits >> 20)%4 == 0) && (direction != 8))
+    {
+        swarm->speeds[frogId] += PLAYER_BOOST;
+        swarm->movementSeconds[frogId] = 0.0f;
+        swarm->states[frogId] = PLAYER_JUMPING;
+    }
+}
@@ -0,0 +1,68 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Frog swarm
+*
+*   Stress mode entities: thousands to hundreds of thousands of frogs wandering the star field
+*   with the player movement rules of UpdatePlayer() (8 directions, boost jumps with a locked
+*   direction, wing flapping), each one driven by its own random input.
+*
+*   Frogs are stored as struct-of-arrays and updated in passes over plain float and byte arrays,
+*   without branches on the frog state, so compilers can vectorize every loop. The sprite of
+*   every frog is resolved on update (spriteIds), renderers look its source rectangle up in a
+*   table (GetFrogSpriteRec()) instead of selecting it per frog.
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef SWARM_H
+#define SWARM_H
+
+#include "game.h"                           // Required for: Vector2, Rectangle, PLAYER_* constants
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define SWARM_MAX_FROGS 1000000
+#define SWARM_SPRITES_COUNT 12              // 6 frog frames (IDLE, flap, GRAB, flap, STUNNED, flap) per facing side
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+// Frogs as struct-of-arrays, frog i is entry i of every array
+struct FrogSwarm {
+    int count;
+    float *positionsX;
+    float *positionsY;
+    float *directionsX;
+    float *directionsY;
+    float *speeds;
+    float *movementSeconds;             // Time in the current state
+    float *flappingSeconds;             // Time in the current flap phase
+    float *decisionSeconds;             // Time until the frog picks a new input
+    unsigned char *states;              // enum PlayerState
+    unsigned char *flappingUp;
+    unsigned char *facingRight;
+    unsigned char *spriteIds;           // Sprite of the frog, see GetFrogSpriteRec()
+    unsigned int *randomStates;
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool InitFrogSwarm(struct FrogSwarm *swarm, int count, unsigned int seed);    // Allocate and spawn count frogs on the star field
+void UnloadFrogSwarm(struct FrogSwarm *swarm);                                 // Free frogs arrays
+void UpdateFrogSwarm(struct FrogSwarm *swarm, float deltaTime);               // Advance every frog one tick
+Rectangle GetFrogSpriteRec(int spriteId);                                      // Get the spritesheet source rectangle of a frog sprite
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // SWARM_H
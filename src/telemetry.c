@@ -0,0 +1,335 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Telemetry
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#include "telemetry.h"
+
+#include <stdio.h>                          // Required for: FILE, fopen(), fwrite(), fflush(), fclose(), remove(), snprintf()
+#include <string.h>                         // Required for: strncpy()
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOGDI                           // Avoid conflicts with raylib types (Rectangle)
+    #define NOUSER                          // Avoid conflicts with raylib functions (CloseWindow, ShowCursor)
+    #include <windows.h>                    // Required for: CreateThread(), WaitForSingleObject(), Sleep(), InterlockedExchange()
+#else
+    #include <pthread.h>                    // Required for: pthread_create(), pthread_join()
+    #include <unistd.h>                     // Required for: usleep()
+#endif
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TELEMETRY_RING_MASK (TELEMETRY_RING_RECORDS - 1)
+#define TELEMETRY_WRITER_SLEEP_MILLISECONDS 5       // Writer wait when the ring is empty
+#define TELEMETRY_MAX_FILE_NAME_LENGTH 256
+
+//----------------------------------------------------------------------------------
+// Global Variables Definition
+//----------------------------------------------------------------------------------
+static bool isTelemetryRunning = false;
+static char telemetryFileNamePrefix[TELEMETRY_MAX_FILE_NAME_LENGTH] = { 0 };
+
+// Ring indices only increase (wrapping), head is written by the game thread, tail by the writer thread
+static struct TelemetryRecord telemetryRing[TELEMETRY_RING_RECORDS] = { 0 };
+static volatile unsigned int telemetryRingHead = 0;
+static volatile unsigned int telemetryRingTail = 0;
+static volatile unsigned int isTelemetryStopping = 0;
+static unsigned int telemetryDroppedCount = 0;
+
+// Writer thread only
+static FILE *telemetryFile = NULL;
+static int telemetryFileId = -1;
+static long long telemetryFileBytes = 0;
+
+#if defined(_WIN32)
+static HANDLE telemetryThread = NULL;
+#else
+static pthread_t telemetryThread;
+#endif
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Declaration
+//----------------------------------------------------------------------------------
+#if defined(_WIN32)
+static DWORD WINAPI RunTelemetryWriter(LPVOID data);
+#else
+static void *RunTelemetryWriter(void *data);
+#endif
+static int DrainTelemetryRing(void);
+static bool OpenNextTelemetryFile(void);
+static void SleepTelemetryWriter(void);
+static unsigned int LoadAcquire(const volatile unsigned int *value);
+static void StoreRelease(volatile unsigned int *value, unsigned int newValue);
+
+//----------------------------------------------------------------------------------
+// Module Functions Definition
+//----------------------------------------------------------------------------------
+bool InitTelemetry(const char *fileNamePrefix)
+{
+    if (isTelemetryRunning) return false;
+
+    strncpy(telemetryFileNamePrefix, fileNamePrefix, TELEMETRY_MAX_FILE_NAME_LENGTH - 1);
+    telemetryRingHead = 0;
+    telemetryRingTail = 0;
+    isTelemetryStopping = 0;
+    telemetryDroppedCount = 0;
+    telemetryFileId = -1;
+
+    // NOTE: First file is opened by the writer thread, the game thread never touches files
+#if defined(_WIN32)
+    telemetryThread = CreateThread(NULL, 0, RunTelemetryWriter, NULL, 0, NULL);
+    isTelemetryRunning = (telemetryThread != NULL);
+#else
+    isTelemetryRunning = (pthread_create(&telemetryThread, NULL, RunTelemetryWriter, NULL) == 0);
+#endif
+
+    return isTelemetryRunning;
+}
+
+void CloseTelemetry(void)
+{
+    if (!isTelemetryRunning) return;
+
+    StoreRelease(&isTelemetryStopping, 1);
+#if defined(_WIN32)
+    WaitForSingleObject(telemetryThread, INFINITE);
+    CloseHandle(telemetryThread);
+#else
+    pthread_join(telemetryThread, NULL);
+#endif
+
+    isTelemetryRunning = false;
+}
+
+bool PushTelemetryRecord(const struct TelemetryRecord *record)
+{
+    if (!isTelemetryRunning) return false;
+
+    const unsigned int head = telemetryRingHead;
+    if (head - LoadAcquire(&telemetryRingTail) >= TELEMETRY_RING_RECORDS)
+    {
+        telemetryDroppedCount += 1;
+        return false;
+    }
+
+    telemetryRing[head & TELEMETRY_RING_MASK] = *record;
+    StoreRelease(&telemetryRingHead, head + 1);
+
+    return true;
+}
+
+void RecordTelemetryEvent(int type, int value, int stageId, int tick, unsigned long long timeMicroseconds)
+{
+    struct TelemetryRecord record = { 0 };
+    record.timeMicroseconds = timeMicroseconds;
+    record.tick = (unsigned int)tick;
+    record.type = (unsigned char)type;
+    record.stageId = (unsigned char)stageId;
+    record.value = (unsigned short)value;
+
+    PushTelemetryRecord(&record);
+}
+
+// Queue the gameplay events of one tick, found comparing the game before and after it
+// NOTE: Bridges are only ever lit by a tick (stage changes clear them), newly set bits are the bridges lit
+void RecordTelemetryGameEvents(const struct GameInstance *prevGame, const struct GameInstance *game, int tick, unsigned long long timeMicroseconds)
+{
+    if (!isTelemetryRunning) return;
+
+    const struct Player *prevPlayer = &prevGame->player;
+    const struct Player *player = &game->player;
+    const struct GameState *prevGameState = &prevGame->gameState;
+    const struct GameState *gameState = &game->gameState;
+
+    if (!prevPlayer->isGrabbingStar && player->isGrabbingStar)
+    {
+        RecordTelemetryEvent(TELEMETRY_GRAB, player->grabbedStarX | (player->grabbedStarY << 8), gameState->stageId, tick, timeMicroseconds);
+    }
+
+    if ((prevPlayer->state != PLAYER_STUNNED) && (player->state == PLAYER_STUNNED))
+    {
+        const int star = prevPlayer->isGrabbingStar? (prevPlayer->grabbedStarX | (prevPlayer->grabbedStarY << 8)) : 0xffff;
+        RecordTelemetryEvent(TELEMETRY_STUN, star, gameState->stageId, tick, timeMicroseconds);
+    }
+
+    for (int i = 0; i < GAME_LIT_BRIDGES_WORDS; i += 1)
+    {
+        const unsigned int litBits = game->litBridges[i] & ~prevGame->litBridges[i];
+        for (int j = 0; (litBits != 0) && (j < 32); j += 1)
+        {
+            if (litBits & (1u << j)) RecordTelemetryEvent(TELEMETRY_BRIDGE, 32*i + j, gameState->stageId, tick, timeMicroseconds);
+        }
+    }
+
+    const int constellationId = gameState->stages[gameState->stageId].constellationId;
+    if ((constellationId != -1) && (constellationId != prevGameState->stages[gameState->stageId].constellationId))
+    {
+        RecordTelemetryEvent(TELEMETRY_CONSTELLATION, constellationId, gameState->stageId, tick, timeMicroseconds);
+    }
+
+    if ((prevGameState->state == GAMESTATE_GAMEPLAY) && (gameState->state == GAMESTATE_CLEAR))
+    {
+        struct TelemetryRecord record = { 0 };
+        record.timeMicroseconds = timeMicroseconds;
+        record.tick = (unsigned int)tick;
+        record.type = TELEMETRY_STAGE_CLEAR;
+        record.stageId = (unsigned char)gameState->stageId;
+        record.values[0] = (unsigned int)(gameState->stages[gameState->stageId].timerSeconds*1000.0f);
+        PushTelemetryRecord(&record);
+    }
+}
+
+// Queue a frame timing sample, phases are stored in microseconds
+void RecordTelemetryFrame(int tick, unsigned long long timeMicroseconds, const double *phaseSeconds, int phasesCount)
+{
+    if (!isTelemetryRunning) return;
+
+    struct TelemetryRecord record = { 0 };
+    record.timeMicroseconds = timeMicroseconds;
+    record.tick = (unsigned int)tick;
+    record.type = TELEMETRY_FRAME;
+    for (int i = 0; (i < phasesCount) && (i < TELEMETRY_RECORD_VALUES); i += 1) record.values[i] = (unsigned int)(phaseSeconds[i]*1e6);
+
+    PushTelemetryRecord(&record);
+}
+
+unsigned int GetTelemetryRecordsCount(void)
+{
+    return telemetryRingHead;
+}
+
+unsigned int GetTelemetryDroppedCount(void)
+{
+    return telemetryDroppedCount;
+}
+
+//----------------------------------------------------------------------------------
+// Module specific Functions Definition
+//----------------------------------------------------------------------------------
+// Writer thread: drains the ring until stopped, then writes the records left
+// NOTE: Stop flag is read before draining, records pushed before CloseTelemetry() are always written
+#if defined(_WIN32)
+DWORD WINAPI RunTelemetryWriter(LPVOID data)
+#else
+void *RunTelemetryWriter(void *data)
+#endif
+{
+    (void)data;
+
+    for (;;)
+    {
+        const bool isStopping = (LoadAcquire(&isTelemetryStopping) != 0);
+        const int writtenCount = DrainTelemetryRing();
+
+        if (isStopping) break;
+        if (writtenCount == 0)
+        {
+            if (telemetryFile != NULL) fflush(telemetryFile);
+            SleepTelemetryWriter();
+        }
+    }
+
+    if (telemetryFile != NULL) fclose(telemetryFile);
+    telemetryFile = NULL;
+
+#if defined(_WIN32)
+    return 0;
+#else
+    return NULL;
+#endif
+}
+
+// Write every record queued, in contiguous ring chunks, returns the records written
+// NOTE: Records are dropped if no file can be written, the ring is always drained
+int DrainTelemetryRing(void)
+{
+    const unsigned int head = LoadAcquire(&telemetryRingHead);
+    unsigned int tail = telemetryRingTail;
+    int writtenCount = 0;
+
+    while (tail != head)
+    {
+        unsigned int count = head - tail;
+        const unsigned int chunkCount = TELEMETRY_RING_RECORDS - (tail & TELEMETRY_RING_MASK);
+        if (count > chunkCount) count = chunkCount;
+
+        if ((telemetryFile == NULL) || (telemetryFileBytes >= TELEMETRY_FILE_MAX_BYTES)) OpenNextTelemetryFile();
+        if (telemetryFile != NULL)
+        {
+            fwrite(&telemetryRing[tail & TELEMETRY_RING_MASK], sizeof(struct TelemetryRecord), count, telemetryFile);
+            telemetryFileBytes += (long long)count*sizeof(struct TelemetryRecord);
+        }
+
+        tail += count;
+        writtenCount += (int)count;
+        StoreRelease(&telemetryRingTail, tail);
+    }
+
+    return writtenCount;
+}
+
+// Close the current file and start the next one in the oldest file slot
+bool OpenNextTelemetryFile(void)
+{
+    if (telemetryFile != NULL) fclose(telemetryFile);
+
+    telemetryFileId += 1;
+    telemetryFileBytes = 0;
+
+    // Files of a previous session with the same prefix are removed, so a session never mixes with older ones
+    char fileName[TELEMETRY_MAX_FILE_NAME_LENGTH + 16] = { 0 };
+    if (telemetryFileId == 0)
+    {
+        for (int i = 0; i < TELEMETRY_FILES_KEPT; i += 1)
+        {
+            snprintf(fileName, sizeof(fileName), "%s_%i.sftl", telemetryFileNamePrefix, i);
+            remove(fileName);
+        }
+    }
+
+    // NOTE: Files are slots reused in turn, the oldest one is overwritten
+    snprintf(fileName, sizeof(fileName), "%s_%i.sftl", telemetryFileNamePrefix, telemetryFileId%TELEMETRY_FILES_KEPT);
+    telemetryFile = fopen(fileName, "wb");
+    if (telemetryFile == NULL) return false;
+
+    const unsigned int header[3] = { TELEMETRY_VERSION, (unsigned int)sizeof(struct TelemetryRecord), (unsigned int)telemetryFileId };
+    fwrite("SFTL", 1, 4, telemetryFile);
+    fwrite(header, sizeof(unsigned int), 3, telemetryFile);
+    telemetryFileBytes = 16;
+
+    return true;
+}
+
+void SleepTelemetryWriter(void)
+{
+#if defined(_WIN32)
+    Sleep(TELEMETRY_WRITER_SLEEP_MILLISECONDS);
+#else
+    usleep(TELEMETRY_WRITER_SLEEP_MILLISECONDS*1000);
+#endif
+}
+
+// Ring indices are published with release stores and read with acquire loads, so a record is
+// complete before the writer sees it and a slot is written before the game thread reuses it
+unsigned int LoadAcquire(const volatile unsigned int *value)
+{
+#if defined(_MSC_VER)
+    return (unsigned int)InterlockedCompareExchange((volatile LONG *)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
+
+void StoreRelease(volatile unsigned int *value, unsigned int newValue)
+{
+#if defined(_MSC_VER)
+    InterlockedExchange((volatile LONG *)value, (LONG)newValue);
+#else
+    __atomic_store_n(value, newValue, __ATOMIC_RELEASE);
+#endif
+}
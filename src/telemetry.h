@@ -0,0 +1,88 @@
+/*******************************************************************************************
+*
+*   Starry Frog - Telemetry
+*
+*   Gameplay events (grabs, bridges lit, stuns, stage clears, constellations chosen) and frame
+*   timing samples are recorded as fixed-size binary records, without blocking the frame:
+*
+*    - The game thread pushes records into a lock-free single-producer single-consumer ring,
+*      a record that does not fit (writer behind) is dropped and counted, never waited for.
+*    - A background writer thread drains the ring into rotating log files: prefix_0.sftl up to
+*      prefix_(TELEMETRY_FILES_KEPT - 1).sftl, reused in turn, so a prefix never takes more than
+*      TELEMETRY_FILES_KEPT files. A new session replaces the files left by the last one.
+*
+*   Gameplay events are not emitted by the simulation, they are found comparing the game
+*   instance before and after every tick (see RecordTelemetryGameEvents()).
+*
+*   Telemetry file (version 2), every file of a session starts with its own header:
+*
+*       char[4]     magic "SFTL"
+*       u32         version, record size in bytes
+*       u32         file sequence in the session (0, 1, 2...), orders the file slots
+*       records     struct TelemetryRecord copied as is (little-endian)
+*
+*   NOTE: This module does not depend on raylib library, it can be used by headless tools
+*
+*   Copyright (c) 2022 Daniel Sanchez (daneelsan)
+*
+********************************************************************************************/
+
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "game.h"                           // Required for: struct GameInstance
+
+//----------------------------------------------------------------------------------
+// Defines and Macros
+//----------------------------------------------------------------------------------
+#define TELEMETRY_VERSION 2
+#define TELEMETRY_RING_RECORDS 4096                 // Records the writer can be behind (power of two)
+#define TELEMETRY_FILE_MAX_BYTES (4*1024*1024)      // File size before rotating to the next file
+#define TELEMETRY_FILES_KEPT 4
+#define TELEMETRY_RECORD_VALUES 6
+
+//----------------------------------------------------------------------------------
+// Types and Structures Definition
+//----------------------------------------------------------------------------------
+enum TelemetryRecordType {
+    TELEMETRY_FRAME = 1,                // values: phase microseconds, in frame phases order
+    TELEMETRY_GRAB,                     // value: star grabbed, x | y << 8
+    TELEMETRY_BRIDGE,                   // value: bridge lit, id in the stage constellation
+    TELEMETRY_STUN,                     // value: star carried when stunned, x | y << 8 (0xffff if none)
+    TELEMETRY_STAGE_CLEAR,              // values[0]: stage timer milliseconds
+    TELEMETRY_CONSTELLATION,            // value: constellation chosen for the stage
+    TELEMETRY_DEBUG_MODE,               // value: 1 if debug mode turned on, 0 if off
+    TELEMETRY_REWIND                    // value: ticks rewound, tick is the one restored
+};
+
+// NOTE: 40 bytes, no padding
+struct TelemetryRecord {
+    unsigned long long timeMicroseconds;    // Caller clock, the game records its run time
+    unsigned int tick;                      // Game ticks played
+    unsigned char type;                     // enum TelemetryRecordType
+    unsigned char stageId;
+    unsigned short value;
+    unsigned int values[TELEMETRY_RECORD_VALUES];
+};
+
+#if defined(__cplusplus)
+extern "C" {
+#endif
+
+//----------------------------------------------------------------------------------
+// Module Functions Declaration
+//----------------------------------------------------------------------------------
+bool InitTelemetry(const char *fileNamePrefix);                       // Start the writer thread, files are named prefix_N.sftl (N < TELEMETRY_FILES_KEPT)
+void CloseTelemetry(void);                                            // Write the records left and stop the writer thread
+bool PushTelemetryRecord(const struct TelemetryRecord *record);       // Queue a record for the writer, false if dropped (game thread only)
+void RecordTelemetryEvent(int type, int value, int stageId, int tick, unsigned long long timeMicroseconds);    // Queue a single value event
+void RecordTelemetryGameEvents(const struct GameInstance *prevGame, const struct GameInstance *game, int tick, unsigned long long timeMicroseconds);  // Queue the events of one tick
+void RecordTelemetryFrame(int tick, unsigned long long timeMicroseconds, const double *phaseSeconds, int phasesCount);  // Queue a frame timing sample
+unsigned int GetTelemetryRecordsCount(void);                          // Records queued since the start
+unsigned int GetTelemetryDroppedCount(void);                          // Records dropped, the ring was full
+
+#if defined(__cplusplus)
+}
+#endif
+
+#endif // TELEMETRY_H